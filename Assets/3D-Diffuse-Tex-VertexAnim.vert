@@ -0,0 +1,39 @@
+#version 150
+
+in vec3 vPos;
+in vec3 vPos2;
+in vec3 vNormal;
+in vec2 vUV1;
+
+out vec4 fColor;
+out vec2 fUV1;
+
+// Built-in uniforms
+layout(std140) uniform GlobalUniforms
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+};
+uniform mat4 gObjectToWorldMatrix;
+
+// User-defined uniforms
+uniform vec4 uColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+// Blend factor between the two vertex animation keyframes (vPos and vPos2).
+uniform float uVertexAnimBlend = 0.0f;
+
+void main()
+{
+    // Pass through color attribute.
+	fColor = uColor;
+    
+    // Pass through the UV attribute.
+    fUV1 = vUV1;
+    
+    // Interpolate between keyframe positions.
+    vec3 pos = mix(vPos, vPos2, uVertexAnimBlend);
+    
+    // Transform position obj->world->view->proj
+    gl_Position = gWorldToProjMatrix * gObjectToWorldMatrix * vec4(pos, 1.0f);
+}
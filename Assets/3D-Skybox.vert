@@ -5,7 +5,12 @@ in vec3 vPos;
 out vec3 fTexCoords;
 
 // Built-in uniforms
-uniform mat4 gWorldToProjMatrix;
+layout(std140) uniform GlobalUniforms
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+};
 
 void main()
 {
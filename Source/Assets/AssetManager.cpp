@@ -185,6 +185,11 @@ Texture* AssetManager::LoadTexture(const std::string& name)
     return LoadAsset<Texture>(SanitizeAssetName(name, ".BMP"), &mLoadedTextures);
 }
 
+void AssetManager::UnloadTexture(const std::string& name)
+{
+	UnloadAsset<Texture>(SanitizeAssetName(name, ".BMP"), &mLoadedTextures);
+}
+
 GAS* AssetManager::LoadGAS(const std::string& name)
 {
     return LoadAsset<GAS>(SanitizeAssetName(name, ".GAS"), &mLoadedGases);
@@ -461,6 +466,21 @@ char* AssetManager::CreateAssetBuffer(const std::string& assetName, unsigned int
 	return nullptr;
 }
 
+template<class T>
+void AssetManager::UnloadAsset(const std::string& assetName, std::unordered_map<std::string, T*>* cache)
+{
+	std::string upperName = assetName;
+	StringUtil::ToUpper(upperName);
+	
+	// If the asset isn't loaded, nothing to do.
+	auto it = cache->find(upperName);
+	if(it == cache->end()) { return; }
+	
+	// Delete asset and remove it from the cache.
+	delete it->second;
+	cache->erase(it);
+}
+
 template<class T>
 void AssetManager::UnloadAssets(std::unordered_map<std::string, T*>& cache)
 {
@@ -59,6 +59,7 @@ public:
     
     Model* LoadModel(const std::string& name);
     Texture* LoadTexture(const std::string& name);
+	void UnloadTexture(const std::string& name);
     
     GAS* LoadGAS(const std::string& name);
     Animation* LoadAnimation(const std::string& name);
@@ -122,5 +123,6 @@ private:
     template<class T> T* LoadAsset(const std::string& assetName, std::unordered_map<std::string, T*>* cache);
 	char* CreateAssetBuffer(const std::string& assetName, unsigned int& outBufferSize);
 	
+	template<class T> void UnloadAsset(const std::string& assetName, std::unordered_map<std::string, T*>* cache);
 	template<class T> void UnloadAssets(std::unordered_map<std::string, T*>& cache);
 };
@@ -14,7 +14,8 @@ TYPE_DEF_CHILD(Component, AudioListener);
 
 AudioListener::AudioListener(Actor* owner) : Component(owner)
 {
-    
+    // Listener should be wherever the camera ended up this update.
+    SetUpdatePhase(UpdatePhase::PostUpdate);
 }
 
 void AudioListener::OnUpdate(float deltaTime)
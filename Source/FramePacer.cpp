@@ -0,0 +1,81 @@
+//
+// FramePacer.cpp
+//
+// Clark Kromenaker
+//
+#include "FramePacer.h"
+
+#include <thread>
+
+#include <SDL2/SDL.h>
+
+#include "Services.h"
+#include "StringUtil.h"
+
+FramePacer::FramePacer() :
+	mFrameTimes(kFrameTimeSampleCount)
+{
+	mFrequency = SDL_GetPerformanceFrequency();
+}
+
+void FramePacer::SetVSync(bool enabled, float refreshRate)
+{
+	mVSync = enabled;
+	mRefreshRate = refreshRate;
+}
+
+float FramePacer::WaitForNextFrame()
+{
+	uint64_t counter = SDL_GetPerformanceCounter();
+	
+	// Use the idle rate if unfocused - no need to draw many frames nobody is looking at.
+	float frameRate = (!mFocused && mIdleFrameRate > 0.0f) ? mIdleFrameRate : mTargetFrameRate;
+	
+	// With vsync, only wait if we want fewer frames than the display shows. Refresh rates aren't exact (59.94 vs 60), so allow some slack.
+	bool wait = frameRate > 0.0f && (!mVSync || (mRefreshRate > 0.0f && frameRate < mRefreshRate - 1.0f));
+	if(wait && mLastFrameCounter != 0)
+	{
+		uint64_t period = static_cast<uint64_t>(mFrequency / frameRate);
+		
+		// Frames are scheduled at fixed intervals, so one late frame doesn't push back all the frames after it.
+		// But if far behind (e.g. after a scene load), start the schedule over rather than rushing to catch up.
+		if(counter > mNextFrameCounter + period)
+		{
+			mNextFrameCounter = counter;
+		}
+		
+		while(counter < mNextFrameCounter)
+		{
+			// Sleep for most of the remaining time, then yield until it's time.
+			uint64_t remainingMilliseconds = (mNextFrameCounter - counter) * 1000 / mFrequency;
+			if(remainingMilliseconds > kSleepMarginMilliseconds)
+			{
+				SDL_Delay(static_cast<uint32_t>(remainingMilliseconds - kSleepMarginMilliseconds));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+			counter = SDL_GetPerformanceCounter();
+		}
+		mNextFrameCounter += period;
+	}
+	else
+	{
+		mNextFrameCounter = counter;
+	}
+	
+	// The first frame has no previous frame to measure from.
+	float deltaTime = 0.0f;
+	if(mLastFrameCounter != 0)
+	{
+		deltaTime = static_cast<float>(static_cast<double>(counter - mLastFrameCounter) / mFrequency);
+		if(mFrameTimes.Add(deltaTime * 1000.0f))
+		{
+			Services::GetReports()->Log("FramePacing", StringUtil::Format("Frame time (ms): p50 %.2f, p99 %.2f, jitter %.2f",
+																		  GetFrameTimePercentile(0.5f), GetFrameTimePercentile(0.99f), GetFrameTimeJitter()));
+		}
+	}
+	mLastFrameCounter = counter;
+	return deltaTime;
+}
@@ -0,0 +1,61 @@
+//
+// FramePacer.h
+//
+// Clark Kromenaker
+//
+// Keeps frames from running faster than a target rate, without burning a CPU core while waiting.
+// Sleeps for most of the wait, then yields for the last bit, since sleeps can overshoot by a millisecond or so.
+//
+// Also tracks recent frame times, to report how steady the frame rate is.
+//
+#pragma once
+#include <cstdint>
+
+#include "SampleWindow.h"
+
+class FramePacer
+{
+public:
+	FramePacer();
+	
+	// Target frames per second. Zero means no limit.
+	void SetTargetFrameRate(float framesPerSecond) { mTargetFrameRate = framesPerSecond; }
+	float GetTargetFrameRate() const { return mTargetFrameRate; }
+	
+	// Frames per second while the window doesn't have focus. Zero means use the normal target.
+	void SetIdleFrameRate(float framesPerSecond) { mIdleFrameRate = framesPerSecond; }
+	void SetFocused(bool focused) { mFocused = focused; }
+	
+	// With vsync, the buffer swap already waits for the display, and waiting here too would cause missed refreshes.
+	// So the pacer only waits if the target rate is below the refresh rate (zero if unknown).
+	void SetVSync(bool enabled, float refreshRate);
+	
+	// Waits until it's time for the next frame. Returns seconds since the last frame.
+	float WaitForNextFrame();
+	
+	// Stats for recent frame times, in milliseconds.
+	// Jitter is the standard deviation - how much frame times vary from frame to frame.
+	float GetFrameTimePercentile(float percentile) const { return mFrameTimes.GetPercentile(percentile); }
+	float GetFrameTimeJitter() const { return mFrameTimes.GetStandardDeviation(); }
+	
+private:
+	// Sleeps are only trusted to be accurate to about this many milliseconds.
+	// Waits shorter than this are done by yielding instead.
+	static const int kSleepMarginMilliseconds = 2;
+	
+	float mTargetFrameRate = 60.0f;
+	float mIdleFrameRate = 0.0f;
+	bool mFocused = true;
+	
+	bool mVSync = false;
+	float mRefreshRate = 0.0f;
+	
+	// Performance counter ticks per second, when the last frame started, and when the next should start.
+	uint64_t mFrequency = 0;
+	uint64_t mLastFrameCounter = 0;
+	uint64_t mNextFrameCounter = 0;
+	
+	// Recent frame times, in milliseconds. Stats are reported each time this fills up.
+	static const int kFrameTimeSampleCount = 256;
+	SampleWindow mFrameTimes;
+};
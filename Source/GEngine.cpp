@@ -25,6 +25,11 @@
 
 GEngine* GEngine::sInstance = nullptr;
 
+const float GEngine::kSimulationStep = 1.0f / 60.0f;
+const float GEngine::kMaxFrameTime = 0.25f;
+const int GEngine::kMaxStepsPerFrame = 15;
+const int GEngine::kParallelUpdateBatchSize = 4;
+
 GEngine::GEngine()
 {
     assert(sInstance == nullptr);
@@ -40,6 +45,10 @@ bool GEngine::Initialize()
 	Services::SetConsole(&mConsole);
 	mConsole.SetReportStream(&mReportManager.GetReportStream("Console"));
 	
+	// Start job system worker threads, so any later system can spread work across cores.
+	Services::Set<JobSystem>(&mJobSystem);
+	mJobSystem.Init();
+	
     // Initialize asset manager.
     Services::SetAssets(&mAssetManager);
     
@@ -59,6 +68,11 @@ bool GEngine::Initialize()
     }
     Services::SetRenderer(&mRenderer);
     
+    // Cap to 60FPS (no need to go faster for this game), and go much slower in the background.
+    mFramePacer.SetTargetFrameRate(60.0f);
+    mFramePacer.SetIdleFrameRate(10.0f);
+    SetVSync(false);
+    
     // Initialize audio.
     if(!mAudioManager.Initialize())
     {
@@ -134,6 +148,10 @@ bool GEngine::Initialize()
 	Services::Set<ActionManager>(&mActionManager);
 	mActionManager.Init();
 	
+	// Pathfinding happens on a worker thread.
+	Services::Set<PathFinder>(&mPathFinder);
+	mPathFinder.Init();
+	
 	// Create dialogue manager.
 	Services::Set<DialogueManager>(new DialogueManager());
 	
@@ -187,6 +205,8 @@ void GEngine::Shutdown()
 	}
 	mActors.clear();
 	
+	mPathFinder.Shutdown();
+	mJobSystem.Shutdown();
     mRenderer.Shutdown();
     mAudioManager.Shutdown();
     
@@ -216,6 +236,12 @@ void GEngine::Quit()
     mRunning = false;
 }
 
+void GEngine::SetVSync(bool enabled)
+{
+    bool vsync = mRenderer.SetVSync(enabled) && enabled;
+    mFramePacer.SetVSync(vsync, mRenderer.GetRefreshRate());
+}
+
 void GEngine::UseDefaultCursor()
 {
 	if(mDefaultCursor != nullptr)
@@ -251,10 +277,6 @@ void GEngine::UseWaitCursor()
 
 void GEngine::ProcessInput()
 {
-    // Update the input manager.
-    // Retrieve input device states for us to use.
-    mInputManager.Update();
-    
     // We'll poll for events here. Catch the quit event.
     SDL_Event event;
     while(SDL_PollEvent(&event))
@@ -325,6 +347,20 @@ void GEngine::ProcessInput()
 				break;
 			}
 				
+            case SDL_WINDOWEVENT:
+            {
+                // Throttle frame rate while in the background.
+                if(event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED)
+                {
+                    mFramePacer.SetFocused(true);
+                }
+                else if(event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+                {
+                    mFramePacer.SetFocused(false);
+                }
+                break;
+            }
+                
             case SDL_QUIT:
                 Quit();
                 break;
@@ -340,42 +376,39 @@ void GEngine::ProcessInput()
 
 void GEngine::Update()
 {
-    // Tracks the next "GetTicks" value that is acceptable to perform an update.
-    static unsigned int nextTicks = 0;
-    
-    // Tracks the last ticks value each time we run this loop.
-    static uint32_t lastTicks = 0;
+    // Wait until it's time for this frame (sleeping, rather than spinning) and get the time delta.
+    float deltaTime = mFramePacer.WaitForNextFrame();
     
-    // Limit to ~60FPS. "nextTicks" is always +16 at start of frame.
-    // If we get here again and 16ms have not passed, we wait.
-	while(SDL_GetTicks() < nextTicks) { }
-	
-    // Get current ticks and save next ticks as +16. Limits FPS to ~60.
-    uint32_t currentTicks = SDL_GetTicks();
-    nextTicks = currentTicks + 16;
-	
-    // Calculate the time delta.
-	uint32_t deltaTicks = currentTicks - lastTicks;
-    float deltaTime = deltaTicks * 0.001f;
-	
-	// Save last ticks for next frame.
-    lastTicks = currentTicks;
-    
-    // Limit the time delta. At least 0s, and at most, 0.05s.
+    // Limit the time delta. At least 0s, and at most, the max frame time.
 	if(deltaTime < 0.0f) { deltaTime = 0.0f; }
-    if(deltaTime > 0.05f) { deltaTime = 0.05f; }
+    if(deltaTime > kMaxFrameTime) { deltaTime = kMaxFrameTime; }
     
-    // Update all actors.
-    for(size_t i = 0; i < mActors.size(); i++)
+    // Run as many simulation steps as fit in the elapsed time. Leftover time carries over to the next frame.
+    mSimulationTime += deltaTime * mTimeScale;
+    int stepCount = 0;
+    while(mSimulationTime >= kSimulationStep && stepCount < kMaxStepsPerFrame)
     {
-        mActors[i]->Update(deltaTime);
+        // Save transforms before the step, so rendering can blend from them.
+        for(auto& actor : mActors)
+        {
+            actor->GetTransform()->SaveInterpolationState();
+        }
+        Simulate(kSimulationStep);
+        mSimulationTime -= kSimulationStep;
+        ++stepCount;
     }
-	
-	// Delete any destroyed actors.
-	DeleteDestroyedActors();
     
-    // Also update audio system (before or after actors?)
-    mAudioManager.Update(deltaTime);
+    // Drop any whole steps that didn't fit in this frame, keeping only the partial step.
+    if(mSimulationTime >= kSimulationStep)
+    {
+        mSimulationTime = Math::Mod(mSimulationTime, kSimulationStep);
+    }
+    
+    // Rendering is somewhere between the last step and the next one.
+    Transform::SetInterpolation(mSimulationTime / kSimulationStep);
+    
+    // Run work that jobs handed back to the main thread (e.g. uploading results to the GPU).
+    mJobSystem.RunMainThreadJobs();
     
     // Update video playback.
     mVideoPlayer.Update();
@@ -405,6 +438,53 @@ void GEngine::Update()
 	Debug::Update(deltaTime);
 }
 
+void GEngine::Simulate(float deltaTime)
+{
+    // Update the input manager.
+    // Retrieve input device states for us to use. Done per step, so each press is seen by exactly one step.
+    mInputManager.Update();
+    
+	// Deliver any paths found since last step, so walkers can start moving this step.
+	mPathFinder.Update();
+	
+    // Update all actors, one phase at a time.
+    UpdateActors(deltaTime, UpdatePhase::PreUpdate);
+    UpdateActors(deltaTime, UpdatePhase::Animation);
+    UpdateActors(deltaTime, UpdatePhase::Movement);
+    UpdateActors(deltaTime, UpdatePhase::PostUpdate);
+	
+	// Delete any destroyed actors.
+	DeleteDestroyedActors();
+    
+    // Also update audio system (before or after actors?)
+    mAudioManager.Update(deltaTime);
+}
+
+void GEngine::UpdateActors(float deltaTime, UpdatePhase phase)
+{
+    // Update actors in order, gathering components that can update in parallel.
+    mParallelComponents.clear();
+    for(size_t i = 0; i < mActors.size(); i++)
+    {
+        mActors[i]->Update(deltaTime, phase, mParallelComponents);
+    }
+    if(mParallelComponents.empty()) { return; }
+    
+    // Update those components across all cores.
+    mJobSystem.ParallelFor(static_cast<int>(mParallelComponents.size()), kParallelUpdateBatchSize, [this, deltaTime](int start, int end) {
+        for(int i = start; i < end; ++i)
+        {
+            mParallelComponents[i]->Update(deltaTime);
+        }
+    });
+    
+    // Then let them do anything that has to happen on the main thread, in actor order (so callbacks happen in a predictable order).
+    for(auto& component : mParallelComponents)
+    {
+        component->MainThreadUpdate();
+    }
+}
+
 void GEngine::GenerateOutputs()
 {
     mRenderer.Render();
@@ -419,6 +499,9 @@ void GEngine::LoadSceneInternal()
 {
 	if(mSceneToLoad.empty()) { return; }
 	
+	// Any paths being found are for the current scene's walker boundary, which is about to go away.
+	mPathFinder.CancelAll();
+	
 	// Delete the current scene, if any.
 	if(mScene != nullptr)
 	{
@@ -448,6 +531,12 @@ void GEngine::LoadSceneInternal()
 	// b/c load operations may need to reference the scene itself!
 	mScene->Load();
 	
+	// Everything was just placed for the new scene - don't blend from where things were in the old one.
+	for(auto& actor : mActors)
+	{
+		actor->GetTransform()->ResetInterpolation();
+	}
+	
 	// Clear scene load request.
 	mSceneToLoad.clear();
 }
@@ -12,8 +12,12 @@
 #include "ActionManager.h"
 #include "AssetManager.h"
 #include "AudioManager.h"
+#include "Component.h"
 #include "Console.h"
+#include "FramePacer.h"
 #include "InputManager.h"
+#include "JobSystem.h"
+#include "PathFinder.h"
 #include "Renderer.h"
 #include "SheepManager.h"
 #include "ReportManager.h"
@@ -36,6 +40,14 @@ public:
     
     void Quit();
     
+    // Turns vsync on/off, and tells the frame pacer about it.
+    void SetVSync(bool enabled);
+    FramePacer& GetFramePacer() { return mFramePacer; }
+    
+    // Simulation speed relative to real time. Above 1 runs faster (e.g. for automated playthroughs).
+    void SetTimeScale(float timeScale) { mTimeScale = timeScale; }
+    float GetTimeScale() const { return mTimeScale; }
+    
     void AddActor(Actor* actor);
     
 	void LoadScene(std::string name) { mSceneToLoad = name; }
@@ -49,6 +61,20 @@ private:
     // Only one instance of GEngine can exist.
     static GEngine* sInstance;
     
+    // The game simulates in steps of this many seconds, no matter the frame rate.
+    // So animations, walking, and waits play out the same on any machine.
+    static const float kSimulationStep;
+    
+    // Most real time a single frame simulates. Any more (e.g. a long load) is dropped, rather than simulating a burst of steps.
+    static const float kMaxFrameTime;
+    
+    // Most simulation steps run in a single frame. Enough for a max-length frame at normal speed.
+    // A high time scale could need more - but rather than falling further behind each frame, the extra time is dropped.
+    static const int kMaxStepsPerFrame;
+    
+    // How many parallel components each job updates. Too few and jobs cost more than they save; too many and cores sit idle.
+    static const int kParallelUpdateBatchSize;
+    
     // Is the game running? While true, we loop. When false, the game exits.
 	// False by default, but set to true after initialization.
 	bool mRunning = false;
@@ -61,12 +87,24 @@ private:
     SheepManager mSheepManager;
 	ReportManager mReportManager;
 	ActionManager mActionManager;
+	PathFinder mPathFinder;
+	JobSystem mJobSystem;
 	Console mConsole;
     VideoPlayer mVideoPlayer;
     
+    // Limits frame rate, and tracks frame times.
+    FramePacer mFramePacer;
+    
+    // Time waiting to be simulated - less than one step after each frame.
+    float mSimulationTime = 0.0f;
+    float mTimeScale = 1.0f;
+    
     // A list of all actors that currently exist in the game.
     std::vector<Actor*> mActors;
     
+    // Components to update in parallel in the current update phase (rebuilt for each phase).
+    std::vector<Component*> mParallelComponents;
+    
     // The currently active scene. There can be only one at a time (sure about that?).
     Scene* mScene = nullptr;
 	
@@ -86,6 +124,8 @@ private:
     
     void ProcessInput();
     void Update();
+    void Simulate(float deltaTime);
+    void UpdateActors(float deltaTime, UpdatePhase phase);
     void GenerateOutputs();
 	
 	void LoadSceneInternal();
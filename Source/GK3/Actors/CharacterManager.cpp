@@ -183,6 +183,12 @@ CharacterManager::CharacterManager()
 					config.faceConfig.eyelidsTexture = Services::GetAssets()->LoadTexture(section.name + "_eyelids");
 					config.faceConfig.foreheadTexture = Services::GetAssets()->LoadTexture(section.name + "_forehead");
 					
+					// The face texture is also the head model's texture, but faces are composited on the CPU - so keep its pixels.
+					if(config.faceConfig.faceTexture != nullptr)
+					{
+						config.faceConfig.faceTexture->SetKeepPixels(true);
+					}
+					
 					// Each entry is a face property for the character.
 					for(auto& line : section.lines)
 					{
@@ -21,6 +21,9 @@ FaceController::FaceController(Actor* owner) : Component(owner)
 {
 	mDownSampledLeftEyeTexture = new Texture(25, 26, Color32::Black);
 	mDownSampledRightEyeTexture = new Texture(25, 26, Color32::Black);
+	
+	// Timers only touch this component, so they can count down in parallel with other actors.
+	SetUpdatePhase(UpdatePhase::PreUpdate, true);
 }
 
 FaceController::~FaceController()
@@ -287,8 +290,17 @@ void FaceController::ClearMood()
 
 void FaceController::OnUpdate(float deltaTime)
 {
-	// Count down and blink after some time.
+	// Count down timers. Blinking and jittering start animations and upload textures, so they wait for OnMainThreadUpdate.
 	mBlinkTimer -= deltaTime;
+	if(mEyeJitterEnabled)
+	{
+		mEyeJitterTimer -= deltaTime;
+	}
+}
+
+void FaceController::OnMainThreadUpdate()
+{
+	// Blink after some time.
 	if(mBlinkTimer <= 0.0f)
 	{
 		Blink();
@@ -296,14 +308,10 @@ void FaceController::OnUpdate(float deltaTime)
 	}
 	
 	// Update eye jitter.
-	if(mEyeJitterEnabled)
+	if(mEyeJitterEnabled && mEyeJitterTimer <= 0.0f)
 	{
-		mEyeJitterTimer -= deltaTime;
-		if(mEyeJitterTimer <= 0.0f)
-		{
-			EyeJitter();
-			RollEyeJitterTimer();
-		}
+		EyeJitter();
+		RollEyeJitterTimer();
 	}
 }
 
@@ -364,8 +372,6 @@ void FaceController::UpdateFaceTexture()
 							  //0.25f, 0.25f, mEyeJitterX + leftEyeBias.x, mEyeJitterY + leftEyeBias.y);
 							  0.25f, 0.25f, 0.0f, 0.0f);
 		
-		mDownSampledLeftEyeTexture->UploadToGPU();
-		
 		const Vector2& leftEyeOffset = mCharacterConfig->faceConfig.leftEyeOffset;
 		Texture::BlendPixels(*mDownSampledLeftEyeTexture, *mFaceTexture, leftEyeOffset.x, leftEyeOffset.y);
 	}
@@ -387,8 +393,6 @@ void FaceController::UpdateFaceTexture()
 							  //0.25f, 0.25f, mEyeJitterX + rightEyeBias.x, mEyeJitterY + rightEyeBias.y);
 							  0.25f, 0.25f, 0.0f, 0.0f);
 							  
-		mDownSampledRightEyeTexture->UploadToGPU();
-		
 		const Vector2& rightEyeOffset = mCharacterConfig->faceConfig.rightEyeOffset;
 		Texture::BlendPixels(*mDownSampledRightEyeTexture, *mFaceTexture, rightEyeOffset.x, rightEyeOffset.y);
 	}
@@ -407,6 +411,7 @@ void FaceController::UpdateFaceTexture()
 		Texture::BlendPixels(*mCurrentForeheadTexture, *mFaceTexture, foreheadOffset.x, foreheadOffset.y);
 	}
 		
-	// Upload all changes to the GPU.
+	// Upload all changes to the GPU. Only the blended parts of the face are sent.
+	// The downsampled eyes are only ever blended on the CPU, so they never need uploading.
 	mFaceTexture->UploadToGPU();
 }
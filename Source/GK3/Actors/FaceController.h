@@ -66,6 +66,7 @@ public:
 	
 protected:
 	void OnUpdate(float deltaTime) override;
+	void OnMainThreadUpdate() override;
 	
 private:
 	// The character config assigned by owner.
@@ -64,6 +64,12 @@ void GKActor::SetHeading(const Heading& heading)
 	SetMeshToActorRotation();
 }
 
+void GKActor::ResetInterpolation()
+{
+	GetTransform()->ResetInterpolation();
+	mMeshActor->GetTransform()->ResetInterpolation();
+}
+
 std::string GKActor::GetModelName() const
 {
 	if(mMeshRenderer == nullptr) { return std::string(); }
@@ -130,6 +136,7 @@ void GKActor::StartAbsoluteAnimation(VertexAnimation* anim, int framesPerSecond,
 	// Set the 3D model's position and heading.
 	mMeshActor->SetPosition(pos);
 	mMeshActor->SetRotation(heading.ToQuaternion());
+	mMeshActor->GetTransform()->ResetInterpolation();
 	
 	// If this is not a GAS anim, pause any running GAS.
 	if(!fromGas)
@@ -43,6 +43,9 @@ public:
 	
 	void SetHeading(const Heading& heading) override;
 	
+	// Call after teleporting the actor, so it (and its mesh) is rendered at the new spot right away, rather than blending from the old one.
+	void ResetInterpolation();
+	
 	///
 	/// ACTOR AND PROP FUNCTIONS
 	///
@@ -0,0 +1,163 @@
+//
+// PathFinder.cpp
+//
+// Clark Kromenaker
+//
+#include "PathFinder.h"
+
+#include <algorithm>
+
+#include <SDL2/SDL.h>
+
+#include "Services.h"
+#include "StringUtil.h"
+#include "WalkerBoundary.h"
+
+TYPE_DEF_BASE(PathFinder);
+
+PathFinder::~PathFinder()
+{
+	Shutdown();
+}
+
+void PathFinder::Init()
+{
+	if(mThread.joinable()) { return; }
+	mStopping = false;
+	mThread = std::thread(&PathFinder::WorkerLoop, this);
+}
+
+void PathFinder::Shutdown()
+{
+	if(!mThread.joinable()) { return; }
+
+	// Tell worker to stop, and wait for it to do so.
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+		mRequests.clear();
+	}
+	mRequestAdded.notify_one();
+	mThread.join();
+
+	mResults.clear();
+	mCallbacks.clear();
+}
+
+void PathFinder::Update()
+{
+	// Grab finished results. Swapping keeps the lock short and avoids allocating every frame.
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mResults.empty()) { return; }
+		mDeliveringResults.swap(mResults);
+	}
+
+	uint64_t counter = SDL_GetPerformanceCounter();
+	for(auto& result : mDeliveringResults)
+	{
+		// No callback means the request was cancelled after the worker finished it.
+		auto it = mCallbacks.find(result.id);
+		if(it == mCallbacks.end()) { continue; }
+
+		// Remove the callback before calling it, since the callback may make a new request.
+		std::function<void(bool, std::vector<Vector3>&)> callback = std::move(it->second);
+		mCallbacks.erase(it);
+
+		// Record latency.
+		float latency = static_cast<float>((counter - result.requestCounter) * 1000.0 / SDL_GetPerformanceFrequency());
+		if(mLatencies.Add(latency))
+		{
+			Services::GetReports()->Log("PathFinding", StringUtil::Format("Path latency (ms): p50 %.2f, p90 %.2f, p99 %.2f",
+																	  GetLatencyPercentile(0.5f), GetLatencyPercentile(0.9f), GetLatencyPercentile(0.99f)));
+		}
+
+		if(callback != nullptr)
+		{
+			callback(result.found, result.path);
+		}
+	}
+	mDeliveringResults.clear();
+}
+
+unsigned int PathFinder::RequestPath(const WalkerBoundary* walkerBoundary, const Vector3& from, const Vector3& to,
+									 std::function<void(bool, std::vector<Vector3>&)> callback)
+{
+	// IDs are never zero, so zero can mean "no request".
+	unsigned int requestId = mNextRequestId++;
+	if(mNextRequestId == 0) { mNextRequestId = 1; }
+	mCallbacks[requestId] = callback;
+
+	Request request;
+	request.id = requestId;
+	request.walkerBoundary = walkerBoundary->GetSnapshot();
+	request.from = from;
+	request.to = to;
+	request.requestCounter = SDL_GetPerformanceCounter();
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRequests.push_back(std::move(request));
+	}
+	mRequestAdded.notify_one();
+	return requestId;
+}
+
+void PathFinder::CancelPath(unsigned int requestId)
+{
+	if(requestId == 0) { return; }
+
+	// Removing the callback is enough to make sure it isn't called.
+	// But might as well save the worker some effort too.
+	mCallbacks.erase(requestId);
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto it = std::find_if(mRequests.begin(), mRequests.end(), [requestId](const Request& request) {
+		return request.id == requestId;
+	});
+	if(it != mRequests.end())
+	{
+		mRequests.erase(it);
+	}
+	else if(mBusyRequestId == requestId)
+	{
+		mBusyRequestCancelled = true;
+	}
+}
+
+void PathFinder::CancelAll()
+{
+	mCallbacks.clear();
+	std::unique_lock<std::mutex> lock(mMutex);
+	mRequests.clear();
+	mResults.clear();
+	mBusyRequestCancelled = true;
+	mRequestDone.wait(lock, [this]() { return mBusyRequestId == 0; });
+}
+
+void PathFinder::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while(true)
+	{
+		// Sleep until there's something to do.
+		mRequestAdded.wait(lock, [this]() { return mStopping || !mRequests.empty(); });
+		if(mStopping) { break; }
+
+		Request request = std::move(mRequests.front());
+		mRequests.pop_front();
+		mBusyRequestId = request.id;
+		mBusyRequestCancelled = false;
+
+		// Search without holding the lock, so the main thread can keep making/cancelling requests.
+		// Only this thread ever searches snapshots, so their search data isn't shared.
+		lock.unlock();
+		request.found = request.walkerBoundary->FindPath(request.from, request.to, request.path);
+		lock.lock();
+
+		if(!mBusyRequestCancelled)
+		{
+			mResults.push_back(std::move(request));
+		}
+		mBusyRequestId = 0;
+		mRequestDone.notify_all();
+	}
+}
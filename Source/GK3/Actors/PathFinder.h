@@ -0,0 +1,100 @@
+//
+// PathFinder.h
+//
+// Clark Kromenaker
+//
+// Finds walker paths on a background thread, so long searches don't hitch the frame.
+//
+// Requests search an immutable snapshot of a walker boundary.
+// Results are delivered (via callback) on the main thread, during Update.
+//
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SampleWindow.h"
+#include "Type.h"
+#include "Vector3.h"
+
+class WalkerBoundary;
+
+class PathFinder
+{
+	TYPE_DECL_BASE();
+public:
+	~PathFinder();
+
+	void Init();
+	void Shutdown();
+
+	// Delivers any finished paths. Call once per frame, on the main thread.
+	void Update();
+
+	// Requests a path. The callback is called (on the main thread) with whether a path was found, and the path itself.
+	// Returns an ID that can be used to cancel the request.
+	unsigned int RequestPath(const WalkerBoundary* walkerBoundary, const Vector3& from, const Vector3& to,
+							 std::function<void(bool, std::vector<Vector3>&)> callback);
+
+	// Cancels a request - its callback will not be called.
+	void CancelPath(unsigned int requestId);
+
+	// Cancels all requests, and waits for any in-progress search to finish.
+	// Use before destroying walker boundaries.
+	void CancelAll();
+
+	// Time (in milliseconds) from request to delivery, for the given percentile (0-1) of recent requests.
+	float GetLatencyPercentile(float percentile) const { return mLatencies.GetPercentile(percentile); }
+
+private:
+	struct Request
+	{
+		unsigned int id = 0;
+		std::shared_ptr<const WalkerBoundary> walkerBoundary;
+		Vector3 from;
+		Vector3 to;
+
+		// Filled in by the worker.
+		bool found = false;
+		std::vector<Vector3> path;
+
+		// When the request was made, for latency tracking.
+		uint64_t requestCounter = 0;
+	};
+
+	// The worker thread, and whether it should stop.
+	std::thread mThread;
+	bool mStopping = false;
+
+	// Guards all data shared with the worker thread.
+	std::mutex mMutex;
+	std::condition_variable mRequestAdded;
+	std::condition_variable mRequestDone;
+
+	// Requests waiting for the worker, and requests the worker has finished.
+	std::deque<Request> mRequests;
+	std::vector<Request> mResults;
+
+	// The request the worker is searching right now (0 if none).
+	// If cancelled mid-search, the result is thrown away.
+	unsigned int mBusyRequestId = 0;
+	bool mBusyRequestCancelled = false;
+
+	// Only touched on the main thread.
+	unsigned int mNextRequestId = 1;
+	std::unordered_map<unsigned int, std::function<void(bool, std::vector<Vector3>&)>> mCallbacks;
+	std::vector<Request> mDeliveringResults;
+
+	// Recent request latencies (milliseconds).
+	// Every time it fills, latency percentiles are reported.
+	static const int kLatencySampleCount = 128;
+	SampleWindow mLatencies { kLatencySampleCount };
+
+	void WorkerLoop();
+};
@@ -14,6 +14,7 @@
 #include "Heading.h"
 #include "Matrix4.h"
 #include "MeshRenderer.h"
+#include "PathFinder.h"
 #include "Scene.h"
 #include "Services.h"
 #include "StringUtil.h"
@@ -25,7 +26,15 @@ TYPE_DEF_CHILD(Component, Walker);
 Walker::Walker(Actor* owner) : Component(owner),
 	mGKOwner(static_cast<GKActor*>(owner))
 {
-	
+	// Steering rotates this actor and its mesh. Transform changes reach any child transforms, which may belong to other actors.
+	// So, this isn't safe to do in parallel with other actors.
+	SetUpdatePhase(UpdatePhase::Movement);
+}
+
+Walker::~Walker()
+{
+	// Path callback refers to this walker, so make sure it doesn't get called.
+	CancelPathRequest();
 }
 
 void Walker::SetCharacterConfig(const CharacterConfig& characterConfig)
@@ -51,6 +60,9 @@ bool Walker::WalkTo(const Vector3& position, WalkerBoundary* walkerBoundary, std
 
 bool Walker::WalkTo(const Vector3& position, const Heading& heading, WalkerBoundary* walkerBoundary, std::function<void()> finishCallback)
 {
+	// Any path being found or followed is for an old destination.
+	StopFollowingPath();
+	
 	// Save destination.
 	mDestination = position;
 	
@@ -93,37 +105,18 @@ bool Walker::WalkTo(const Vector3& position, const Heading& heading, WalkerBound
 		return true;
 	}
 	
-	// Find a path from current position to target position, populating our path vector.
-	if(walkerBoundary->FindPath(GetOwner()->GetPosition(), position, mPath))
-	{
-		//TODO: Make debug output of paths optional.
-		{
-			Vector3 prev = mPath.back();
-			for(int i = static_cast<int>(mPath.size()) - 2; i >= 0; i--)
-			{
-				Debug::DrawLine(prev, mPath[i], Color32::Red, 10.0f);
-				prev = mPath[i];
-			}
-		}
-		
-		StartWalk();
-		return true;
-	}
-	else
-	{
-		std::cout << "No path!" << std::endl;
-		Debug::DrawLine(GetOwner()->GetPosition(), position, Color32::Blue, 10.0f);
-		if(mFinishedPathCallback != nullptr)
-		{
-			mFinishedPathCallback();
-			mFinishedPathCallback = nullptr;
-		}
-		return false;
-	}
+	// Find a path from current position to target position.
+	// This happens in the background - walking starts once the path is found.
+	mPathRequestId = Services::Get<PathFinder>()->RequestPath(walkerBoundary, GetOwner()->GetPosition(), position,
+															  [this](bool found, std::vector<Vector3>& path) {
+		OnPathFound(found, path);
+	});
+	return true;
 }
 
 bool Walker::WalkToSee(const std::string& targetName, const Vector3& targetPosition, WalkerBoundary* walkerBoundary, std::function<void()> finishCallback)
 {
+	StopFollowingPath();
 	mWalkToSeeTarget = targetName;
 	mWalkToSeeTargetPosition = targetPosition;
 	std::cout << "Target is " << targetName << std::endl;
@@ -131,7 +124,8 @@ bool Walker::WalkToSee(const std::string& targetName, const Vector3& targetPosit
 	// Check whether thing is already in view.
 	// If so, we don't even need to walk (but may need to turn-to-face).
 	Vector3 facingDir;
-	if(IsWalkToSeeTargetInView(facingDir))
+	mWalkToSeeTargetInView = IsWalkToSeeTargetInView(facingDir);
+	if(mWalkToSeeTargetInView)
 	{
 		// Be sure to save finish callback in this case - it usually happens in walk to.
 		mFinishedPathCallback = finishCallback;
@@ -149,20 +143,8 @@ bool Walker::WalkToSee(const std::string& targetName, const Vector3& targetPosit
 
 void Walker::OnUpdate(float deltaTime)
 {
-	// If we have a "walk to see" target, check whether it has come into view.
-	bool stopWalkPrematurely = false;
-	if(!mWalkToSeeTarget.empty())
-	{
-		Vector3 facingDir;
-		if(IsWalkToSeeTargetInView(facingDir))
-		{
-			stopWalkPrematurely = true;
-			
-			// When doing a "walk to see," we want the actor to turn to face.
-			mHasDesiredFacingDir = true;
-			mDesiredFacingDir = facingDir;
-		}
-	}
+	// If we have a "walk to see" target and it came into view, we can stop walking early.
+	bool stopWalkPrematurely = !mWalkToSeeTarget.empty() && mWalkToSeeTargetInView;
 	
 	// Which direction should we turn to face? None at first.
 	Vector3 turnToFaceDir;
@@ -170,8 +152,6 @@ void Walker::OnUpdate(float deltaTime)
 	// If we have a path, follow it.
 	if(mPath.size() > 0)
 	{
-		Debug::DrawLine(mGKOwner->GetPosition(), mPath.back(), Color32::White);
-		
 		// Figure out where to move next.
 		// If we're near that spot, move on to the next spot.
 		Vector3 toNext = mPath.back() - mGKOwner->GetPosition();
@@ -189,12 +169,12 @@ void Walker::OnUpdate(float deltaTime)
 			if(mPath.size() <= 0)
 			{
 				// Stop walk anim.
-				StopWalk();
+				mStopWalkPending = true;
 				
 				// If no desired heading was specified, we can do the callback right now.
 				if(!mHasDesiredFacingDir)
 				{
-					OnWalkToFinished();
+					mWalkToFinishedPending = true;
 				}
 			}
 			else
@@ -261,12 +241,44 @@ void Walker::OnUpdate(float deltaTime)
 				mHasDesiredFacingDir = false;
 				
 				// At this point, we've REALLY finished our path.
-				OnWalkToFinished();
+				mWalkToFinishedPending = true;
 			}
 		}
 	}
 }
 
+void Walker::OnMainThreadUpdate()
+{
+	if(mPath.size() > 0)
+	{
+		Debug::DrawLine(mGKOwner->GetPosition(), mPath.back(), Color32::White);
+	}
+	
+	// Do anything steering decided on, but couldn't do itself.
+	if(mStopWalkPending)
+	{
+		mStopWalkPending = false;
+		StopWalk();
+	}
+	if(mWalkToFinishedPending)
+	{
+		OnWalkToFinished();
+	}
+	
+	// If we have a "walk to see" target, check whether it has come into view.
+	if(!mWalkToSeeTarget.empty())
+	{
+		Vector3 facingDir;
+		mWalkToSeeTargetInView = IsWalkToSeeTargetInView(facingDir);
+		if(mWalkToSeeTargetInView)
+		{
+			// When doing a "walk to see," we want the actor to turn to face.
+			mHasDesiredFacingDir = true;
+			mDesiredFacingDir = facingDir;
+		}
+	}
+}
+
 void Walker::StartWalk()
 {
 	if(mState == State::Idle)
@@ -317,12 +329,75 @@ void Walker::StopWalk()
 	}
 }
 
+void Walker::StopFollowingPath()
+{
+	// The old path is dropped without finishing it - its finish callback is about to be replaced,
+	// and the new callback shouldn't be called just because the old path ran out.
+	CancelPathRequest();
+	mPath.clear();
+	mWalkToFinishedPending = false;
+}
+
+void Walker::CancelPathRequest()
+{
+	if(mPathRequestId != 0)
+	{
+		Services::Get<PathFinder>()->CancelPath(mPathRequestId);
+		mPathRequestId = 0;
+	}
+}
+
+void Walker::OnPathFound(bool found, std::vector<Vector3>& path)
+{
+	mPathRequestId = 0;
+	if(found)
+	{
+		mPath.swap(path);
+		
+		//TODO: Make debug output of paths optional.
+		{
+			Vector3 prev = mPath.back();
+			for(int i = static_cast<int>(mPath.size()) - 2; i >= 0; i--)
+			{
+				Debug::DrawLine(prev, mPath[i], Color32::Red, 10.0f);
+				prev = mPath[i];
+			}
+		}
+		
+		StartWalk();
+	}
+	else
+	{
+		std::cout << "No path!" << std::endl;
+		Debug::DrawLine(GetOwner()->GetPosition(), mDestination, Color32::Blue, 10.0f);
+		
+		// May still be walking from an old path that was dropped for this one.
+		if(mState == State::Start || mState == State::Loop)
+		{
+			StopWalk();
+		}
+		if(mFinishedPathCallback != nullptr)
+		{
+			mFinishedPathCallback();
+			mFinishedPathCallback = nullptr;
+		}
+	}
+}
+
 void Walker::OnWalkToFinished()
 {
 	// Make sure state variables are cleared.
 	mPath.clear();
 	mHasDesiredFacingDir = false;
 	mWalkToSeeTarget.clear();
+	mWalkToSeeTargetInView = false;
+	mWalkToFinishedPending = false;
+	
+	// If an old path was dropped for this walk, the walk anim may still be going.
+	if(mState == State::Start || mState == State::Loop)
+	{
+		StopWalk();
+	}
 	
 	// Call finished callback.
 	if(mFinishedPathCallback != nullptr)
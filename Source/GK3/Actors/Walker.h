@@ -7,7 +7,7 @@
 // and walking from point to point in the game world.
 //
 // A walker is always associated with a GKActor.
-// The walker moves along a path using A*.
+// The walker moves along a path using A*. Paths are found in the background, by the PathFinder.
 //
 #pragma once
 #include "Component.h"
@@ -37,6 +37,7 @@ public:
 	};
 	
 	Walker(Actor* owner);
+	~Walker();
 	
 	void SetCharacterConfig(const CharacterConfig& characterConfig);
 	
@@ -46,11 +47,12 @@ public:
 	bool WalkTo(const Vector3& position, const Heading& heading, WalkerBoundary* walkerBoundary, std::function<void()> finishCallback);
 	bool WalkToSee(const std::string& targetName, const Vector3& targetPosition, WalkerBoundary* walkerBoundary, std::function<void()> finishCallback);
 	
-	bool IsWalking() const { return mState != State::Idle || mHasDesiredFacingDir; }
+	bool IsWalking() const { return mState != State::Idle || mHasDesiredFacingDir || mPathRequestId != 0; }
 	Vector3 GetDestination() const { return mDestination; }
 	
 protected:
 	void OnUpdate(float deltaTime) override;
+	void OnMainThreadUpdate() override;
 	
 private:
 	const float kAtNodeDistSq = 100.0f;
@@ -69,6 +71,9 @@ private:
 	// The path to follow to destination.
 	std::vector<Vector3> mPath;
 	
+	// If non-zero, a path is being found in the background.
+	unsigned int mPathRequestId = 0;
+	
 	// The current destination - only valid if walking.
 	Vector3 mDestination;
 	
@@ -83,6 +88,15 @@ private:
 	std::string mWalkToSeeTarget;
 	Vector3 mWalkToSeeTargetPosition;
 	
+	// Whether the walk to see target was in view when last checked.
+	// Checking raycasts against the scene, so it happens in OnMainThreadUpdate; OnUpdate uses the result on the next update.
+	bool mWalkToSeeTargetInView = false;
+	
+	// Steering in OnUpdate only flags when to stop the walk anim and call the finished callback.
+	// Those happen in OnMainThreadUpdate, right after.
+	bool mStopWalkPending = false;
+	bool mWalkToFinishedPending = false;
+	
 	// Turn speeds. A faster speed is used for turning in place when not walking.
 	const float kWalkTurnSpeed = Math::kPi;
 	const float kTurnSpeed = Math::k2Pi * 2;
@@ -94,6 +108,9 @@ private:
 	void ContinueWalk();
 	void StopWalk();
 	
+	void StopFollowingPath();
+	void CancelPathRequest();
+	void OnPathFound(bool found, std::vector<Vector3>& path);
 	void OnWalkToFinished();
 	
 	bool IsWalkToSeeTargetInView(Vector3& outTurnToFaceDir);
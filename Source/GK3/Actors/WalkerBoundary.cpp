@@ -5,20 +5,15 @@
 //
 #include "WalkerBoundary.h"
 
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <iostream>
 
+#include "DistanceTransform.h"
 #include "GMath.h"
 #include "Texture.h"
 
-struct NodeInfo
-{
-	Vector2 parent;
-	float h;
-	float g;
-	float GetF() { return h + g; }
-};
+bool WalkerBoundary::sKeepTextureForDebug = false;
 
 bool WalkerBoundary::FindPath(Vector3 from, Vector3 to, std::vector<Vector3>& outPath) const
 {
@@ -58,110 +53,367 @@ bool WalkerBoundary::FindPath(Vector3 from, Vector3 to, std::vector<Vector3>& ou
 		start = FindNearestWalkableTexturePosToWorldPos(from);
 	}
 	
-	// Let's try some A* to figure this out...
-	std::vector<Vector2> openSet;
-	std::unordered_set<Vector2, Vector2Hash> closedSet;
-	std::unordered_map<Vector2, NodeInfo, Vector2Hash> infos;
+	// Already at the goal (or no walk data, so anywhere is walkable) - path is just the goal itself.
+	if(mCellCosts.empty() || start == goal) { return true; }
+	
+	// Work with cell indexes from here on.
+	int width = mWidth;
+	int startIndex = static_cast<int>(start.y) * width + static_cast<int>(start.x);
+	int goalIndex = static_cast<int>(goal.y) * width + static_cast<int>(goal.x);
+	
+	// Gather the cells on the path, from goal back to start.
+	// Searching the full grid can touch a LOT of cells on big maps, so use the cluster graph to narrow down the search.
+	if(!FindClusterPath(startIndex, goalIndex))
+	{
+		return false;
+	}
+	
+	// The path steps one cell at a time, which would make the walker zig-zag toward each cell in turn.
+	// Collapse it to just the corners: from each corner, skip ahead as far as there's a straight, unobstructed line.
+	// To respect walk costs, a line can't cross cells more costly than the cells on the part of the path it replaces.
+	// Corners are gathered from start to goal, skipping the start and goal themselves.
+	mPathCorners.clear();
+	int anchor = static_cast<int>(mPathCellIndexes.size()) - 1;
+	while(anchor > 0)
+	{
+		int anchorX = mPathCellIndexes[anchor] % width;
+		int anchorY = mPathCellIndexes[anchor] / width;
+		int maxCost = GetCellCost(anchorX, anchorY);
+		
+		int next = anchor - 1;
+		maxCost = Math::Max(maxCost, GetCellCost(mPathCellIndexes[next] % width, mPathCellIndexes[next] / width));
+		for(int i = next - 1; i >= 0; --i)
+		{
+			int x = mPathCellIndexes[i] % width;
+			int y = mPathCellIndexes[i] / width;
+			maxCost = Math::Max(maxCost, GetCellCost(x, y));
+			if(!IsLineWalkable(anchorX, anchorY, x, y, maxCost)) { break; }
+			next = i;
+		}
+		
+		if(next > 0)
+		{
+			mPathCorners.push_back(mPathCellIndexes[next]);
+		}
+		anchor = next;
+	}
+	
+	// Skip goal node (we already added "to" at beginning of algorithm).
+	// Iterate back to start, pushing world position of each corner onto our path.
+	for(int i = static_cast<int>(mPathCorners.size()) - 1; i >= 0; --i)
+	{
+		outPath.push_back(TexturePosToWorldPos(Vector2(mPathCorners[i] % width, mPathCorners[i] / width)));
+	}
+	return true;
+}
+
+bool WalkerBoundary::SearchCells(int startIndex, int goalIndex, int minX, int minY, int maxX, int maxY) const
+{
+	int goalX = goalIndex >= 0 ? goalIndex % mWidth : 0;
+	int goalY = goalIndex >= 0 ? goalIndex / mWidth : 0;
+	
+	// Octile distance to goal: diagonal steps cover both axes at once, at sqrt(2) times the cost.
+	// Scaled by the cheapest possible cell, so it never overestimates the actual cost (A* stays optimal).
+	// With no goal, there's no heuristic (Dijkstra).
+	float heuristicScale = goalIndex >= 0 ? mMinCellCost : 0.0f;
+	auto heuristic = [heuristicScale, goalX, goalY](int x, int y) {
+		int dx = Math::Abs(x - goalX);
+		int dy = Math::Abs(y - goalY);
+		int minD = Math::Min(dx, dy);
+		int maxD = Math::Max(dx, dy);
+		return heuristicScale * ((maxD - minD) + Math::kSqrt2 * minD);
+	};
+	
+	// Start a new search generation. Any cell data from previous searches is now considered stale.
+	// If the counter wraps around, old generations could look current again, so reset everything in that (rare) case.
+	++mPathGeneration;
+	if(mPathGeneration == 0)
+	{
+		for(auto& cell : mPathCells)
+		{
+			cell.openGeneration = 0;
+			cell.closedGeneration = 0;
+		}
+		mPathGeneration = 1;
+	}
+	mOpenHeap.clear();
+	
+	// Start at the start node.
+	PathCell& startCell = mPathCells[startIndex];
+	startCell.g = 0.0f;
+	startCell.parent = -1;
+	startCell.openGeneration = mPathGeneration;
+	mOpenHeap.emplace_back(heuristic(startIndex % mWidth, startIndex / mWidth), startIndex);
 	
-	// Start with goal and put it in closed set.
-	Vector2 current = start;
-	closedSet.insert(current);
+	// Neighbor offsets - including diagonals!
+	const int kNeighborCount = 8;
+	const int neighborX[kNeighborCount] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+	const int neighborY[kNeighborCount] = { 1, -1, 0, 0, 1, -1, 1, -1 };
 	
-	// Iterate until we find the start node.
-	while(current != goal)
+	// Heap is ordered by lowest f value first.
+	std::greater<std::pair<float, int>> heapCompare;
+	while(!mOpenHeap.empty())
 	{
-		// Create neighbors array - including diagonals!
-		Vector2 neighbors[8];
-		neighbors[0] = current + Vector2::UnitY;
-		neighbors[1] = current - Vector2::UnitY;
-		neighbors[2] = current + Vector2::UnitX;
-		neighbors[3] = current - Vector2::UnitX;
+		// Take open node with lowest f value.
+		std::pop_heap(mOpenHeap.begin(), mOpenHeap.end(), heapCompare);
+		int currentIndex = mOpenHeap.back().second;
+		mOpenHeap.pop_back();
+		
+		// Rather than updating nodes in the heap when a cheaper route is found, we push them again.
+		// So, a node may come out of the heap more than once - only the first (cheapest) time counts.
+		PathCell& current = mPathCells[currentIndex];
+		if(current.closedGeneration == mPathGeneration) { continue; }
+		current.closedGeneration = mPathGeneration;
 		
-		neighbors[4] = current + Vector2(1, 1);
-		neighbors[5] = current + Vector2(1, -1);
-		neighbors[6] = current + Vector2(-1, 1);
-		neighbors[7] = current + Vector2(-1, -1);
+		if(currentIndex == goalIndex)
+		{
+			return true;
+		}
 		
 		// See if we should add neighbors to open set.
-		for(auto& neighbor : neighbors)
+		int currentX = currentIndex % mWidth;
+		int currentY = currentIndex / mWidth;
+		for(int i = 0; i < kNeighborCount; ++i)
 		{
-			// Ignore any neighbor that has pixel color black (not walkable).
-			Color32 color = mTexture->GetPixelColor32(neighbor.x, neighbor.y);
-			if(color == Color32::Black) { continue; }
+			int x = currentX + neighborX[i];
+			int y = currentY + neighborY[i];
+			if(x < minX || y < minY || x >= maxX || y >= maxY) { continue; }
+			
+			// Ignore anything already in the closed set.
+			int neighborIndex = y * mWidth + x;
+			PathCell& neighbor = mPathCells[neighborIndex];
+			if(neighbor.closedGeneration == mPathGeneration) { continue; }
+			
+			// Ignore any neighbor that isn't walkable.
+			int cellCost = GetCellCost(x, y);
+			if(cellCost == 0) { continue; }
 			
 			// So, setting edge cost to be exactly the palette index actually gives pretty decent results.
-			//int currentIndex = mTexture->GetPaletteIndex(current.x, current.y);
-			int neighborIndex = mTexture->GetPaletteIndex(neighbor.x, neighbor.y);
-			//float edgeCost = (neighbor - current).GetLength() + neighborIndex;
-			float edgeCost = neighborIndex;
+			// Diagonal steps cover more distance, so they cost proportionally more.
+			float edgeCost = (i >= 4) ? cellCost * Math::kSqrt2 : cellCost;
+			float newG = current.g + edgeCost;
 			
-			// Ignore anything already in the closed set.
-			if(closedSet.find(neighbor) != closedSet.end())
-			{
-				continue;
-			}
-			else if(std::find(openSet.begin(), openSet.end(), neighbor) != openSet.end())
-			{
-				// If in the open set, check for adoption.
-				// If lower g value, reparent to current.
-				float newG = infos[current].g + edgeCost;
-				if(newG < infos[neighbor].g)
-				{
-					infos[neighbor].parent = current;
-					infos[neighbor].g = newG;
-				}
-			}
-			else
+			// If this is a new node, or we found a cheaper way to get to it, (re)parent it to current.
+			if(neighbor.openGeneration != mPathGeneration || newG < neighbor.g)
 			{
-				// Found a new node - create an info for it and add to open set.
-				NodeInfo nodeInfo;
-				nodeInfo.parent = current;
-				
-				//nodeInfo.h = (goal - neighbor).GetLength();
-				nodeInfo.h = 0.0f; // No heuristic? (Dijkstra)
-				nodeInfo.g = infos[current].g + edgeCost;
-				infos[neighbor] = nodeInfo;
-				openSet.push_back(neighbor);
+				neighbor.g = newG;
+				neighbor.parent = currentIndex;
+				neighbor.openGeneration = mPathGeneration;
+				mOpenHeap.emplace_back(newG + heuristic(x, y), neighborIndex);
+				std::push_heap(mOpenHeap.begin(), mOpenHeap.end(), heapCompare);
 			}
 		}
+	}
+	
+	// Searched everything reachable. That's only a success if we were searching everything on purpose.
+	return goalIndex < 0;
+}
+
+bool WalkerBoundary::SearchCellsInCluster(int startIndex, int goalIndex, int cluster) const
+{
+	int minX = (cluster % mClusterCountX) * kClusterSize;
+	int minY = (cluster / mClusterCountX) * kClusterSize;
+	return SearchCells(startIndex, goalIndex, minX, minY, Math::Min(minX + kClusterSize, mWidth), Math::Min(minY + kClusterSize, mHeight));
+}
+
+float WalkerBoundary::GetSearchedCost(int cellIndex) const
+{
+	// Only cells finalized in the latest search have valid costs.
+	const PathCell& cell = mPathCells[cellIndex];
+	return cell.closedGeneration == mPathGeneration ? cell.g : -1.0f;
+}
+
+bool WalkerBoundary::FindClusterPath(int startIndex, int goalIndex) const
+{
+	mPathCellIndexes.clear();
+	
+	// If start and goal are in the same cluster, usually the best path stays in the cluster.
+	// But sometimes leaving the cluster is shorter, so keep this path's cost to compare with the graph search below.
+	int startCluster = GetCluster(startIndex);
+	int goalCluster = GetCluster(goalIndex);
+	float inClusterCost = -1.0f;
+	if(startCluster == goalCluster && SearchCellsInCluster(startIndex, goalIndex, startCluster))
+	{
+		AppendSearchedPath(startIndex, goalIndex);
+		inClusterCost = GetSearchedCost(goalIndex);
+	}
+	
+	// Abstract search over cluster entrances. Start and goal are temporary graph nodes, after all the real ones.
+	int nodeCount = static_cast<int>(mGraphNodes.size());
+	int startNode = nodeCount;
+	int goalNode = nodeCount + 1;
+	if(mGraphSearchNodes.size() < nodeCount + 2)
+	{
+		mGraphSearchNodes.resize(nodeCount + 2);
+	}
+	
+	// Connect start to entrances of its cluster.
+	mStartEdges.clear();
+	SearchCellsInCluster(startIndex, -1, startCluster);
+	for(int node : mClusters[startCluster].nodes)
+	{
+		float cost = GetSearchedCost(mGraphNodes[node].cell);
+		if(cost >= 0.0f)
+		{
+			mStartEdges.emplace_back(node, cost);
+		}
+	}
+	
+	// Connect entrances of goal's cluster to the goal.
+	// Costs are found searching outward from the goal. Cost to enter a cell makes that not *quite* the same as the other direction, but it's close.
+	mGoalEdges.clear();
+	SearchCellsInCluster(goalIndex, -1, goalCluster);
+	for(int node : mClusters[goalCluster].nodes)
+	{
+		float cost = GetSearchedCost(mGraphNodes[node].cell);
+		if(cost >= 0.0f)
+		{
+			mGoalEdges.emplace_back(node, cost);
+		}
+	}
+	if(mStartEdges.empty() || mGoalEdges.empty()) { return inClusterCost >= 0.0f; }
+	
+	// Same octile heuristic as the cell search, but between graph nodes.
+	int goalX = goalIndex % mWidth;
+	int goalY = goalIndex / mWidth;
+	auto heuristic = [this, goalX, goalY](int cellIndex) {
+		int dx = Math::Abs(cellIndex % mWidth - goalX);
+		int dy = Math::Abs(cellIndex / mWidth - goalY);
+		int minD = Math::Min(dx, dy);
+		int maxD = Math::Max(dx, dy);
+		return mMinCellCost * ((maxD - minD) + Math::kSqrt2 * minD);
+	};
+	
+	// A* over the graph - same approach as the cell search.
+	++mGraphSearchGeneration;
+	if(mGraphSearchGeneration == 0)
+	{
+		for(auto& node : mGraphSearchNodes)
+		{
+			node.openGeneration = 0;
+			node.closedGeneration = 0;
+		}
+		mGraphSearchGeneration = 1;
+	}
+	mOpenHeap.clear();
+	std::greater<std::pair<float, int>> heapCompare;
+	auto relax = [this, &heuristic, &heapCompare, goalNode, goalIndex](int fromNode, int toNode, float edgeCost) {
+		GraphSearchNode& to = mGraphSearchNodes[toNode];
+		if(to.closedGeneration == mGraphSearchGeneration) { return; }
+		
+		float newG = mGraphSearchNodes[fromNode].g + edgeCost;
+		if(to.openGeneration != mGraphSearchGeneration || newG < to.g)
+		{
+			to.g = newG;
+			to.parent = fromNode;
+			to.openGeneration = mGraphSearchGeneration;
+			mOpenHeap.emplace_back(newG + heuristic(toNode == goalNode ? goalIndex : mGraphNodes[toNode].cell), toNode);
+			std::push_heap(mOpenHeap.begin(), mOpenHeap.end(), heapCompare);
+		}
+	};
+	
+	GraphSearchNode& startSearchNode = mGraphSearchNodes[startNode];
+	startSearchNode.g = 0.0f;
+	startSearchNode.parent = -1;
+	startSearchNode.openGeneration = mGraphSearchGeneration;
+	mOpenHeap.emplace_back(0.0f, startNode);
+	bool foundGoal = false;
+	while(!mOpenHeap.empty())
+	{
+		std::pop_heap(mOpenHeap.begin(), mOpenHeap.end(), heapCompare);
+		int currentNode = mOpenHeap.back().second;
+		mOpenHeap.pop_back();
 		
-		// Could not find a path.
-		if(openSet.empty())
+		GraphSearchNode& current = mGraphSearchNodes[currentNode];
+		if(current.closedGeneration == mGraphSearchGeneration) { continue; }
+		current.closedGeneration = mGraphSearchGeneration;
+		
+		if(currentNode == goalNode)
 		{
-			return false;
+			foundGoal = true;
+			break;
 		}
 		
-		// Find open set item with lowest f value.
-		std::vector<Vector2>::iterator nextIt = openSet.begin();
-		float lowestF = infos[*nextIt].GetF();
-		for(auto it = openSet.begin() + 1; it != openSet.end(); it++)
+		if(currentNode == startNode)
 		{
-			NodeInfo nodeInfo = infos[*it];
-			if(nodeInfo.GetF() < lowestF)
+			for(auto& edge : mStartEdges)
 			{
-				nextIt = it;
-				lowestF = nodeInfo.GetF();
+				relax(currentNode, edge.first, edge.second);
+			}
+		}
+		else
+		{
+			for(auto& edge : mGraphNodes[currentNode].edges)
+			{
+				relax(currentNode, edge.first, edge.second);
+			}
+			if(mGraphNodes[currentNode].cluster == goalCluster)
+			{
+				for(auto& edge : mGoalEdges)
+				{
+					if(edge.first == currentNode)
+					{
+						relax(currentNode, goalNode, edge.second);
+						break;
+					}
+				}
 			}
 		}
-		
-		// This'll be the next node - remove from open set, put in closed set.
-		current = *nextIt;
-		openSet.erase(nextIt);
-		closedSet.insert(current);
 	}
+	if(!foundGoal) { return inClusterCost >= 0.0f; }
 	
-	// Skip goal node (we already added "to" at beginning of algorithm).
-	current = infos[current].parent;
+	// Stick with the path that stays in the cluster, unless going through other clusters is cheaper.
+	if(inClusterCost >= 0.0f && inClusterCost <= mGraphSearchNodes[goalNode].g) { return true; }
+	mPathCellIndexes.clear();
 	
-	// Iterate back to start, pushing world position of each node onto our path.
-	while(current != start)
+	// Refine the abstract path into cells - only searching the clusters along the way.
+	// Walk from goal back to start, so each segment's cells come out in goal-to-start order, which is what we want.
+	int toCell = goalIndex;
+	for(int node = mGraphSearchNodes[goalNode].parent; node >= 0; node = mGraphSearchNodes[node].parent)
 	{
-		outPath.push_back(TexturePosToWorldPos(current));
-		current = infos[current].parent;
+		int fromCell = (node == startNode) ? startIndex : mGraphNodes[node].cell;
+		if(fromCell != toCell)
+		{
+			// Between clusters, entrances are right next to one another.
+			// Within a cluster, search for the path between them (only within the cluster).
+			if(GetCluster(fromCell) != GetCluster(toCell))
+			{
+				mPathCellIndexes.push_back(toCell);
+			}
+			else
+			{
+				// Entrance costs are precalculated, so this should always succeed. But if it doesn't, the cells'
+				// parents are left over from older searches - following them could give a bogus path, or never end.
+				// In that case, fall back to searching the whole grid.
+				if(!SearchCellsInCluster(fromCell, toCell, GetCluster(fromCell)))
+				{
+					mPathCellIndexes.clear();
+					if(!SearchCells(startIndex, goalIndex, 0, 0, mWidth, mHeight)) { return false; }
+					AppendSearchedPath(startIndex, goalIndex);
+					return true;
+				}
+				for(int cell = toCell; cell != fromCell && cell >= 0; cell = mPathCells[cell].parent)
+				{
+					mPathCellIndexes.push_back(cell);
+				}
+			}
+		}
+		toCell = fromCell;
 	}
+	mPathCellIndexes.push_back(startIndex);
 	return true;
 }
 
+void WalkerBoundary::AppendSearchedPath(int startIndex, int goalIndex) const
+{
+	// Walk parents from goal back to start - appended in goal-to-start order.
+	for(int cell = goalIndex; cell >= 0; cell = mPathCells[cell].parent)
+	{
+		mPathCellIndexes.push_back(cell);
+		if(cell == startIndex) { break; }
+	}
+}
+
 Vector3 WalkerBoundary::FindNearestWalkablePosition(const Vector3& position) const
 {
 	// Easy case: the position provided is already walkable.
@@ -172,6 +424,363 @@ Vector3 WalkerBoundary::FindNearestWalkablePosition(const Vector3& position) con
 	return TexturePosToWorldPos(walkableTexturePos);
 }
 
+void WalkerBoundary::SetTexture(Texture* texture)
+{
+	mTexture = texture;
+	mSnapshot.reset();
+	
+	// Size pathfinding data to match the texture.
+	mPathCells.clear();
+	mOpenHeap.clear();
+	mPathGeneration = 0;
+	mGraphSearchGeneration = 0;
+	mClusters.clear();
+	mGraphNodes.clear();
+	mGraphSearchNodes.clear();
+	mWidth = 0;
+	mHeight = 0;
+	mCellCosts.clear();
+	mCellCostStride = 0;
+	mMinCellCost = 0.0f;
+	mNearestWalkableCells.clear();
+	if(mTexture == nullptr) { return; }
+	mWidth = mTexture->GetWidth();
+	mHeight = mTexture->GetHeight();
+	mPathCells.resize(mWidth * mHeight);
+	
+	// Pull walk costs out of the texture. Rows have room for a blocked cell on either side of the cells.
+	// Extra rows above/below are all blocked.
+	mCellCostStride = mWidth + kCellCostPadding * 2;
+	mCellCosts.assign(mCellCostStride * (mHeight + 2), 0);
+	ExtractCellCosts(0, 0, mWidth, mHeight);
+	
+	// Split the grid into clusters. Every cluster needs its entrance costs calculated.
+	mClusterCountX = (mWidth + kClusterSize - 1) / kClusterSize;
+	mClusterCountY = (mHeight + kClusterSize - 1) / kClusterSize;
+	mClusters.resize(mClusterCountX * mClusterCountY);
+	
+	RefreshWalkableData();
+	BuildClusterGraph();
+}
+
+void WalkerBoundary::OnTextureRegionChanged(int x, int y, int width, int height)
+{
+	if(mTexture == nullptr)
+	{
+		std::cout << "Can't update walker boundary region from texture - texture was released. Use SetCellCosts instead." << std::endl;
+		return;
+	}
+	
+	// Clamp region to the texture.
+	int minX = Math::Max(x, 0);
+	int minY = Math::Max(y, 0);
+	int maxX = Math::Min(x + width, mWidth);
+	int maxY = Math::Min(y + height, mHeight);
+	if(minX >= maxX || minY >= maxY) { return; }
+	
+	ExtractCellCosts(minX, minY, maxX, maxY);
+	OnCellCostsChanged(minX, minY, maxX, maxY);
+}
+
+void WalkerBoundary::SetCellCosts(int x, int y, int width, int height, const uint8_t* costs)
+{
+	if(costs == nullptr) { return; }
+	
+	// Clamp region to the boundary.
+	int minX = Math::Max(x, 0);
+	int minY = Math::Max(y, 0);
+	int maxX = Math::Min(x + width, mWidth);
+	int maxY = Math::Min(y + height, mHeight);
+	if(minX >= maxX || minY >= maxY) { return; }
+	
+	// Copy costs into place. Costs are for the unclamped region, so skip any parts that were clamped off.
+	for(int cellY = minY; cellY < maxY; ++cellY)
+	{
+		uint8_t* row = &mCellCosts[(cellY + 1) * mCellCostStride + kCellCostPadding];
+		const uint8_t* costRow = &costs[(cellY - y) * width - x];
+		for(int cellX = minX; cellX < maxX; ++cellX)
+		{
+			row[cellX] = costRow[cellX];
+		}
+	}
+	OnCellCostsChanged(minX, minY, maxX, maxY);
+}
+
+void WalkerBoundary::OnCellCostsChanged(int minX, int minY, int maxX, int maxY)
+{
+	// Only clusters overlapping the region need their entrance costs recalculated.
+	// Neighboring clusters may gain/lose entrances along a shared border, but that's caught when the graph is rebuilt.
+	for(int clusterY = minY / kClusterSize; clusterY <= (maxY - 1) / kClusterSize; ++clusterY)
+	{
+		for(int clusterX = minX / kClusterSize; clusterX <= (maxX - 1) / kClusterSize; ++clusterX)
+		{
+			mClusters[clusterY * mClusterCountX + clusterX].dirty = true;
+		}
+	}
+	
+	mSnapshot.reset();
+	RefreshWalkableData();
+	BuildClusterGraph();
+}
+
+std::shared_ptr<const WalkerBoundary> WalkerBoundary::GetSnapshot() const
+{
+	if(mSnapshot == nullptr)
+	{
+		mSnapshot = std::make_shared<WalkerBoundary>(*this);
+	}
+	return mSnapshot;
+}
+
+void WalkerBoundary::ExtractCellCosts(int minX, int minY, int maxX, int maxY)
+{
+	for(int y = minY; y < maxY; ++y)
+	{
+		uint8_t* row = &mCellCosts[(y + 1) * mCellCostStride + kCellCostPadding];
+		for(int x = minX; x < maxX; ++x)
+		{
+			// Black means not walkable at all (see IsTexturePosWalkable).
+			// Otherwise, the palette index indicates how "costly" it is to walk there.
+			// Zero is reserved for "blocked", so walkable cells always cost at least one.
+			if(mTexture->GetPixelColor32(x, y) == Color32::Black)
+			{
+				row[x] = 0;
+			}
+			else
+			{
+				row[x] = Math::Max(static_cast<int>(mTexture->GetPaletteIndex(x, y)), 1);
+			}
+		}
+	}
+}
+
+void WalkerBoundary::RefreshWalkableData()
+{
+	// Determine which cells are walkable.
+	// While we're at it, find the cheapest walkable cell, for the A* heuristic.
+	std::vector<unsigned char> walkable(mWidth * mHeight);
+	int minCost = 255;
+	for(int y = 0; y < mHeight; ++y)
+	{
+		const uint8_t* row = GetCellCostRow(y);
+		unsigned char* walkableRow = &walkable[y * mWidth];
+		for(int x = 0; x < mWidth; ++x)
+		{
+			walkableRow[x] = row[x] != 0 ? 1 : 0;
+			if(row[x] != 0)
+			{
+				minCost = Math::Min(minCost, static_cast<int>(row[x]));
+			}
+		}
+	}
+	mMinCellCost = minCost;
+	
+	// Precompute the nearest walkable cell to every cell, so nearest walkable queries don't need to search.
+	DistanceTransform::NearestFeature(walkable.data(), mWidth, mHeight, mNearestWalkableCells);
+}
+
+void WalkerBoundary::BuildClusterGraph()
+{
+	// Entrances are found from scratch each time - it's cheap compared to calculating costs between them.
+	mGraphNodes.clear();
+	for(auto& cluster : mClusters)
+	{
+		cluster.nodes.clear();
+	}
+	
+	// Adds a graph node for a cell, or returns the existing one.
+	auto getOrAddNode = [this](int cellIndex) {
+		int clusterIndex = GetCluster(cellIndex);
+		for(int node : mClusters[clusterIndex].nodes)
+		{
+			if(mGraphNodes[node].cell == cellIndex) { return node; }
+		}
+		mGraphNodes.emplace_back();
+		mGraphNodes.back().cell = cellIndex;
+		mGraphNodes.back().cluster = clusterIndex;
+		mClusters[clusterIndex].nodes.push_back(static_cast<int>(mGraphNodes.size()) - 1);
+		return static_cast<int>(mGraphNodes.size()) - 1;
+	};
+	
+	// Connects two cells on either side of a cluster border. Cost is the same as stepping between them in a cell search.
+	auto addEntrance = [this, &getOrAddNode](int x0, int y0, int x1, int y1) {
+		int node0 = getOrAddNode(y0 * mWidth + x0);
+		int node1 = getOrAddNode(y1 * mWidth + x1);
+		float scale = (x0 != x1 && y0 != y1) ? Math::kSqrt2 : 1.0f;
+		mGraphNodes[node0].edges.emplace_back(node1, GetCellCost(x1, y1) * scale);
+		mGraphNodes[node1].edges.emplace_back(node0, GetCellCost(x0, y0) * scale);
+	};
+	
+	// Finds entrances along one cluster border. Cells "a" are on one side, cells "b" on the other.
+	// A run of cells walkable on both sides gets an entrance in the middle, or at each end if the run is long.
+	// Walkers can also step diagonally across, so those spots need entrances too if nothing else connects them.
+	const int kLongEntranceLength = 6;
+	auto addBorderEntrances = [this, &addEntrance, kLongEntranceLength](int ax, int ay, int bx, int by, int stepX, int stepY, int length) {
+		auto isOpen = [this](int x, int y) {
+			return GetCellCost(x, y) != 0;
+		};
+		int runStart = -1;
+		for(int i = 0; i <= length; ++i)
+		{
+			bool open = i < length && isOpen(ax + stepX * i, ay + stepY * i) && isOpen(bx + stepX * i, by + stepY * i);
+			if(open && runStart < 0)
+			{
+				runStart = i;
+			}
+			else if(!open && runStart >= 0)
+			{
+				int runEnd = i - 1;
+				if(runEnd - runStart + 1 < kLongEntranceLength)
+				{
+					int mid = (runStart + runEnd) / 2;
+					addEntrance(ax + stepX * mid, ay + stepY * mid, bx + stepX * mid, by + stepY * mid);
+				}
+				else
+				{
+					addEntrance(ax + stepX * runStart, ay + stepY * runStart, bx + stepX * runStart, by + stepY * runStart);
+					addEntrance(ax + stepX * runEnd, ay + stepY * runEnd, bx + stepX * runEnd, by + stepY * runEnd);
+				}
+				runStart = -1;
+			}
+			
+			// Diagonal steps across the border, in either direction, where no straight step is possible on either end.
+			if(i < length && !open)
+			{
+				int aX = ax + stepX * i, aY = ay + stepY * i;
+				int bX = bx + stepX * i, bY = by + stepY * i;
+				bool nextOpen = isOpen(aX + stepX, aY + stepY) && isOpen(bX + stepX, bY + stepY);
+				if(!nextOpen && isOpen(aX, aY) && isOpen(bX + stepX, bY + stepY))
+				{
+					addEntrance(aX, aY, bX + stepX, bY + stepY);
+				}
+				if(!nextOpen && isOpen(bX, bY) && isOpen(aX + stepX, aY + stepY))
+				{
+					addEntrance(aX + stepX, aY + stepY, bX, bY);
+				}
+			}
+		}
+	};
+	for(int clusterY = 0; clusterY < mClusterCountY; ++clusterY)
+	{
+		for(int clusterX = 0; clusterX < mClusterCountX; ++clusterX)
+		{
+			int minX = clusterX * kClusterSize;
+			int minY = clusterY * kClusterSize;
+			int width = Math::Min(kClusterSize, mWidth - minX);
+			int height = Math::Min(kClusterSize, mHeight - minY);
+			
+			// Left border, then top border. Right/bottom borders are handled by the neighboring clusters.
+			if(clusterX > 0)
+			{
+				addBorderEntrances(minX - 1, minY, minX, minY, 0, 1, height);
+			}
+			if(clusterY > 0)
+			{
+				addBorderEntrances(minX, minY - 1, minX, minY, 1, 0, width);
+			}
+		}
+	}
+	
+	// Calculate costs between entrances of each cluster.
+	// If a cluster is unchanged and its entrances are the same as last time, previous costs are still good.
+	for(int clusterIndex = 0; clusterIndex < mClusters.size(); ++clusterIndex)
+	{
+		PathCluster& cluster = mClusters[clusterIndex];
+		int nodeCount = static_cast<int>(cluster.nodes.size());
+		bool sameNodes = !cluster.dirty && cluster.nodeCells.size() == nodeCount;
+		for(int i = 0; i < nodeCount && sameNodes; ++i)
+		{
+			sameNodes = cluster.nodeCells[i] == mGraphNodes[cluster.nodes[i]].cell;
+		}
+		if(!sameNodes)
+		{
+			cluster.nodeCells.resize(nodeCount);
+			for(int i = 0; i < nodeCount; ++i)
+			{
+				cluster.nodeCells[i] = mGraphNodes[cluster.nodes[i]].cell;
+			}
+			
+			// One search from each entrance finds costs to all other entrances.
+			cluster.costs.resize(nodeCount * nodeCount);
+			for(int i = 0; i < nodeCount; ++i)
+			{
+				SearchCellsInCluster(cluster.nodeCells[i], -1, clusterIndex);
+				for(int j = 0; j < nodeCount; ++j)
+				{
+					cluster.costs[i * nodeCount + j] = GetSearchedCost(cluster.nodeCells[j]);
+				}
+			}
+		}
+		cluster.dirty = false;
+		
+		// Connect entrances that can reach one another.
+		for(int i = 0; i < nodeCount; ++i)
+		{
+			for(int j = 0; j < nodeCount; ++j)
+			{
+				float cost = cluster.costs[i * nodeCount + j];
+				if(i != j && cost >= 0.0f)
+				{
+					mGraphNodes[cluster.nodes[i]].edges.emplace_back(cluster.nodes[j], cost);
+				}
+			}
+		}
+	}
+	mGraphSearchNodes.resize(mGraphNodes.size() + 2);
+}
+
+int WalkerBoundary::GetCluster(int cellIndex) const
+{
+	return ((cellIndex / mWidth) / kClusterSize) * mClusterCountX + (cellIndex % mWidth) / kClusterSize;
+}
+
+bool WalkerBoundary::IsLineWalkable(int x0, int y0, int x1, int y1, int maxCost) const
+{
+	// Walk every cell the line between the two cell centers touches (a "supercover" line).
+	// Unlike a plain Bresenham line, this doesn't miss cells the line only clips a corner of.
+	int dx = Math::Abs(x1 - x0);
+	int dy = Math::Abs(y1 - y0);
+	int stepX = (x1 > x0) ? 1 : -1;
+	int stepY = (y1 > y0) ? 1 : -1;
+	
+	// "error" tracks whether the line exits the current cell horizontally (> 0) or vertically (< 0) next.
+	int error = dx - dy;
+	dx *= 2;
+	dy *= 2;
+	
+	int x = x0;
+	int y = y0;
+	for(int remaining = 1 + (dx + dy) / 2; remaining > 0; --remaining)
+	{
+		int cost = GetCellCost(x, y);
+		if(cost == 0 || cost > maxCost) { return false; }
+		
+		if(error > 0)
+		{
+			x += stepX;
+			error -= dy;
+		}
+		else if(error < 0)
+		{
+			y += stepY;
+			error += dx;
+		}
+		else
+		{
+			// Line passes exactly through a corner - to be safe, both cells beside the corner must be OK.
+			int costX = GetCellCost(x + stepX, y);
+			int costY = GetCellCost(x, y + stepY);
+			if(costX == 0 || costX > maxCost || costY == 0 || costY > maxCost) { return false; }
+			
+			x += stepX;
+			y += stepY;
+			error += dx - dy;
+			--remaining;
+		}
+	}
+	return true;
+}
+
 bool WalkerBoundary::IsWorldPosWalkable(Vector3 worldPos) const
 {
 	// Convert to texture position and check that.
@@ -180,8 +789,8 @@ bool WalkerBoundary::IsWorldPosWalkable(Vector3 worldPos) const
 
 bool WalkerBoundary::IsTexturePosWalkable(Vector2 texturePos) const
 {
-	// If no texture...can walk anywhere?
-	if(mTexture == nullptr) { return true; }
+	// If no walk data...can walk anywhere?
+	if(mCellCosts.empty()) { return true; }
 	
 	// The color of the pixel at pos seems to indicate whether that spot is walkable.
 	// White = totally OK to walk 				(255, 255, 255)
@@ -193,16 +802,18 @@ bool WalkerBoundary::IsTexturePosWalkable(Vector2 texturePos) const
 	// Grey = pretty not OK to walk here 		(128, 128, 128)
 	// Cyan = this is your last warning, buddy 	(0, 255, 255)
 	// Black = totally not OK to walk 			(0, 0, 0)
-	Color32 color = mTexture->GetPixelColor32(texturePos.x, texturePos.y);
-	
 	// Basically, if the texture color is not black, you can walk there.
-	return color != Color32::Black;
+	// Black cells were given a walk cost of zero when extracted from the texture. Anything outside the texture isn't walkable either.
+	int x = static_cast<int>(texturePos.x);
+	int y = static_cast<int>(texturePos.y);
+	if(x < 0 || y < 0 || x >= mWidth || y >= mHeight) { return false; }
+	return GetCellCost(x, y) != 0;
 }
 
 Vector2 WalkerBoundary::WorldPosToTexturePos(Vector3 worldPos) const
 {
-	// If no texture, the end result is going to be zero.
-	if(mTexture == nullptr) { return Vector2::Zero; }
+	// If no walk data, the end result is going to be zero.
+	if(mCellCosts.empty()) { return Vector2::Zero; }
 	
 	// Add walker boundary's world position offset.
 	// This causes the position to be relative to the texture's origin (lower left) instead of the world origin.
@@ -218,13 +829,13 @@ Vector2 WalkerBoundary::WorldPosToTexturePos(Vector3 worldPos) const
 	//std::cout << "Normalized Pos: " << position << std::endl;
 	
 	// Multiply by texture width/height to determine the pixel within the texture.
-	texturePos.x = texturePos.x * mTexture->GetWidth();
-	texturePos.y = texturePos.y * mTexture->GetHeight();
+	texturePos.x = texturePos.x * mWidth;
+	texturePos.y = texturePos.y * mHeight;
 	//std::cout << "Pixel Pos: " << position << std::endl;
 	
 	// Need to flip Y because the calculated value is from lower-left of the walkable area.
 	// But texture sample X/Y are from upper-left.
-	texturePos.y = mTexture->GetHeight() - texturePos.y;
+	texturePos.y = mHeight - texturePos.y;
 	
 	// Texture positions are integers.
 	texturePos.x = (int)texturePos.x;
@@ -234,11 +845,11 @@ Vector2 WalkerBoundary::WorldPosToTexturePos(Vector3 worldPos) const
 
 Vector3 WalkerBoundary::TexturePosToWorldPos(Vector2 texturePos) const
 {
-	// If no texture, the end result is going to be zero.
-	if(mTexture == nullptr) { return Vector3::Zero; }
+	// If no walk data, the end result is going to be zero.
+	if(mCellCosts.empty()) { return Vector3::Zero; }
 	
 	// Flip y because texture pos is from top-left, but we need lower-left for world pos conversion.
-	texturePos.y = mTexture->GetHeight() - texturePos.y;
+	texturePos.y = mHeight - texturePos.y;
 	
 	// A texture pos actually correlates to the bottom-left corner of the pixel.
 	// But we want center of pixel...so let's offset before the conversion!
@@ -247,8 +858,8 @@ Vector3 WalkerBoundary::TexturePosToWorldPos(Vector2 texturePos) const
 	
 	// Divide by texture width/height to get normalized position within the texture (0-1).
 	Vector3 worldPos;
-	worldPos.x = texturePos.x / mTexture->GetWidth();
-	worldPos.z = texturePos.y / mTexture->GetHeight();
+	worldPos.x = texturePos.x / mWidth;
+	worldPos.z = texturePos.y / mHeight;
 	
 	// Multiply by size to get unit in world space.
 	worldPos.x = worldPos.x * mSize.x;
@@ -262,8 +873,8 @@ Vector3 WalkerBoundary::TexturePosToWorldPos(Vector2 texturePos) const
 
 Vector2 WalkerBoundary::FindNearestWalkableTexturePosToWorldPos(const Vector3& worldPos) const
 {
-	// We need a texture.
-	if(mTexture == nullptr) { return Vector2::Zero; }
+	// We need walk data.
+	if(mCellCosts.empty()) { return Vector2::Zero; }
 	
 	// If the passed in position is already walkable, just return that position in texture space.
 	if(IsWorldPosWalkable(worldPos))
@@ -274,25 +885,34 @@ Vector2 WalkerBoundary::FindNearestWalkableTexturePosToWorldPos(const Vector3& w
 	// Convert target position to texture position.
 	Vector2 targetTexturePos = WorldPosToTexturePos(worldPos);
 	
-	// Let's just brute force this for now - search O(n^2) for the nearest walkable position.
-	// This can probably be more efficient based on whether target is to left/right/above/below/inside the texture.
-	// But these walker boundary textures are really small, and this doesn't get called often, so this might work fine.
+	// If no cell is walkable, there's no good answer.
+	int width = mWidth;
+	int height = mHeight;
+	if(mNearestWalkableCells.empty() || mNearestWalkableCells[0] < 0) { return Vector2::Zero; }
+	
+	// Inside the texture, the nearest walkable cell was precomputed.
+	int x = static_cast<int>(targetTexturePos.x);
+	int y = static_cast<int>(targetTexturePos.y);
+	if(x >= 0 && y >= 0 && x < width && y < height)
+	{
+		int nearestIndex = mNearestWalkableCells[y * width + x];
+		return Vector2(nearestIndex % width, nearestIndex / width);
+	}
+	
+	// Outside the texture, we have to search. But this is rare, and a cell is walkable if it is its own nearest walkable cell.
+	// This can probably be more efficient based on whether target is to left/right/above/below the texture.
 	Vector2 nearestWalkableTexturePos;
-	float nearestDistanceSq = 9999.0f;
-	for(int x = 0; x < mTexture->GetWidth(); ++x)
+	float nearestDistanceSq = -1.0f;
+	for(int i = 0; i < mNearestWalkableCells.size(); ++i)
 	{
-		for(int y = 0; y < mTexture->GetHeight(); ++y)
+		if(mNearestWalkableCells[i] != i) { continue; }
+		
+		Vector2 pos(i % width, i / width);
+		float distSq = (pos - targetTexturePos).GetLengthSq();
+		if(nearestDistanceSq < 0.0f || distSq < nearestDistanceSq)
 		{
-			Vector2 pos(x, y);
-			if(IsTexturePosWalkable(pos))
-			{
-				float distSq = (pos - targetTexturePos).GetLengthSq();
-				if(distSq < nearestDistanceSq)
-				{
-					nearestWalkableTexturePos = pos;
-					nearestDistanceSq = distSq;
-				}
-			}
+			nearestWalkableTexturePos = pos;
+			nearestDistanceSq = distSq;
 		}
 	}
 	return nearestWalkableTexturePos;
@@ -8,6 +8,9 @@
 //
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "Vector2.h"
@@ -21,15 +24,37 @@ public:
 	bool FindPath(Vector3 from, Vector3 to, std::vector<Vector3>& outPath) const;
 	Vector3 FindNearestWalkablePosition(const Vector3& position) const;
 	
-	void SetTexture(Texture* texture) { mTexture = texture; }
+	void SetTexture(Texture* texture);
 	Texture* GetTexture() const { return mTexture; }
 	
-	void SetSize(const Vector2& size) { mSize = size; }
+	// Once walk costs are extracted from the texture, the texture is only needed for debug visualization.
+	// If not visualizing, the texture can be released (and unloaded) to save memory. Walk costs can still be changed after with SetCellCosts.
+	void ReleaseTexture() { mTexture = nullptr; mSnapshot.reset(); }
+	static bool sKeepTextureForDebug;
+	
+	void SetSize(const Vector2& size) { mSize = size; mSnapshot.reset(); }
 	Vector2 GetSize() const { return mSize; }
 	
-	void SetOffset(const Vector2& offset) { mOffset = offset; }
+	void SetOffset(const Vector2& offset) { mOffset = offset; mSnapshot.reset(); }
 	Vector2 GetOffset() const { return mOffset; }
 	
+	// Walk cost of cells in a row (0 if blocked, higher is more costly to walk on).
+	// Rows are padded so that reading one cell past either end gives a blocked cell.
+	const uint8_t* GetCellCostRow(int y) const { return &mCellCosts[(y + 1) * mCellCostStride + kCellCostPadding]; }
+	int GetCellCostStride() const { return mCellCostStride; }
+	
+	// Call if walkable data in part of the texture changes. Only affected parts of the path graph are recalculated.
+	// Walk costs are re-read from the texture, so this requires the texture to still be around.
+	void OnTextureRegionChanged(int x, int y, int width, int height);
+	
+	// Sets walk costs for part of the boundary directly - width * height costs, row by row (0 if blocked).
+	// Doesn't need the texture, so works after it has been released. Only affected parts of the path graph are recalculated.
+	void SetCellCosts(int x, int y, int width, int height, const uint8_t* costs);
+	
+	// An unchanging copy of this boundary, for finding paths on another thread.
+	// Searches use internal scratch data, so only one thread at a time should search a given snapshot.
+	std::shared_ptr<const WalkerBoundary> GetSnapshot() const;
+	
 private:
 	// The texture provides vital data about walkable areas.
 	// Each pixel correlates to a spot in the scene.
@@ -42,6 +67,104 @@ private:
 	// An offset for the bottom-left of the walker bounds from the origin.
 	Vector2 mOffset;
 	
+	// Texture size, in cells.
+	int mWidth = 0;
+	int mHeight = 0;
+	
+	// Walk cost of each cell, extracted from the texture: 0 if blocked, otherwise the palette index.
+	// Surrounded by blocked cells, so neighbors of any cell can be read without bounds checks.
+	// Each row has one blocked cell before and after it.
+	static const int kCellCostPadding = 1;
+	std::vector<uint8_t> mCellCosts;
+	int mCellCostStride = 0;
+	
+	// Lowest cost of stepping onto any walkable cell. Scales the A* heuristic so it never overestimates.
+	float mMinCellCost = 0.0f;
+	
+	// Per-cell pathfinding state, sized to the texture and reused for every search to avoid allocations.
+	// Rather than clearing these each search, a cell's data is only valid if its generation matches the current search.
+	struct PathCell
+	{
+		float g = 0.0f;
+		int parent = -1;
+		uint32_t openGeneration = 0;
+		uint32_t closedGeneration = 0;
+	};
+	mutable std::vector<PathCell> mPathCells;
+	mutable uint32_t mPathGeneration = 0;
+	
+	// Open set for A*, as a binary heap of (f, cell index) pairs. Also reused between searches.
+	mutable std::vector<std::pair<float, int>> mOpenHeap;
+	
+	// Cells on the found path, and the corners it's simplified to. Also reused between searches.
+	mutable std::vector<int> mPathCellIndexes;
+	mutable std::vector<int> mPathCorners;
+	
+	// To avoid searching the whole grid for long paths, the grid is split into square clusters.
+	// Walkable spots along cluster borders are "entrances" - nodes in a graph, connected by precalculated costs.
+	// Paths are found in the (much smaller) graph first, and then refined to cells only in clusters along the way.
+	static const int kClusterSize = 16;
+	struct PathCluster
+	{
+		// Graph nodes for entrances in this cluster.
+		std::vector<int> nodes;
+		
+		// Cells of entrances when costs were last calculated, and the costs between them (-1 if unreachable).
+		std::vector<int> nodeCells;
+		std::vector<float> costs;
+		
+		// If true, cells in the cluster changed, so costs must be recalculated.
+		bool dirty = true;
+	};
+	std::vector<PathCluster> mClusters;
+	int mClusterCountX = 0;
+	int mClusterCountY = 0;
+	
+	struct PathGraphNode
+	{
+		int cell = 0;
+		int cluster = 0;
+		std::vector<std::pair<int, float>> edges;
+	};
+	std::vector<PathGraphNode> mGraphNodes;
+	
+	// Per-node search state for the graph, reused between searches like the per-cell state.
+	// Has two extra nodes at the end for a search's start and goal.
+	struct GraphSearchNode
+	{
+		float g = 0.0f;
+		int parent = -1;
+		uint32_t openGeneration = 0;
+		uint32_t closedGeneration = 0;
+	};
+	mutable std::vector<GraphSearchNode> mGraphSearchNodes;
+	mutable uint32_t mGraphSearchGeneration = 0;
+	
+	// Costs from a search's start to entrances in its cluster, and from entrances in goal's cluster to the goal.
+	mutable std::vector<std::pair<int, float>> mStartEdges;
+	mutable std::vector<std::pair<int, float>> mGoalEdges;
+	
+	// Copy of this boundary, created on demand and thrown away whenever this boundary changes.
+	mutable std::shared_ptr<const WalkerBoundary> mSnapshot;
+	
+	// For each cell, the index of the nearest walkable cell (itself, if walkable). Built once, when texture is set.
+	std::vector<int> mNearestWalkableCells;
+	
+	void ExtractCellCosts(int minX, int minY, int maxX, int maxY);
+	void OnCellCostsChanged(int minX, int minY, int maxX, int maxY);
+	void RefreshWalkableData();
+	void BuildClusterGraph();
+	int GetCluster(int cellIndex) const;
+	
+	bool SearchCells(int startIndex, int goalIndex, int minX, int minY, int maxX, int maxY) const;
+	bool SearchCellsInCluster(int startIndex, int goalIndex, int cluster) const;
+	float GetSearchedCost(int cellIndex) const;
+	bool FindClusterPath(int startIndex, int goalIndex) const;
+	void AppendSearchedPath(int startIndex, int goalIndex) const;
+	
+	int GetCellCost(int x, int y) const { return mCellCosts[(y + 1) * mCellCostStride + kCellCostPadding + x]; }
+	bool IsLineWalkable(int x0, int y0, int x1, int y1, int maxCost) const;
+	
 	bool IsWorldPosWalkable(Vector3 worldPos) const;
 	bool IsTexturePosWalkable(Vector2 texturePos) const;
 	
@@ -5,7 +5,9 @@
 //
 #include "VertexAnimation.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <unordered_map>
@@ -13,6 +15,7 @@
 #include "BinaryReader.h"
 #include "GMath.h"
 #include "Matrix3.h"
+#include "SIMD.h"
 
 //#define DEBUG_OUTPUT
 
@@ -21,146 +24,122 @@ VertexAnimation::VertexAnimation(std::string name, char* data, int dataLength) :
     ParseFromData(data, dataLength);
 }
 
-Vector3 VertexAnimation::SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex)
+VertexAnimation::~VertexAnimation()
 {
-	float duration = GetDuration(framesPerSecond);
-	float localTime = time;
-	if(localTime > duration)
-	{
-		localTime = Math::Mod(time, duration);
-	}
-	
-	float currentPoseTime = 0.0f;
-    float nextPoseTime = 0.0f;
-	
-	// Find the first vertex pose defined for this mesh/submesh.
-	VertexAnimationVertexPose* firstVertexPose = nullptr;
-	auto it = mVertexPoses.find(meshIndex);
-	if(it != mVertexPoses.end())
+	for(auto& meshPoses : mVertexPoses)
 	{
-		auto it2 = it->second.find(submeshIndex);
-		if(it2 != it->second.end())
+		for(auto& submeshPoses : meshPoses)
 		{
-			firstVertexPose = it2->second;
+			glDeleteBuffers(1, &submeshPoses.mBuffer);
 		}
 	}
-	
+}
+
+Vector3 VertexAnimation::SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex)
+{
 	// If no vertex pose was found, we'll have to return an error state.
-	if(firstVertexPose == nullptr)
+	VertexAnimationSubmeshPoses* poses = GetVertexPoses(meshIndex, submeshIndex);
+	if(poses == nullptr || vertexIndex < 0 || vertexIndex >= poses->mVertexCount)
 	{
 		return Vector3::Zero;
 	}
 	
-	// Calculate how many seconds should be used for a single frame - used later.
-    float secondsPerFrame = 1.0f / framesPerSecond;
-	
-	// Determine the poses right before the desired local time on the animation.
-    VertexAnimationVertexPose* currentVertexPose = firstVertexPose;
-    while(currentVertexPose->mNext != nullptr)
-    {
-        currentPoseTime = secondsPerFrame * currentVertexPose->mFrameNumber;
-        nextPoseTime = secondsPerFrame * currentVertexPose->mNext->mFrameNumber;
-        if(nextPoseTime > localTime) { break; }
-		
-        currentVertexPose = currentVertexPose->mNext;
-    }
-	
-	// Get the next pose, after the desired local time.
-	// If it doesn't exist, loop back to the first pose.
-    VertexAnimationVertexPose* nextVertexPose = currentVertexPose->mNext;
-    if(nextVertexPose == nullptr)
-    {
-		nextVertexPose = currentVertexPose;
-		nextPoseTime = currentPoseTime;
-    }
-    
-    // Determine our "t" value between the current and next pose.
-    float t = 1.0f;
-    if(!Math::IsZero(nextPoseTime - currentPoseTime))
-    {
-        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
-    }
-    assert(t >= 0.0f && t <= 1.0f);
-	
-    // Now calculate interpolated positions between current and next poses for this time t.
-	return Vector3::Lerp(currentVertexPose->mVertexPositions[vertexIndex], nextVertexPose->mVertexPositions[vertexIndex], t);
+	// Interpolate between poses on either side of the time.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 0.0f;
+	FindVertexPoses(time, framesPerSecond, *poses, currentIndex, nextIndex, t);
+	return Vector3::Lerp(poses->GetPose(currentIndex)[vertexIndex], poses->GetPose(nextIndex)[vertexIndex], t);
 }
 
-VertexAnimationVertexPose VertexAnimation::SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex)
+bool VertexAnimation::SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex, float* outPositions)
 {
-	float duration = GetDuration(framesPerSecond);
-	float localTime = time;
-	if(localTime > duration)
-	{
-		localTime = Math::Mod(time, duration);
-	}
+	VertexAnimationSubmeshPoses* poses = GetVertexPoses(meshIndex, submeshIndex);
+	if(poses == nullptr) { return false; }
 	
-    float currentPoseTime = 0.0f;
-    float nextPoseTime = 0.0f;
+	// Find poses on either side of the time.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 0.0f;
+	FindVertexPoses(time, framesPerSecond, *poses, currentIndex, nextIndex, t);
+	
+	// Vector3 is just three floats, so we can treat a pose as one big float array.
+	const float* from = reinterpret_cast<const float*>(poses->GetPose(currentIndex));
+	const float* to = reinterpret_cast<const float*>(poses->GetPose(nextIndex));
+	int count = poses->mVertexCount * 3;
 	
-	// Find the first vertex pose defined for this mesh/submesh.
-	VertexAnimationVertexPose* firstVertexPose = nullptr;
-	auto it = mVertexPoses.find(meshIndex);
-	if(it != mVertexPoses.end())
+	// Exactly on a pose (common when clamped at the end, or when sampling a specific frame) is just a copy.
+	if(currentIndex == nextIndex || t <= 0.0f)
 	{
-		auto it2 = it->second.find(submeshIndex);
-		if(it2 != it->second.end())
-		{
-			firstVertexPose = it2->second;
-		}
+		memcpy(outPositions, from, count * sizeof(float));
+		return true;
 	}
-	
-	// If no vertex pose was found, we'll have to return an error state.
-	if(firstVertexPose == nullptr)
+	if(t >= 1.0f)
 	{
-		VertexAnimationVertexPose pose;
-		pose.mFrameNumber = -1;
-		return pose;
+		memcpy(outPositions, to, count * sizeof(float));
+		return true;
 	}
 	
-	// Calculate how many seconds should be used for a single frame - used later.
-    float secondsPerFrame = 1.0f / framesPerSecond;
+	// Now calculate interpolated positions between current and next poses for this time t.
+	// Same math as Vector3::Lerp, but several floats at a time.
+	int index = 0;
+	#if defined(SIMD_SSE)
+	const __m128 fromScale = _mm_set1_ps(1.0f - t);
+	const __m128 toScale = _mm_set1_ps(t);
+	for(; index + 4 <= count; index += 4)
+	{
+		__m128 a = _mm_mul_ps(fromScale, _mm_loadu_ps(from + index));
+		__m128 b = _mm_mul_ps(toScale, _mm_loadu_ps(to + index));
+		_mm_storeu_ps(outPositions + index, _mm_add_ps(a, b));
+	}
+	#elif defined(SIMD_NEON)
+	const float32x4_t fromScale = vdupq_n_f32(1.0f - t);
+	const float32x4_t toScale = vdupq_n_f32(t);
+	for(; index + 4 <= count; index += 4)
+	{
+		float32x4_t a = vmulq_f32(fromScale, vld1q_f32(from + index));
+		float32x4_t b = vmulq_f32(toScale, vld1q_f32(to + index));
+		vst1q_f32(outPositions + index, vaddq_f32(a, b));
+	}
+	#endif
 	
-	// Determine the poses right before the desired local time on the animation.
-    VertexAnimationVertexPose* currentVertexPose = firstVertexPose;
-    while(currentVertexPose->mNext != nullptr)
-    {
-        currentPoseTime = secondsPerFrame * currentVertexPose->mFrameNumber;
-        nextPoseTime = secondsPerFrame * currentVertexPose->mNext->mFrameNumber;
-        if(nextPoseTime > localTime) { break; }
-		
-        currentVertexPose = currentVertexPose->mNext;
-    }
+	// Scalar path for any remaining floats (or all of them, if no SIMD).
+	for(; index < count; ++index)
+	{
+		outPositions[index] = ((1.0f - t) * from[index]) + (t * to[index]);
+	}
+	return true;
+}
+
+bool VertexAnimation::SampleVertexPoseIndexes(float time, int framesPerSecond, int meshIndex, int submeshIndex, int& outFromIndex, int& outToIndex, float& outT)
+{
+	VertexAnimationSubmeshPoses* poses = GetVertexPoses(meshIndex, submeshIndex);
+	if(poses == nullptr) { return false; }
 	
-	// Get the next pose, after the desired local time.
-	// If it doesn't exist, loop back to the first pose.
-    VertexAnimationVertexPose* nextVertexPose = currentVertexPose->mNext;
-    if(nextVertexPose == nullptr)
-    {
-		// Clamp approach.
-		nextVertexPose = currentVertexPose;
-		nextPoseTime = currentPoseTime;
-		
-		// Loop approach.
-        //nextVertexPose = firstVertexPose;
-        //nextPoseTime = GetDuration(framesPerSecond);
-    }
-    
-    // Determine our "t" value between the current and next pose.
-    float t = 1.0f;
-    if(!Math::IsZero(nextPoseTime - currentPoseTime))
-    {
-        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
-    }
-    assert(t >= 0.0f && t <= 1.0f);
+	FindVertexPoses(time, framesPerSecond, *poses, outFromIndex, outToIndex, outT);
+	return true;
+}
+
+GLuint VertexAnimation::GetVertexPoseBuffer(int meshIndex, int submeshIndex)
+{
+	VertexAnimationSubmeshPoses* poses = GetVertexPoses(meshIndex, submeshIndex);
+	if(poses == nullptr) { return GL_NONE; }
 	
-    // Now calculate interpolated positions between current and next poses for this time t.
-	VertexAnimationVertexPose pose;
-    for(int i = 0; i < currentVertexPose->mVertexPositions.size(); i++)
-    {
-        pose.mVertexPositions.push_back(Vector3::Lerp(currentVertexPose->mVertexPositions[i], nextVertexPose->mVertexPositions[i], t));
-    }
-    return pose;
+	// Upload to GPU on first request. This data never changes, so it's only done once per animation.
+	// Poses are already contiguous in memory, and that's the layout the GPU wants too.
+	if(poses->mBuffer == GL_NONE)
+	{
+		glGenBuffers(1, &poses->mBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, poses->mBuffer);
+		glBufferData(GL_ARRAY_BUFFER, poses->mPositions.size() * sizeof(Vector3), poses->mPositions.data(), GL_STATIC_DRAW);
+	}
+	return poses->mBuffer;
+}
+
+int VertexAnimation::GetVertexPoseVertexCount(int meshIndex, int submeshIndex)
+{
+	VertexAnimationSubmeshPoses* poses = GetVertexPoses(meshIndex, submeshIndex);
+	return poses != nullptr ? poses->mVertexCount : 0;
 }
 
 VertexAnimationTransformPose VertexAnimation::SampleTransformPose(float time, int framesPerSecond, int meshIndex)
@@ -223,6 +202,92 @@ VertexAnimationTransformPose VertexAnimation::SampleTransformPose(float time, in
     return pose;
 }
 
+VertexAnimationSubmeshPoses* VertexAnimation::GetVertexPoses(int meshIndex, int submeshIndex)
+{
+	if(meshIndex >= 0 && meshIndex < mVertexPoses.size() &&
+	   submeshIndex >= 0 && submeshIndex < mVertexPoses[meshIndex].size())
+	{
+		VertexAnimationSubmeshPoses& poses = mVertexPoses[meshIndex][submeshIndex];
+		if(poses.GetPoseCount() > 0)
+		{
+			return &poses;
+		}
+	}
+	return nullptr;
+}
+
+void VertexAnimation::AddVertexPose(int meshIndex, int submeshIndex, int frameNumber, const std::vector<Vector3>& positions)
+{
+	// Make room for this mesh/submesh, if needed.
+	if(meshIndex >= mVertexPoses.size())
+	{
+		mVertexPoses.resize(meshIndex + 1);
+	}
+	if(submeshIndex >= mVertexPoses[meshIndex].size())
+	{
+		mVertexPoses[meshIndex].resize(submeshIndex + 1);
+	}
+	
+	// The first pose decides the vertex count. All poses must match it, or we couldn't index into the pose data.
+	VertexAnimationSubmeshPoses& poses = mVertexPoses[meshIndex][submeshIndex];
+	if(poses.GetPoseCount() == 0)
+	{
+		poses.mVertexCount = static_cast<int>(positions.size());
+	}
+	else if(positions.size() != poses.mVertexCount)
+	{
+		std::cout << "Vertex pose for mesh " << meshIndex << ", submesh " << submeshIndex << " has wrong vertex count - ignoring it." << std::endl;
+		return;
+	}
+	
+	// Poses are parsed in frame order, so appending keeps frame numbers sorted.
+	poses.mFrameNumbers.push_back(frameNumber);
+	poses.mPositions.insert(poses.mPositions.end(), positions.begin(), positions.end());
+}
+
+void VertexAnimation::FindVertexPoses(float time, int framesPerSecond, const VertexAnimationSubmeshPoses& poses,
+									  int& outCurrentIndex, int& outNextIndex, float& outT) const
+{
+	float duration = GetDuration(framesPerSecond);
+	float localTime = time;
+	if(localTime > duration)
+	{
+		localTime = Math::Mod(time, duration);
+	}
+	
+	// Calculate how many seconds should be used for a single frame - used later.
+    float secondsPerFrame = 1.0f / framesPerSecond;
+	
+	// Find the first pose AFTER the desired local time; the one before it is the current pose.
+	// Frame numbers are sorted, so a binary search works.
+	auto it = std::upper_bound(poses.mFrameNumbers.begin(), poses.mFrameNumbers.end(), localTime, [secondsPerFrame](float time, int frameNumber) {
+		return time < secondsPerFrame * frameNumber;
+	});
+	int currentIndex = std::max(static_cast<int>(it - poses.mFrameNumbers.begin()) - 1, 0);
+	
+	// Get the next pose, after the desired local time.
+	// If it doesn't exist, clamp on the last pose (the commented out "loop" approach would use the first pose).
+	int nextIndex = currentIndex + 1;
+	if(nextIndex >= poses.GetPoseCount())
+	{
+		nextIndex = currentIndex;
+	}
+	
+    // Determine our "t" value between the current and next pose.
+	float currentPoseTime = secondsPerFrame * poses.mFrameNumbers[currentIndex];
+	float nextPoseTime = secondsPerFrame * poses.mFrameNumbers[nextIndex];
+    float t = 1.0f;
+    if(!Math::IsZero(nextPoseTime - currentPoseTime))
+    {
+        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
+    }
+    assert(t >= 0.0f && t <= 1.0f);
+	
+	outCurrentIndex = currentIndex;
+	outNextIndex = nextIndex;
+	outT = t;
+}
+
 void VertexAnimation::ParseFromData(char *data, int dataLength)
 {
     #ifdef DEBUG_OUTPUT
@@ -269,9 +334,11 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
         offsets.push_back(reader.ReadUInt());
     }
     
-    std::unordered_map<int, VertexAnimationVertexPose*> lastVertexPoseLookup;
     std::unordered_map<int, VertexAnimationTransformPose*> lastTransformPoseLookup;
 	
+	// Vertex positions are read into here before being added to the contiguous pose data for the submesh.
+	std::vector<Vector3> positions;
+	
 	// Read in data for each keyframe.
     for(int i = 0; i < mFrameCount; i++)
     {
@@ -321,24 +388,6 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     #ifdef DEBUG_OUTPUT
                     std::cout << "        Submesh Index: " << submeshIndex << std::endl;
                     #endif
-					
-					// This is a pretty sorry hash...but assuming we'll never
-					// have more than 1000 submeshes (pretty likely for GK3), this'll do OK.
-                    int hash = meshIndex * 1000 + submeshIndex;
-					
-					// Create a vertex pose for this frame and stick it in our dictionary and linked list.
-                    VertexAnimationVertexPose* vertexPose = new VertexAnimationVertexPose();
-                    vertexPose->mFrameNumber = i;
-                    if(i == 0)
-                    {
-                        mVertexPoses[meshIndex][submeshIndex] = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-                    else
-                    {
-                        lastVertexPoseLookup[hash]->mNext = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
                     
                     // 2 bytes: Vertex count.
                     unsigned short vertexCount = reader.ReadUShort();
@@ -347,13 +396,17 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     #endif
                     
                     // Next, three floats per vertex (X, Y, Z).
+					positions.clear();
                     for(int k = 0; k < vertexCount; k++)
                     {
                         float x = reader.ReadFloat();
 						float z = reader.ReadFloat();
                         float y = reader.ReadFloat();
-                        vertexPose->mVertexPositions.push_back(Vector3(x, y, z));
+                        positions.push_back(Vector3(x, y, z));
                     }
+					
+					// Add a vertex pose for this frame.
+					AddVertexPose(meshIndex, submeshIndex, i, positions);
                 }
                 // Identifier 1 also is vertex data, but in a compressed format.
                 else if(dataId == 1)
@@ -372,29 +425,23 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     std::cout << "        Submesh Index: " << submeshIndex << std::endl;
                     #endif
                     
-                    // Find position data from last recorded frame.
-                    int hash = meshIndex * 1000 + submeshIndex;
-                    std::vector<Vector3>& prevPositions = lastVertexPoseLookup[hash]->mVertexPositions;
-					
-					// Create a vertex pose to hold this new data and insert it into the vertex pose chain.
-                    VertexAnimationVertexPose* vertexPose = new VertexAnimationVertexPose();
-                    vertexPose->mFrameNumber = i;
-                    if(i == 0)
-                    {
-						mVertexPoses[meshIndex][submeshIndex] = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-                    else
-                    {
-                        lastVertexPoseLookup[hash]->mNext = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-					
                     // 2 bytes: Vertex count.
                     unsigned short vertexCount = reader.ReadUShort();
                     #ifdef DEBUG_OUTPUT
                     std::cout << "        Vertex Count: " << vertexCount << std::endl;
                     #endif
+					
+                    // Find position data from last recorded frame - compressed data is relative to it.
+					const Vector3* prevPositions = nullptr;
+					VertexAnimationSubmeshPoses* prevPoses = GetVertexPoses(meshIndex, submeshIndex);
+					if(prevPoses != nullptr && prevPoses->mVertexCount == vertexCount)
+					{
+						prevPositions = prevPoses->GetPose(prevPoses->GetPoseCount() - 1);
+					}
+					else
+					{
+						std::cout << "Compressed vertex data for mesh " << meshIndex << ", submesh " << submeshIndex << " has no matching previous pose!" << std::endl;
+					}
                     
                     // Next ((VertexCount/4) + 1) bytes: Compression info for vertex data.
                     // Every 2 bits indicates how the vertex at that index is compressed.
@@ -429,13 +476,16 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     }
                     
                     // Now that we have deciphered how each vertex is compressed, we can read in each vertex.
+					positions.clear();
                     for(int k = 0; k < vertexCount; k++)
                     {
+						Vector3 prevPosition = prevPositions != nullptr ? prevPositions[k] : Vector3::Zero;
+						
 						// 0 means no vertex data, so just use whatever we had for the previous frame.
 						// If the vertex data hasn't changed since last frame, it isn't stored, to save space.
                         if(vertexDataFormat[k] == 0)
                         {
-                            vertexPose->mVertexPositions.push_back(prevPositions[k]);
+                            positions.push_back(prevPosition);
                         }
                         // 1 means (X, Y, Z) are compressed in next 3 bytes.
 						// This tends to be used for storing vertex position delta for internal vertices in a mesh.
@@ -444,7 +494,7 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = DecompressFloatFromByte(reader.ReadByte());
 							float z = DecompressFloatFromByte(reader.ReadByte());
                             float y = DecompressFloatFromByte(reader.ReadByte());
-                            vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+                            positions.push_back(prevPosition + Vector3(x, y, z));
                         }
                         // 2 means (X, Y, Z) are compressed in next 3 ushorts.
 						// This tends to be used for storing vertex position deltas where meshes meet (like a knee or elbow).
@@ -453,7 +503,7 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = DecompressFloatFromUShort(reader.ReadUShort());
 							float z = DecompressFloatFromUShort(reader.ReadUShort());
 							float y = DecompressFloatFromUShort(reader.ReadUShort());
-							vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+							positions.push_back(prevPosition + Vector3(x, y, z));
                         }
                         // 3 means (X, Y, Z) are not compressed - just floats.
                         else if(vertexDataFormat[k] == 3)
@@ -461,13 +511,16 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = reader.ReadFloat();
 							float z = reader.ReadFloat();
                             float y = reader.ReadFloat();
-                            vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+                            positions.push_back(prevPosition + Vector3(x, y, z));
                         }
                     }
                     
                     // Don't need these anymore!
                     delete[] compressionInfo;
                     delete[] vertexDataFormat;
+					
+					// Add a vertex pose for this frame.
+					AddVertexPose(meshIndex, submeshIndex, i, positions);
                 }
                 // Identifier 2 is transform matrix data.
                 else if(dataId == 2)
@@ -12,17 +12,30 @@
 #include "Asset.h"
 
 #include <vector>
-#include <unordered_map>
+
+#include <GL/glew.h>
 
 #include "Matrix4.h"
 #include "Vector3.h"
 
-struct VertexAnimationVertexPose
+// All vertex poses for a single submesh.
+// Poses are stored back-to-back in one contiguous block, so sampling doesn't need to chase pointers or allocate.
+struct VertexAnimationSubmeshPoses
 {
-    int mFrameNumber = 0;
+    // Number of vertices in each pose.
+    int mVertexCount = 0;
+    
+    // Frame number of each pose, in ascending order.
+    std::vector<int> mFrameNumbers;
+    
+    // Vertex positions for all poses. Pose N's positions start at index (N * mVertexCount).
+    std::vector<Vector3> mPositions;
+    
+    // GPU copy of all vertex positions, created on demand.
+    GLuint mBuffer = GL_NONE;
     
-    std::vector<Vector3> mVertexPositions;
-    VertexAnimationVertexPose* mNext = nullptr;
+    int GetPoseCount() const { return static_cast<int>(mFrameNumbers.size()); }
+    const Vector3* GetPose(int index) const { return mPositions.data() + index * mVertexCount; }
 };
 
 struct VertexAnimationTransformPose
@@ -47,12 +60,27 @@ class VertexAnimation : public Asset
 {
 public:
     VertexAnimation(std::string name, char* data, int dataLength);
+    ~VertexAnimation();
     
 	// Queries the position of a single vertex at a particular time of the animation.
 	Vector3 SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex);
 	
 	// Queries positions of ALL vertices for a submesh at a particular time of the animation.
-	VertexAnimationVertexPose SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex);
+	// Positions are written to caller-provided storage, which must fit (GetVertexPoseVertexCount * 3) floats.
+	// Returns false (and writes nothing) if there are no vertex poses for the mesh/submesh.
+	bool SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex, float* outPositions);
+	
+	// Queries which two vertex poses (by index) a time falls between for a submesh, and the "t" value between them.
+	// Rather than interpolating on the CPU, the caller can use these to blend vertex pose buffers on the GPU.
+	// Returns false if there are no vertex poses for the mesh/submesh.
+	bool SampleVertexPoseIndexes(float time, int framesPerSecond, int meshIndex, int submeshIndex, int& outFromIndex, int& outToIndex, float& outT);
+	
+	// Gets a GPU buffer containing ALL vertex poses for a submesh, back-to-back in pose order. Uploaded on first request.
+	// Returns GL_NONE if there are no vertex poses for the mesh/submesh.
+	GLuint GetVertexPoseBuffer(int meshIndex, int submeshIndex);
+	
+	// Number of vertices in each vertex pose for a submesh. Must match the submesh's vertex count to play correctly!
+	int GetVertexPoseVertexCount(int meshIndex, int submeshIndex);
 	
 	// Queries a mesh's transform properties (position, rotation, scale) at a particular time of the animation.
 	VertexAnimationTransformPose SampleTransformPose(float time, int framesPerSecond, int meshIndex);
@@ -71,13 +99,18 @@ private:
 	// If we ever play the animation on a mismatched model, the graphics will probably glitch out.
 	std::string mModelName;
     
-	// Each array element is the FIRST vertex pose for each mesh/submesh index.
-	// Subsequent poses for the mesh are stored in the "next" of the first pose.
-	std::unordered_map<int, std::unordered_map<int, VertexAnimationVertexPose*>> mVertexPoses;
+	// Vertex poses, indexed by mesh index, then submesh index.
+	// Submeshes without any vertex poses have a pose count of zero.
+	std::vector<std::vector<VertexAnimationSubmeshPoses>> mVertexPoses;
 	
 	// Each element of array is the FIRST transform poses for each mesh index.
 	// Subsequent poses for the mesh are stored in the "next" of the first pose.
     std::vector<VertexAnimationTransformPose*> mTransformPoses;
+	
+	VertexAnimationSubmeshPoses* GetVertexPoses(int meshIndex, int submeshIndex);
+	void AddVertexPose(int meshIndex, int submeshIndex, int frameNumber, const std::vector<Vector3>& positions);
+	void FindVertexPoses(float time, int framesPerSecond, const VertexAnimationSubmeshPoses& poses,
+						 int& outCurrentIndex, int& outNextIndex, float& outT) const;
     
     void ParseFromData(char* data, int dataLength);
     
@@ -10,13 +10,23 @@
 #include "Actor.h"
 #include "Mesh.h"
 #include "MeshRenderer.h"
+#include "Services.h"
 #include "VertexAnimation.h"
 
 TYPE_DEF_CHILD(Component, VertexAnimator);
 
+bool VertexAnimator::sUseGPUInterpolation = true;
+Shader* VertexAnimator::sVertexAnimShader = nullptr;
+
+static constexpr UniformId kVertexAnimBlendId = HashUniformName("uVertexAnimBlend");
+
 VertexAnimator::VertexAnimator(Actor* owner) : Component(owner)
 {
 	mMeshRenderer = owner->GetComponent<MeshRenderer>();
+	
+	// Sampling on the CPU only writes to this animator's own buffer, so it can happen in parallel with other actors.
+	// Meshes may be shared with other actors using the same model, so they're only changed in OnMainThreadUpdate.
+	SetUpdatePhase(UpdatePhase::Animation, true);
 }
 
 void VertexAnimator::Start(VertexAnimation* anim, int framesPerSecond, std::function<void()> stopCallback)
@@ -47,6 +57,13 @@ void VertexAnimator::Stop(VertexAnimation* anim)
 	// Stop if animation matches playing one OR null was passed in.
 	if(mVertexAnimation != nullptr && (mVertexAnimation == anim || anim == nullptr))
 	{
+		// The pose we stop on may be displayed for a while (and raycasted against), so make sure CPU-side positions match it.
+		if(mSampledOnGPU)
+		{
+			float animDuration = mVertexAnimation->GetDuration(mFramesPerSecond);
+			TakeSample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration), false);
+		}
+		
 		// Fire stop callback if an animation was in progress.
 		if(mStopCallback != nullptr)
 		{
@@ -56,6 +73,7 @@ void VertexAnimator::Stop(VertexAnimation* anim)
 		// Reset state data.
 		mVertexAnimation = nullptr;
 		mStopCallback = nullptr;
+		mSamplePending = false;
 	}
 }
 
@@ -77,32 +95,88 @@ void VertexAnimator::OnUpdate(float deltaTime)
 		mVertexAnimationTimer += deltaTime;
 		
 		// Sample animation at current timer value, clamping to anim duration.
+		// This may be on any thread, so only do the CPU part - the rest happens in OnMainThreadUpdate.
 		float animDuration = mVertexAnimation->GetDuration(mFramesPerSecond);
-		TakeSample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration));
-		
-		// If at the end of the animation, clear animation.
-		// GK3 doesn't really have the concept of a "looping" animation. Looping is handled by higher-level control scripts.
-		if(mVertexAnimationTimer >= animDuration)
+		SampleCPU(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration), sUseGPUInterpolation);
+		mSamplePending = true;
+	}
+}
+
+void VertexAnimator::OnMainThreadUpdate()
+{
+	// Anim may have been stopped or changed since OnUpdate (e.g. by another actor's callback) - if so, nothing to finish.
+	if(!mSamplePending) { return; }
+	mSamplePending = false;
+	
+	// Finish the sample started in OnUpdate.
+	float animDuration = mVertexAnimation->GetDuration(mFramesPerSecond);
+	ApplySample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration), sUseGPUInterpolation);
+	
+	// If at the end of the animation, clear animation.
+	// GK3 doesn't really have the concept of a "looping" animation. Looping is handled by higher-level control scripts.
+	if(mVertexAnimationTimer >= animDuration)
+	{
+		Stop(nullptr);
+	}
+}
+
+void VertexAnimator::TakeSample(VertexAnimation* animation, float time, bool useGPU)
+{
+	SampleCPU(animation, time, useGPU);
+	ApplySample(animation, time, useGPU);
+}
+
+void VertexAnimator::SampleCPU(VertexAnimation* animation, float time, bool useGPU)
+{
+	// Interpolate positions on the CPU for any submesh that can't be blended on the GPU.
+	// Only this animator's sample buffer is written, so this is safe to call from any thread.
+	mSamplePositions.clear();
+	mSampleOffsets.clear();
+	const std::vector<Mesh*>& meshes = mMeshRenderer->GetMeshes();
+	for(int i = 0; i < meshes.size(); i++)
+	{
+		const std::vector<Submesh*>& submeshes = meshes[i]->GetSubmeshes();
+		for(int j = 0; j < submeshes.size(); j++)
 		{
-			Stop(nullptr);
+			int sampleOffset = -1;
+			if(!useGPU || !CanTakeGPUSample(animation, i, j, submeshes[j]))
+			{
+				sampleOffset = TakeCPUSample(animation, time, i, j, submeshes[j]);
+			}
+			mSampleOffsets.push_back(sampleOffset);
 		}
 	}
 }
 
-void VertexAnimator::TakeSample(VertexAnimation* animation, float time)
+void VertexAnimator::ApplySample(VertexAnimation* animation, float time, bool useGPU)
 {
-	// Iterate through each mesh and sample it in the vertex animation.
-	// We need to sample both vertex poses and transform poses to get the right result.
-	const std::vector<Mesh*> meshes = mMeshRenderer->GetMeshes();
+	// Iterate through each mesh and apply the sample to it.
+	// We need to apply both vertex poses and transform poses to get the right result.
+	mSampledOnGPU = false;
+	int sampleIndex = 0;
+	const std::vector<Mesh*>& meshes = mMeshRenderer->GetMeshes();
 	for(int i = 0; i < meshes.size(); i++)
 	{
 		const std::vector<Submesh*>& submeshes = meshes[i]->GetSubmeshes();
-		for(int j = 0; j < submeshes.size(); j++)
+		for(int j = 0; j < submeshes.size(); j++, sampleIndex++)
 		{
-			VertexAnimationVertexPose sample = animation->SampleVertexPose(time, mFramesPerSecond, i, j);
-			if(sample.mFrameNumber >= 0)
+			// Prefer interpolating on the GPU, but the CPU path works for any submesh.
+			// The GPU path can still fail here (e.g. shader didn't load), in which case fall back to the CPU path after all.
+			if(sampleIndex < mSampleOffsets.size() && mSampleOffsets[sampleIndex] >= 0)
+			{
+				UploadCPUSample(i, j, submeshes[j], mSampleOffsets[sampleIndex]);
+			}
+			else if(useGPU && TakeGPUSample(animation, time, i, j, submeshes[j]))
+			{
+				mSampledOnGPU = true;
+			}
+			else
 			{
-                submeshes[j]->SetPositions(reinterpret_cast<float*>(sample.mVertexPositions.data()), true);
+				int sampleOffset = TakeCPUSample(animation, time, i, j, submeshes[j]);
+				if(sampleOffset >= 0)
+				{
+					UploadCPUSample(i, j, submeshes[j], sampleOffset);
+				}
 			}
 		}
 		
@@ -113,3 +187,83 @@ void VertexAnimator::TakeSample(VertexAnimation* animation, float time)
 		}
 	}
 }
+
+bool VertexAnimator::CanTakeGPUSample(VertexAnimation* animation, int meshIndex, int submeshIndex, Submesh* submesh)
+{
+	// Poses must line up with the submesh's vertices (this is also zero if the submesh isn't animated).
+	if(animation->GetVertexPoseVertexCount(meshIndex, submeshIndex) != submesh->GetVertexCount())
+	{
+		return false;
+	}
+	
+	// The material must be using a shader we have a blending variant of.
+	Material* material = mMeshRenderer->GetMaterial(meshIndex, submeshIndex);
+	if(material == nullptr) { return false; }
+	return material->GetShader() == Material::sDefaultShader || material->GetShader() == sVertexAnimShader;
+}
+
+bool VertexAnimator::TakeGPUSample(VertexAnimation* animation, float time, int meshIndex, int submeshIndex, Submesh* submesh)
+{
+	if(!CanTakeGPUSample(animation, meshIndex, submeshIndex, submesh)) { return false; }
+	
+	// Find poses to blend between. If none exist, this submesh isn't animated.
+	int fromIndex = 0;
+	int toIndex = 0;
+	float t = 0.0f;
+	if(!animation->SampleVertexPoseIndexes(time, mFramesPerSecond, meshIndex, submeshIndex, fromIndex, toIndex, t))
+	{
+		return false;
+	}
+	
+	// Lazy load the blending shader.
+	if(sVertexAnimShader == nullptr)
+	{
+		sVertexAnimShader = Services::GetAssets()->LoadShader("3D-Diffuse-Tex-VertexAnim", "3D-Diffuse-Tex");
+		if(sVertexAnimShader == nullptr)
+		{
+			// Don't try again - just use the CPU path from now on.
+			sUseGPUInterpolation = false;
+			return false;
+		}
+	}
+	
+	// Get poses on the GPU (only uploads the first time).
+	GLuint poseBuffer = animation->GetVertexPoseBuffer(meshIndex, submeshIndex);
+	if(poseBuffer == GL_NONE) { return false; }
+	
+	// Point submesh at the two poses, and have the shader blend between them.
+	Material* material = mMeshRenderer->GetMaterial(meshIndex, submeshIndex);
+	submesh->SetPositionKeyframes(poseBuffer, fromIndex, toIndex);
+	material->SetShader(sVertexAnimShader);
+	material->SetFloat(kVertexAnimBlendId, t);
+	return true;
+}
+
+int VertexAnimator::TakeCPUSample(VertexAnimation* animation, float time, int meshIndex, int submeshIndex, Submesh* submesh)
+{
+	// Poses must line up with the submesh's vertices (this is also zero if the submesh isn't animated).
+	if(submesh->GetVertexCount() == 0 || animation->GetVertexPoseVertexCount(meshIndex, submeshIndex) != submesh->GetVertexCount()) { return -1; }
+	
+	// Sample into the end of the sample buffer. The buffer is kept between samples, so this usually doesn't allocate.
+	int sampleOffset = static_cast<int>(mSamplePositions.size());
+	mSamplePositions.resize(sampleOffset + submesh->GetVertexCount() * 3);
+	if(!animation->SampleVertexPose(time, mFramesPerSecond, meshIndex, submeshIndex, &mSamplePositions[sampleOffset]))
+	{
+		mSamplePositions.resize(sampleOffset);
+		return -1;
+	}
+	return sampleOffset;
+}
+
+void VertexAnimator::UploadCPUSample(int meshIndex, int submeshIndex, Submesh* submesh, int sampleOffset)
+{
+	// Copies sampled positions into the submesh and uploads them. This also stops the submesh from using GPU poses, if it was.
+	submesh->SetPositions(&mSamplePositions[sampleOffset], true);
+	
+	// Likewise, go back to the default shader if we were blending on the GPU.
+	Material* material = mMeshRenderer->GetMaterial(meshIndex, submeshIndex);
+	if(material != nullptr && sVertexAnimShader != nullptr && material->GetShader() == sVertexAnimShader)
+	{
+		material->SetShader(Material::sDefaultShader);
+	}
+}
@@ -9,8 +9,11 @@
 #include "Component.h"
 
 #include <functional>
+#include <vector>
 
 class MeshRenderer;
+class Shader;
+class Submesh;
 class VertexAnimation;
 
 /*
@@ -34,6 +37,10 @@ class VertexAnimator : public Component
 {
 	TYPE_DECL_CHILD();
 public:
+	// If true, vertex poses are uploaded to the GPU once per animation, and the vertex shader interpolates between them.
+	// If false (or a submesh can't use that path), poses are interpolated on the CPU and re-uploaded each sample.
+	static bool sUseGPUInterpolation;
+	
 	VertexAnimator(Actor* owner);
 	
 	void Start(VertexAnimation* anim, int framesPerSecond, std::function<void()> stopCallback);
@@ -46,6 +53,7 @@ public:
 	
 protected:
 	void OnUpdate(float deltaTime) override;
+	void OnMainThreadUpdate() override;
 	
 private:
 	// The mesh renderer that will be animated.
@@ -64,5 +72,30 @@ private:
 	// Timer for tracking progress on vertex animation.
 	float mVertexAnimationTimer = 0.0f;
 	
-	void TakeSample(VertexAnimation* animation, float time);
+	// Shader used to blend vertex poses on the GPU.
+	// It's a variant of the default shader, so only submeshes using the default shader can use the GPU path.
+	static Shader* sVertexAnimShader;
+	
+	// If true, some submesh was last sampled on the GPU, so its CPU-side positions are out of date.
+	bool mSampledOnGPU = false;
+	
+	// Update samples on whatever thread it's on, but uploading the sample to the GPU waits for the main thread.
+	bool mSamplePending = false;
+	
+	// Positions interpolated on the CPU by the last sample, for all submeshes back-to-back.
+	// Submeshes belong to the model, which other actors may be using too - so they're only written on the main thread, by copying from here.
+	std::vector<float> mSamplePositions;
+	
+	// For each submesh (in MeshRenderer material order), where its positions start in mSamplePositions. Or -1 if not sampled on the CPU.
+	std::vector<int> mSampleOffsets;
+	
+	// Sampling happens in two parts: interpolating on the CPU (safe on any thread), then uploading or setting up GPU blending (main thread only).
+	void TakeSample(VertexAnimation* animation, float time, bool useGPU = sUseGPUInterpolation);
+	void SampleCPU(VertexAnimation* animation, float time, bool useGPU);
+	void ApplySample(VertexAnimation* animation, float time, bool useGPU);
+	
+	bool CanTakeGPUSample(VertexAnimation* animation, int meshIndex, int submeshIndex, Submesh* submesh);
+	bool TakeGPUSample(VertexAnimation* animation, float time, int meshIndex, int submeshIndex, Submesh* submesh);
+	int TakeCPUSample(VertexAnimation* animation, float time, int meshIndex, int submeshIndex, Submesh* submesh);
+	void UploadCPUSample(int meshIndex, int submeshIndex, Submesh* submesh, int sampleOffset);
 };
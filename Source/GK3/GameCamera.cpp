@@ -23,6 +23,37 @@ GameCamera::GameCamera()
     AddComponent<AudioListener>();
 }
 
+void GameCamera::SetBounds(Model* boundsModel)
+{
+	mBoundsModel = boundsModel;
+	
+	// Collision tests happen every frame, but the bounds never move.
+	// So, transform all triangles to world space once, up front.
+	// Bounds model is positioned at (0,0,0) in world space (so no need to multiply local to world...it's identity).
+	// BUT each mesh in the model has its own local coordinate system!
+	std::vector<Triangle> triangles;
+	if(mBoundsModel != nullptr)
+	{
+		for(auto& mesh : mBoundsModel->GetMeshes())
+		{
+			const Matrix4& meshToLocal = mesh->GetMeshToLocalMatrix();
+			for(auto& submesh : mesh->GetSubmeshes())
+			{
+				Vector3 p0, p1, p2;
+				int triangleCount = submesh->GetTriangleCount();
+				for(int i = 0; i < triangleCount; i++)
+				{
+					if(submesh->GetTriangle(i, p0, p1, p2))
+					{
+						triangles.emplace_back(meshToLocal.TransformPoint(p0), meshToLocal.TransformPoint(p1), meshToLocal.TransformPoint(p2));
+					}
+				}
+			}
+		}
+	}
+	mBoundsTriangles.Build(triangles);
+}
+
 void GameCamera::SetAngle(const Vector2& angle)
 {
 	SetAngle(angle.x, angle.y);
@@ -325,63 +356,22 @@ void GameCamera::ResolveCollisions(Vector3& position)
 	// Bounds may also be purposely disabled for debugging purposes.
 	if(mBoundsModel == nullptr || !mBoundsEnabled) { return; }
 	
-	// We'll represent the camera with a sphere and the bounds are a model (triangles).
-	// Iterate and do a collision check against the triangles of the bounds model.
-	auto meshes = mBoundsModel->GetMeshes();
-	for(auto& mesh : meshes)
+	// We'll represent the camera with a sphere and the bounds are triangles.
+	// Only triangles near the sphere can collide. Pushes out of triangles move the sphere too,
+	// so search an extra radius in each direction to catch triangles the sphere gets pushed into.
+	const float kSearchSize = kColliderRadius * 4.0f;
+	mBoundsTriangles.Query(AABB(position, kSearchSize, kSearchSize, kSearchSize), mNearbyTriangleIndexes);
+	
+	// Test in the bounds model's triangle order, so pushes happen in the same order as testing every triangle would.
+	Sphere s(position, kColliderRadius);
+	for(int index : mNearbyTriangleIndexes)
 	{
-		// Bounds model is positioned at (0,0,0) in world space (so no need to multiply local to world...it's identity).
-		// BUT each mesh in the model has its own local coordinate system!
-		// We need to convert camera position to local space of the mesh before doing collision check.
-		Matrix4 meshToLocal = mesh->GetMeshToLocalMatrix();
-        Matrix4 localToMesh = Matrix4::InverseTransform(meshToLocal);
-		Vector3 meshPosition = localToMesh.TransformPoint(position);
-		
-		// Create sphere at position.
-		const float kCameraColliderRadius = 20.0f;
-		Sphere s(meshPosition, kCameraColliderRadius);
-		
-		// Iterate submeshes/submesh triangles.
-		auto submeshes = mesh->GetSubmeshes();
-		for(auto& submesh : submeshes)
+		// If an intersection exists, resolve it by "pushing" position out.
+		Vector3 intersection;
+		if(Collisions::TestSphereTriangle(s, mBoundsTriangles.GetTriangle(index), intersection))
 		{
-			Vector3 p0, p1, p2;
-			int triangleCount = submesh->GetTriangleCount();
-			for(int i = 0; i < triangleCount; i++)
-			{
-				if(submesh->GetTriangle(i, p0, p1, p2))
-				{
-					/*
-					if(meshNumber >= 19 && meshNumber <= 22)
-					{
-						Triangle triangle(p0, p1, p2);
-						Vector3 pointOnTriangle = triangle.GetClosestPoint(s.center);
-						Debug::DrawLine(Vector3::Zero, meshToLocal.TransformPoint(pointOnTriangle), Color32::Green);
-					}
-					*/
-					
-					// If an intersection exists, resolve it by "pushing" mesh position out.
-					Vector3 intersection;
-					if(Collisions::TestSphereTriangle(s, Triangle(p0, p1, p2), intersection))
-					{
-						meshPosition += intersection;
-						s = Sphere(meshPosition, kCameraColliderRadius);
-					}
-				}
-				
-				/*
-				Vector3 normal;
-				if(submesh->GetNormal(i, normal))
-				{
-					Vector3 triCenter = meshToLocal.TransformPoint((p0 + p1 + p2) / 3);
-					Debug::DrawLine(triCenter, triCenter + (normal * 10.0f), Color32::Blue);
-				}
-				*/
-			}
+			position += intersection;
+			s = Sphere(position, kColliderRadius);
 		}
-		
-		// We modified the local position while iterating submeshes.
-		// We now need to go back to "world" space.
-		position = meshToLocal.TransformPoint(meshPosition);
 	}
 }
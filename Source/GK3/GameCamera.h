@@ -8,6 +8,10 @@
 #pragma once
 #include "Actor.h"
 
+#include <vector>
+
+#include "TriangleGrid.h"
+
 class GKObject;
 class Model;
 
@@ -16,7 +20,7 @@ class GameCamera : public Actor
 public:
     GameCamera();
 	
-	void SetBounds(Model* boundsModel) { mBoundsModel = boundsModel; }
+	void SetBounds(Model* boundsModel);
 	void SetBoundsEnabled(bool enabled) { mBoundsEnabled = enabled; }
 	
 	void SetAngle(const Vector2& angle);
@@ -50,8 +54,17 @@ private:
 	const float kDefaultHeight = 60.0f;
 	float mHeight = kDefaultHeight;
 	
+	// Radius of the sphere representing the camera for collision.
+	const float kColliderRadius = 20.0f;
+	
 	// A model whose triangles are used as collision for the camera.
 	Model* mBoundsModel = nullptr;
+	
+	// The bounds model's triangles in world space, gridded so only nearby triangles need to be checked.
+	TriangleGrid mBoundsTriangles;
+	
+	// Triangles near the camera, reused between frames to avoid allocating.
+	std::vector<int> mNearbyTriangleIndexes;
 		
 	// If true, camera bounds are turned on. If false, they are disabled.
     bool mBoundsEnabled = false;
@@ -25,6 +25,7 @@
 #include "RectTransform.h"
 #include "Services.h"
 #include "SoundtrackPlayer.h"
+#include "Sphere.h"
 #include "StatusOverlay.h"
 #include "StringUtil.h"
 #include "Walker.h"
@@ -39,7 +40,8 @@ Scene::Scene(const std::string& name, const std::string& timeblock) : Scene(name
 
 Scene::Scene(const std::string& name, const Timeblock& timeblock) :
 	mLocation(name),
-	mTimeblock(timeblock)
+	mTimeblock(timeblock),
+	mSpatialTree(10.0f) // Actors usually move a bit each frame - a margin means they only sometimes need to move in the tree.
 {
 	// Create game camera.
 	mCamera = new GameCamera();
@@ -317,6 +319,9 @@ void Scene::Load()
 		}
 	}
 	
+	// All objects exist now, so they can go in the spatial index.
+	BuildSpatialIndex();
+	
 	// Check for and run "scene enter" actions.
 	Services::Get<ActionManager>()->ExecuteAction("SCENE", "ENTER");
 }
@@ -326,6 +331,10 @@ void Scene::Unload()
 	Services::GetRenderer()->SetBSP(nullptr);
 	Services::GetRenderer()->SetSkybox(nullptr);
 	
+	mSpatialTree.Clear();
+	mSpatialEntries.clear();
+	mBSPActorsByObjectIndex.clear();
+	
 	delete mSceneData;
 	mSceneData = nullptr;
 }
@@ -344,6 +353,7 @@ bool Scene::InitEgoPosition(const std::string& positionName)
 	
 	// Make sure Ego stays grounded.
 	mEgo->SnapToFloor();
+	mEgo->ResetInterpolation();
 	
 	// Should also set camera position/angle.
 	// Output a warning if specified position has no camera though.
@@ -381,30 +391,47 @@ void Scene::SetCameraPosition(const std::string& cameraName)
 	// Set position/angle.
 	mCamera->SetPosition(camera->position);
 	mCamera->SetAngle(camera->angle);
+	
+	// This is a cut - the camera shouldn't be seen moving from its old position.
+	mCamera->GetTransform()->ResetInterpolation();
 }
 
 SceneCastResult Scene::Raycast(const Ray& ray, bool interactiveOnly, const GKObject* ignore) const
 {
 	SceneCastResult result;
+	UpdateSpatialIndex();
 	
 	// Check props/actors before BSP.
 	// Later, we'll check BSP and see if we hit something obscuring a prop/actor.
-	for(auto& object : mObjects)
-	{
+	auto raycastEntry = [&ray, interactiveOnly, ignore, &result](const SpatialEntry& entry) {
+		// BSP actors are checked with the BSP below.
+		if(entry.meshRenderer == nullptr || entry.object == ignore) { return; }
+		
 		// If only interested in interactive objects, skip non-interactive objects.
-		if(interactiveOnly && !object->CanInteract()) { continue; }
+		if(interactiveOnly && !entry.object->CanInteract()) { return; }
 		
 		// Raycast to see if this is the closest thing we've hit.
 		// If so, we save it as our current result.
-		MeshRenderer* meshRenderer = object->GetMeshRenderer();
 		RaycastHit hitInfo;
-		if(meshRenderer != nullptr && meshRenderer->Raycast(ray, hitInfo))
+		if(entry.meshRenderer->Raycast(ray, hitInfo) && hitInfo.t < result.hitInfo.t)
 		{
-			if(hitInfo.t < result.hitInfo.t)
-			{
-				result.hitInfo = hitInfo;
-				result.hitObject = object;
-			}
+			result.hitInfo = hitInfo;
+			result.hitObject = entry.object;
+		}
+	};
+	
+	// The tree gives objects along the ray, nearest first, and skips any whose bounds are past the nearest hit so far.
+	mSpatialTree.Raycast(ray, result.hitInfo.t, [this, &raycastEntry, &result](int entryIndex, float maxT) -> float {
+		raycastEntry(mSpatialEntries[entryIndex]);
+		return result.hitInfo.t;
+	});
+	
+	// Objects without bounds aren't in the tree, so they must always be checked.
+	for(auto& entry : mSpatialEntries)
+	{
+		if(entry.proxyId < 0)
+		{
+			raycastEntry(entry);
 		}
 	}
 	
@@ -420,25 +447,22 @@ SceneCastResult Scene::Raycast(const Ray& ray, bool interactiveOnly, const GKObj
 	if(bsp != nullptr)
 	{
 		RaycastHit hitInfo;
-		if(bsp->RaycastNearest(ray, hitInfo))
+		int objectIndex = -1;
+		if(bsp->RaycastNearest(ray, hitInfo, objectIndex))
 		{
 			// If "t" is smaller, then the BSP object obscured any previous hit.
 			if(hitInfo.t < result.hitInfo.t)
 			{
 				result.hitInfo = hitInfo;
+				result.hitObject = nullptr;
 				
 				// See if hit any actor representing BSP object.
-				for(auto& bspActor : mBSPActors)
+				BSPActor* bspActor = objectIndex < mBSPActorsByObjectIndex.size() ? mBSPActorsByObjectIndex[objectIndex] : nullptr;
+				
+				// If only interested in interactive objects, skip non-interactive objects.
+				if(bspActor != nullptr && (!interactiveOnly || bspActor->CanInteract()))
 				{
-					// If only interested in interactive objects, skip non-interactive objects.
-					if(interactiveOnly && !bspActor->CanInteract()) { continue; }
-					
-					// Check whether this is the BSP actor we hit.
-					if(StringUtil::EqualsIgnoreCase(bspActor->GetName(), hitInfo.name))
-					{
-						result.hitObject = bspActor;
-						break;
-					}
+					result.hitObject = bspActor;
 				}
 			}
 		}
@@ -446,6 +470,39 @@ SceneCastResult Scene::Raycast(const Ray& ray, bool interactiveOnly, const GKObj
 	return result;
 }
 
+void Scene::GetObjectsInAABB(const AABB& aabb, std::vector<GKObject*>& outObjects) const
+{
+	outObjects.clear();
+	UpdateSpatialIndex();
+	
+	// Tree gives objects with fat bounds touching the box - check actual bounds too.
+	std::vector<int> entryIndexes;
+	mSpatialTree.Query(aabb, entryIndexes);
+	for(int entryIndex : entryIndexes)
+	{
+		if(Collisions::TestAABBAABB(mSpatialEntries[entryIndex].aabb, aabb))
+		{
+			outObjects.push_back(mSpatialEntries[entryIndex].object);
+		}
+	}
+}
+
+void Scene::GetObjectsInSphere(const Sphere& sphere, std::vector<GKObject*>& outObjects) const
+{
+	outObjects.clear();
+	UpdateSpatialIndex();
+	
+	std::vector<int> entryIndexes;
+	mSpatialTree.Query(sphere, entryIndexes);
+	for(int entryIndex : entryIndexes)
+	{
+		if(Collisions::TestSphereAABB(sphere, mSpatialEntries[entryIndex].aabb))
+		{
+			outObjects.push_back(mSpatialEntries[entryIndex].object);
+		}
+	}
+}
+
 void Scene::Interact(const Ray& ray, GKObject* interactHint)
 {
 	// Ignore scene interaction while the action bar is showing.
@@ -477,7 +534,7 @@ void Scene::Interact(const Ray& ray, GKObject* interactHint)
 				if(StringUtil::EqualsIgnoreCase(hitInfo.name, mSceneData->GetFloorModelName()))
 				{
 					// Check walker boundary to see whether we can walk to this spot.
-					mEgo->WalkTo(ray.GetPoint(hitInfo.t), mSceneData->GetWalkerBoundary(), nullptr);
+					mEgo->WalkTo(hitInfo.point, mSceneData->GetWalkerBoundary(), nullptr);
 				}
 			}
 		}
@@ -715,3 +772,67 @@ void Scene::ExecuteAction(const Action* action)
 		}
 	}
 }
+
+void Scene::BuildSpatialIndex()
+{
+	mSpatialTree.Clear();
+	mSpatialEntries.clear();
+	mBSPActorsByObjectIndex.clear();
+	
+	// Actors and props get bounds from their models, which are filled in on the first update.
+	for(auto& object : mObjects)
+	{
+		SpatialEntry entry;
+		entry.object = object;
+		entry.meshRenderer = object->GetMeshRenderer();
+		mSpatialEntries.push_back(entry);
+	}
+	
+	// BSP actors never move, so they go in the tree right away.
+	for(auto& bspActor : mBSPActors)
+	{
+		if(bspActor == nullptr) { continue; }
+		
+		SpatialEntry entry;
+		entry.object = bspActor;
+		entry.aabb = bspActor->GetAABB();
+		entry.proxyId = mSpatialTree.Insert(entry.aabb, static_cast<int>(mSpatialEntries.size()));
+		mSpatialEntries.push_back(entry);
+		
+		int objectIndex = bspActor->GetObjectIndex();
+		if(objectIndex >= mBSPActorsByObjectIndex.size())
+		{
+			mBSPActorsByObjectIndex.resize(objectIndex + 1, nullptr);
+		}
+		mBSPActorsByObjectIndex[objectIndex] = bspActor;
+	}
+	UpdateSpatialIndex();
+}
+
+void Scene::UpdateSpatialIndex() const
+{
+	for(int i = 0; i < mSpatialEntries.size(); ++i)
+	{
+		SpatialEntry& entry = mSpatialEntries[i];
+		if(entry.meshRenderer == nullptr) { continue; }
+		
+		// Mesh renderer caches its world bounds, only recalculating when the transform or a mesh moves.
+		// The tree only changes if the object moved outside its fat bounds.
+		if(entry.meshRenderer->GetWorldAABB(entry.aabb))
+		{
+			if(entry.proxyId < 0)
+			{
+				entry.proxyId = mSpatialTree.Insert(entry.aabb, i);
+			}
+			else
+			{
+				mSpatialTree.Update(entry.proxyId, entry.aabb);
+			}
+		}
+		else if(entry.proxyId >= 0)
+		{
+			mSpatialTree.Remove(entry.proxyId);
+			entry.proxyId = -1;
+		}
+	}
+}
@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 
+#include "AABBTree.h"
 #include "Collisions.h"
 #include "SceneData.h"
 #include "Timeblock.h"
@@ -28,11 +29,13 @@ class BSPActor;
 class GameCamera;
 class GKActor;
 class GKObject;
+class MeshRenderer;
 class Ray;
 struct SceneModel;
 class SIF;
 class Skybox;
 class SoundtrackPlayer;
+class Sphere;
 class Vector3;
 
 struct SceneCastResult
@@ -56,6 +59,10 @@ public:
 	
 	SceneCastResult Raycast(const Ray& ray, bool interactiveOnly, const GKObject* ignore = nullptr) const;
 	
+	// Finds objects (actors, props, and BSP objects) whose bounds touch the box or sphere.
+	void GetObjectsInAABB(const AABB& aabb, std::vector<GKObject*>& outObjects) const;
+	void GetObjectsInSphere(const Sphere& sphere, std::vector<GKObject*>& outObjects) const;
+	
     void Interact(const Ray& ray, GKObject* interactHint = nullptr);
 	
 	float GetFloorY(const Vector3& position) const;
@@ -67,6 +74,7 @@ public:
 	GKActor* GetActorByNoun(const std::string& noun) const;
 	
 	const ScenePosition* GetPosition(const std::string& positionName) const;
+	WalkerBoundary* GetWalkerBoundary() const { return mSceneData != nullptr ? mSceneData->GetWalkerBoundary() : nullptr; }
 	
 	void ApplyTextureToSceneModel(const std::string& modelName, Texture* texture);
 	void SetSceneModelVisibility(const std::string& modelName, bool visible);
@@ -109,12 +117,34 @@ private:
 	// Actors in the BSP.
 	std::vector<BSPActor*> mBSPActors;
 	
+	// BSP actors indexed by BSP object index, to find which actor a BSP raycast hit.
+	std::vector<BSPActor*> mBSPActorsByObjectIndex;
+	
+	// Spatial index over all objects and BSP actors, so raycasts and proximity queries only check nearby objects.
+	// Objects move without telling the scene, so entries are refreshed before each query (cheap if nothing moved).
+	struct SpatialEntry
+	{
+		GKObject* object = nullptr;
+		
+		// Only actors/props have one. BSP actors don't move, and are raycast as part of the BSP.
+		MeshRenderer* meshRenderer = nullptr;
+		
+		// World bounds, and proxy in the tree. Proxy is -1 if the object has no bounds (no model).
+		AABB aabb;
+		int proxyId = -1;
+	};
+	mutable std::vector<SpatialEntry> mSpatialEntries;
+	mutable AABBTree mSpatialTree;
+	
     // The name of actor and actor who we are controlling in the scene.
 	// We sometimes need just the name - that's safer during scene loading.
 	std::string mEgoName;
     GKActor* mEgo = nullptr;
 	
 	void ExecuteAction(const Action* action);
+	
+	void BuildSpatialIndex();
+	void UpdateSpatialIndex() const;
 };
 
 /*
@@ -83,6 +83,13 @@ void SceneData::ResolveSceneData()
 		mWalkerBoundary->SetTexture(Services::GetAssets()->LoadTexture(mGeneralSettings.walkerBoundaryTextureName));
 		mWalkerBoundary->SetSize(mGeneralSettings.walkerBoundarySize);
 		mWalkerBoundary->SetOffset(mGeneralSettings.walkerBoundaryOffset);
+		
+		// Walker boundary keeps its own copy of the walk data, so the texture is only needed to visualize it.
+		if(!WalkerBoundary::sKeepTextureForDebug)
+		{
+			mWalkerBoundary->ReleaseTexture();
+			Services::GetAssets()->UnloadTexture(mGeneralSettings.walkerBoundaryTextureName);
+		}
 	}
 	
 	// Build list of actors to use in the scene based on contents of the two SIFs.
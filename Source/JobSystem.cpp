@@ -0,0 +1,266 @@
+//
+// JobSystem.cpp
+//
+// Clark Kromenaker
+//
+#include "JobSystem.h"
+
+TYPE_DEF_BASE(JobSystem);
+
+namespace
+{
+	// Which queue belongs to the current thread. Threads that aren't workers use the main thread's queue.
+	thread_local int tQueueIndex = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Init(int workerCount)
+{
+	if(!mWorkers.empty()) { return; }
+
+	// Leave a core for the main thread. Always have at least one worker, so queued jobs run even if nobody waits on them.
+	if(workerCount <= 0)
+	{
+		workerCount = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+		if(workerCount < 1) { workerCount = 1; }
+	}
+
+	mMainThreadId = std::this_thread::get_id();
+	tQueueIndex = 0;
+	mStopping = false;
+	for(int i = 0; i <= workerCount; ++i)
+	{
+		mQueues.emplace_back(new JobQueue());
+	}
+	for(int i = 1; i <= workerCount; ++i)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	if(mWorkers.empty()) { return; }
+
+	// Tell workers to stop, and wait for them to do so.
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mStopping = true;
+	}
+	mWakeCondition.notify_all();
+	for(auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+	mQueues.clear();
+	mMainThreadJobs.clear();
+	mWaitingJobs.clear();
+	mQueuedJobCount = 0;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobCounter* dependency, JobAffinity affinity)
+{
+	Job job;
+	job.function = std::move(function);
+	job.counter = counter;
+	job.dependency = dependency;
+	job.affinity = affinity;
+	if(counter != nullptr)
+	{
+		++counter->mCount;
+	}
+
+	// Hold off on jobs whose dependency isn't done yet.
+	// Checking under the lock means the dependency can't finish between the check and the job being added to the waiting list.
+	if(dependency != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(mWaitingMutex);
+		if(!dependency->IsDone())
+		{
+			mWaitingJobs.push_back(std::move(job));
+			return;
+		}
+	}
+	Schedule(std::move(job));
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	bool mainThread = IsMainThread();
+	while(!counter.IsDone())
+	{
+		// Help out while waiting. Main thread jobs may be what we're waiting on, so the main thread runs those too.
+		if(TryRunJob(tQueueIndex)) { continue; }
+		if(mainThread && TryRunMainThreadJob()) { continue; }
+
+		// Nothing to do - the last jobs must be running on other threads.
+		std::this_thread::yield();
+	}
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+	// Only run jobs queued so far. Jobs queued by these jobs wait until next time, so this can't go on forever.
+	size_t jobCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(mMainThreadMutex);
+		jobCount = mMainThreadJobs.size();
+	}
+	for(size_t i = 0; i < jobCount; ++i)
+	{
+		if(!TryRunMainThreadJob()) { break; }
+	}
+}
+
+void JobSystem::ParallelFor(int count, int batchSize, const std::function<void(int start, int end)>& function)
+{
+	if(count <= 0) { return; }
+	if(batchSize < 1) { batchSize = 1; }
+
+	// Not worth queuing jobs for a single batch (or if there are no workers).
+	if(count <= batchSize || mWorkers.empty())
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for(int start = 0; start < count; start += batchSize)
+	{
+		int end = start + batchSize < count ? start + batchSize : count;
+		Run([&function, start, end]() { function(start, end); }, &counter);
+	}
+	Wait(counter);
+}
+
+void JobSystem::WorkerLoop(int queueIndex)
+{
+	tQueueIndex = queueIndex;
+	while(true)
+	{
+		if(TryRunJob(queueIndex)) { continue; }
+
+		// Sleep until there's something to do.
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWakeCondition.wait(lock, [this]() { return mStopping || mQueuedJobCount > 0; });
+		if(mStopping) { break; }
+	}
+}
+
+void JobSystem::Schedule(Job&& job)
+{
+	if(job.affinity == JobAffinity::MainThread)
+	{
+		std::lock_guard<std::mutex> lock(mMainThreadMutex);
+		mMainThreadJobs.push_back(std::move(job));
+		return;
+	}
+
+	// If the job system isn't running, there's nobody else to do it.
+	if(mQueues.empty())
+	{
+		Execute(job);
+		return;
+	}
+
+	// Put in this thread's queue, since this thread will likely get to it soonest.
+	{
+		JobQueue& queue = *mQueues[tQueueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+
+	// Wake a worker to run it (or steal something else). Taking the wake lock makes sure a worker
+	// that's about to sleep sees the new count first, rather than sleeping through this notify.
+	++mQueuedJobCount;
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+	}
+	mWakeCondition.notify_one();
+}
+
+bool JobSystem::TryRunJob(int queueIndex)
+{
+	if(mQueues.empty() || mQueuedJobCount == 0) { return false; }
+
+	// Newest job from own queue first, then oldest job from each other queue.
+	Job job;
+	bool found = false;
+	int queueCount = static_cast<int>(mQueues.size());
+	for(int i = 0; i < queueCount && !found; ++i)
+	{
+		JobQueue& queue = *mQueues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.jobs.empty()) { continue; }
+
+		if(i == 0)
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+		found = true;
+	}
+	if(!found) { return false; }
+
+	--mQueuedJobCount;
+	Execute(job);
+	return true;
+}
+
+bool JobSystem::TryRunMainThreadJob()
+{
+	Job job;
+	{
+		std::lock_guard<std::mutex> lock(mMainThreadMutex);
+		if(mMainThreadJobs.empty()) { return false; }
+		job = std::move(mMainThreadJobs.front());
+		mMainThreadJobs.pop_front();
+	}
+	Execute(job);
+	return true;
+}
+
+void JobSystem::Execute(Job& job)
+{
+	job.function();
+
+	// If this was the last job on the counter, anything depending on it can start.
+	if(job.counter != nullptr && --job.counter->mCount == 0)
+	{
+		ReleaseWaitingJobs();
+	}
+}
+
+void JobSystem::ReleaseWaitingJobs()
+{
+	std::vector<Job> readyJobs;
+	{
+		std::lock_guard<std::mutex> lock(mWaitingMutex);
+		for(auto it = mWaitingJobs.begin(); it != mWaitingJobs.end();)
+		{
+			if(it->dependency->IsDone())
+			{
+				readyJobs.push_back(std::move(*it));
+				it = mWaitingJobs.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	for(auto& job : readyJobs)
+	{
+		Schedule(std::move(job));
+	}
+}
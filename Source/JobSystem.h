@@ -0,0 +1,117 @@
+//
+// JobSystem.h
+//
+// Clark Kromenaker
+//
+// Runs small pieces of work ("jobs") spread across all CPU cores.
+//
+// Each thread has its own queue of jobs. A thread takes the newest job from its own queue
+// (likely still in cache), and when that runs dry, steals the oldest job from another thread's queue.
+//
+// Counters track when a group of jobs is done, and a job can wait on a counter before starting.
+// Jobs that must run on the main thread (e.g. anything touching OpenGL) can be queued for it too.
+//
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Type.h"
+
+// Counts jobs that haven't finished yet. Zero means all are done.
+class JobCounter
+{
+public:
+	bool IsDone() const { return mCount.load() == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<int> mCount { 0 };
+};
+
+enum class JobAffinity
+{
+	Any,		// Runs on any thread.
+	MainThread	// Only runs on the main thread (during RunMainThreadJobs, or while the main thread waits).
+};
+
+class JobSystem
+{
+	TYPE_DECL_BASE();
+public:
+	~JobSystem();
+
+	// Starts worker threads - by default, one for each core other than the main thread's.
+	// The thread calling Init is considered the main thread.
+	void Init(int workerCount = 0);
+
+	// Stops worker threads. Any jobs not started yet are dropped.
+	void Shutdown();
+
+	// Queues a job.
+	// If a counter is given, it goes up by one now, and down by one when the job finishes.
+	// If a dependency is given, the job doesn't start until that counter reaches zero.
+	void Run(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr,
+			 JobAffinity affinity = JobAffinity::Any);
+
+	// Waits for a counter to reach zero. Rather than sleeping, the calling thread runs jobs while it waits.
+	void Wait(const JobCounter& counter);
+
+	// Runs main thread jobs queued so far. Call once per frame, on the main thread.
+	void RunMainThreadJobs();
+
+	// Calls the function for ranges [start, end) covering [0, count), spread across all threads.
+	// Ranges are batchSize long (except maybe the last). Returns once all ranges are done.
+	void ParallelFor(int count, int batchSize, const std::function<void(int start, int end)>& function);
+
+	// Number of threads running jobs, including the main thread.
+	int GetThreadCount() const { return static_cast<int>(mQueues.size()); }
+	bool IsMainThread() const { return std::this_thread::get_id() == mMainThreadId; }
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+		JobCounter* dependency = nullptr;
+		JobAffinity affinity = JobAffinity::Any;
+	};
+
+	// One queue per thread. The owner pushes/pops at the back, thieves take from the front.
+	// Queue 0 is the main thread's (and is also used by threads that aren't part of the job system).
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+	std::vector<std::unique_ptr<JobQueue>> mQueues;
+	std::vector<std::thread> mWorkers;
+	std::thread::id mMainThreadId;
+
+	// Jobs only the main thread may run.
+	std::mutex mMainThreadMutex;
+	std::deque<Job> mMainThreadJobs;
+
+	// Jobs waiting for a dependency to finish. Checked whenever a counter reaches zero.
+	std::mutex mWaitingMutex;
+	std::vector<Job> mWaitingJobs;
+
+	// Idle workers sleep until jobs are queued (or it's time to stop).
+	std::mutex mWakeMutex;
+	std::condition_variable mWakeCondition;
+	std::atomic<int> mQueuedJobCount { 0 };
+	bool mStopping = false;
+
+	void WorkerLoop(int queueIndex);
+
+	void Schedule(Job&& job);
+	bool TryRunJob(int queueIndex);
+	bool TryRunMainThreadJob();
+	void Execute(Job& job);
+	void ReleaseWaitingJobs();
+};
@@ -0,0 +1,116 @@
+//
+// DistanceTransform.cpp
+//
+// Clark Kromenaker
+//
+#include "DistanceTransform.h"
+
+#include <limits>
+
+namespace
+{
+	const float kInfinity = std::numeric_limits<float>::infinity();
+	
+	// 1D squared distance transform of the sampled function "f" (n samples, "stride" apart in memory).
+	// Each sample is a parabola rooted at (q, f[q]); the transform is the lower envelope of those parabolas.
+	// Outputs the minimum value at each sample, and which sample's parabola gave that value.
+	// Samples with infinite f are skipped entirely, so they can never be chosen.
+	void Transform1D(const float* f, int n, int stride, float* outDistances, int* outSites, int outStride,
+					 std::vector<int>& v, std::vector<float>& z)
+	{
+		// v holds the sites (sample positions) of parabolas in the lower envelope.
+		// z holds the boundaries between them: parabola v[k] is lowest in range [z[k], z[k + 1]].
+		int k = -1;
+		for(int q = 0; q < n; ++q)
+		{
+			float fq = f[q * stride];
+			if(fq == kInfinity) { continue; }
+			
+			// Find where this parabola intersects the rightmost parabola in the envelope.
+			// If that's left of where that parabola begins, it is completely hidden - remove it and try again.
+			float s = 0.0f;
+			while(k >= 0)
+			{
+				int p = v[k];
+				float fp = f[p * stride];
+				s = ((fq + q * q) - (fp + p * p)) / (2.0f * (q - p));
+				if(s > z[k]) { break; }
+				--k;
+			}
+			
+			// Add this parabola to the envelope.
+			++k;
+			v[k] = q;
+			z[k] = (k == 0) ? -kInfinity : s;
+			z[k + 1] = kInfinity;
+		}
+		
+		// No sites at all? Everything is infinitely far away.
+		if(k < 0)
+		{
+			for(int q = 0; q < n; ++q)
+			{
+				outDistances[q * outStride] = kInfinity;
+				outSites[q * outStride] = -1;
+			}
+			return;
+		}
+		
+		// Read off the envelope to get minimum value at each sample.
+		k = 0;
+		for(int q = 0; q < n; ++q)
+		{
+			while(z[k + 1] < q) { ++k; }
+			int p = v[k];
+			outDistances[q * outStride] = (q - p) * (q - p) + f[p * stride];
+			outSites[q * outStride] = p;
+		}
+	}
+}
+
+void DistanceTransform::NearestFeature(const unsigned char* isFeature, int width, int height, std::vector<int>& outNearest)
+{
+	int cellCount = width * height;
+	outNearest.assign(cellCount, -1);
+	if(cellCount <= 0) { return; }
+	
+	// Scratch space for envelope and per-pass results.
+	int maxDimension = width > height ? width : height;
+	std::vector<int> v(maxDimension);
+	std::vector<float> z(maxDimension + 1);
+	std::vector<float> f(cellCount);
+	std::vector<float> columnDistances(cellCount);
+	std::vector<int> columnSites(cellCount);
+	
+	// Features are at distance zero, everything else starts infinitely far away.
+	for(int i = 0; i < cellCount; ++i)
+	{
+		f[i] = isFeature[i] != 0 ? 0.0f : kInfinity;
+	}
+	
+	// Pass 1: for each column, find the nearest feature row in that column.
+	for(int x = 0; x < width; ++x)
+	{
+		Transform1D(&f[x], height, width, &columnDistances[x], &columnSites[x], width, v, z);
+	}
+	
+	// Pass 2: for each row, find which column's nearest feature is nearest overall.
+	// The result of pass 1 is the "height" of each column's parabola.
+	std::vector<float> rowDistances(width);
+	std::vector<int> rowSites(width);
+	for(int y = 0; y < height; ++y)
+	{
+		int rowStart = y * width;
+		Transform1D(&columnDistances[rowStart], width, 1, rowDistances.data(), rowSites.data(), 1, v, z);
+		
+		// Combine the two passes: the nearest feature is in column "siteX", at the row found for that column in pass 1.
+		for(int x = 0; x < width; ++x)
+		{
+			int siteX = rowSites[x];
+			if(siteX >= 0)
+			{
+				outNearest[rowStart + x] = columnSites[rowStart + siteX] * width + siteX;
+			}
+		}
+	}
+}
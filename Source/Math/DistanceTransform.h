@@ -0,0 +1,21 @@
+//
+// DistanceTransform.h
+//
+// Clark Kromenaker
+//
+// Euclidean distance transforms on 2D grids.
+//
+// Given a grid where some cells are "features," a distance transform finds, for every
+// cell in the grid, the nearest feature cell. Useful for answering "what's the closest
+// X to this spot" in constant time after a one-time linear cost.
+//
+#pragma once
+#include <vector>
+
+namespace DistanceTransform
+{
+	// For each cell of a (width x height) grid, finds the index (y * width + x) of the nearest feature cell.
+	// A cell is a feature if "isFeature" is non-zero at its index. If there are no features, all cells get -1.
+	// Uses the two-pass (columns, then rows) lower envelope algorithm from Felzenszwalb & Huttenlocher - O(width * height).
+	void NearestFeature(const unsigned char* isFeature, int width, int height, std::vector<int>& outNearest);
+}
@@ -21,6 +21,9 @@ namespace Math
     static const float kPiOver2 = kPi / 2.0f;
     static const float kPiOver4 = kPi / 4.0f;
     
+    // Square root of 2 - the length of a unit square's diagonal.
+    static const float kSqrt2 = 1.4142135623730950488016887242097f;
+    
     inline float Sqrt(float val)
     {
         return std::sqrtf(val);
@@ -156,6 +159,11 @@ namespace Math
     }
     
     inline float Abs(float val)
+    {
+        return std::abs(val);
+    }
+    
+    inline int Abs(int val)
     {
         return std::abs(val);
     }
@@ -9,6 +9,89 @@
 #include <cstring>
 
 #include "Matrix3.h"
+#include "SIMD.h"
+
+#if defined(SIMD_SSE) || defined(SIMD_NEON)
+namespace
+{
+    // A few 4-wide float operations, so the SIMD matrix math below is written once for both SSE and NEON.
+    // Loads/stores are unaligned: matrix storage is aligned, but Vector4/Quaternion and heap copies may not be.
+    #if defined(SIMD_SSE)
+    typedef __m128 Float4;
+    inline Float4 Load(const float* p) { return _mm_loadu_ps(p); }
+    inline void Store(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+    inline Float4 Splat(float f) { return _mm_set1_ps(f); }
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(a, _mm_mul_ps(b, c)); }
+    
+    // Returns (y, z, x, w).
+    inline Float4 ShuffleYZX(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+    
+    inline float Dot3(Float4 a, Float4 b)
+    {
+        Float4 m = _mm_mul_ps(a, b);
+        Float4 sum = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_cvtss_f32(sum);
+    }
+    
+    inline void Transpose4(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+    {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    }
+    #elif defined(SIMD_NEON)
+    typedef float32x4_t Float4;
+    inline Float4 Load(const float* p) { return vld1q_f32(p); }
+    inline void Store(float* p, Float4 v) { vst1q_f32(p, v); }
+    inline Float4 Splat(float f) { return vdupq_n_f32(f); }
+    inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(a, b, c); }
+    
+    // Returns (y, z, x, x) - the last lane isn't used by any 3D math below.
+    inline Float4 ShuffleYZX(Float4 v)
+    {
+        float32x2_t xy = vget_low_f32(v);
+        return vcombine_f32(vext_f32(xy, vget_high_f32(v), 1), vdup_lane_f32(xy, 0));
+    }
+    
+    inline float Dot3(Float4 a, Float4 b)
+    {
+        Float4 m = vmulq_f32(a, b);
+        return vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1) + vgetq_lane_f32(m, 2);
+    }
+    
+    inline void Transpose4(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+    {
+        float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+    #endif
+    
+    // Cross product of the xyz parts. The w lane of the result is garbage.
+    inline Float4 Cross3(Float4 a, Float4 b)
+    {
+        Float4 c = Sub(Mul(a, ShuffleYZX(b)), Mul(ShuffleYZX(a), b));
+        return ShuffleYZX(c);
+    }
+    
+    // Sum of the matrix's columns, each scaled by one component of the vector (i.e. matrix * column vector).
+    inline Float4 MultiplyColumns(const float* matrix, float x, float y, float z, float w)
+    {
+        Float4 result = Mul(Load(matrix), Splat(x));
+        result = MulAdd(result, Load(matrix + 4), Splat(y));
+        result = MulAdd(result, Load(matrix + 8), Splat(z));
+        return MulAdd(result, Load(matrix + 12), Splat(w));
+    }
+}
+#endif
 
 Matrix4 Matrix4::Zero(0.0f, 0.0f, 0.0f, 0.0f,
                       0.0f, 0.0f, 0.0f, 0.0f,
@@ -229,6 +312,13 @@ Matrix4 Matrix4::operator-() const
 Matrix4 Matrix4::operator*(const Matrix4& rhs) const
 {
     Matrix4 result;
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    // Each result column is this matrix times the matching rhs column.
+    for(int col = 0; col < 16; col += 4)
+    {
+        Store(&result.mVals[col], MultiplyColumns(mVals, rhs.mVals[col], rhs.mVals[col + 1], rhs.mVals[col + 2], rhs.mVals[col + 3]));
+    }
+    #else
     // Column one
     result.mVals[0] = mVals[0] * rhs.mVals[0] + mVals[4] * rhs.mVals[1] + mVals[8] * rhs.mVals[2] + mVals[12] * rhs.mVals[3];
     result.mVals[1] = mVals[1] * rhs.mVals[0] + mVals[5] * rhs.mVals[1] + mVals[9] * rhs.mVals[2] + mVals[13] * rhs.mVals[3];
@@ -252,25 +342,28 @@ Matrix4 Matrix4::operator*(const Matrix4& rhs) const
     result.mVals[13] = mVals[1] * rhs.mVals[12] + mVals[5] * rhs.mVals[13] + mVals[9] * rhs.mVals[14] + mVals[13] * rhs.mVals[15];
     result.mVals[14] = mVals[2] * rhs.mVals[12] + mVals[6] * rhs.mVals[13] + mVals[10] * rhs.mVals[14] + mVals[14] * rhs.mVals[15];
     result.mVals[15] = mVals[3] * rhs.mVals[12] + mVals[7] * rhs.mVals[13] + mVals[11] * rhs.mVals[14] + mVals[15] * rhs.mVals[15];
+    #endif
     return result;
 }
 
 Matrix4& Matrix4::operator*=(const Matrix4& rhs)
 {
-    Matrix4 result = *this * rhs;
-    for(int i = 0; i < 16; i++)
-    {
-        mVals[i] = result.mVals[i];
-    }
+    *this = *this * rhs;
     return *this;
 }
 
 Vector4 Matrix4::operator*(const Vector4& rhs) const
 {
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    Vector4 result;
+    Store(&result.x, MultiplyColumns(mVals, rhs.x, rhs.y, rhs.z, rhs.w));
+    return result;
+    #else
     return Vector4(mVals[0] * rhs[0] + mVals[4] * rhs[1] + mVals[8]  * rhs[2] + mVals[12] * rhs[3],
                    mVals[1] * rhs[0] + mVals[5] * rhs[1] + mVals[9]  * rhs[2] + mVals[13] * rhs[3],
                    mVals[2] * rhs[0] + mVals[6] * rhs[1] + mVals[10] * rhs[2] + mVals[14] * rhs[3],
                    mVals[3] * rhs[0] + mVals[7] * rhs[1] + mVals[11] * rhs[2] + mVals[15] * rhs[3]);
+    #endif
 }
 
 Vector4 operator*(const Vector4& lhs, const Matrix4& rhs)
@@ -360,7 +453,53 @@ void Matrix4::Invert()
     // We can split our 4x4 matrix into 4 3D column vectors and 1 4D row vector.
     // From there, those vectors can be used to calculate determinant and cofactor matrix fairly efficiently.
     // Then, we can use "inverse = adjugate matrix divided by determinant" method.
-
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    // Same math as below, but with each 3D vector in a SIMD register.
+    Float4 col0 = Load(&mVals[0]);
+    Float4 col1 = Load(&mVals[4]);
+    Float4 col2 = Load(&mVals[8]);
+    Float4 col3 = Load(&mVals[12]);
+    Float4 x = Splat(mVals[3]);
+    Float4 y = Splat(mVals[7]);
+    Float4 z = Splat(mVals[11]);
+    Float4 w = Splat(mVals[15]);
+    
+    Float4 s = Cross3(col0, col1);
+    Float4 t = Cross3(col2, col3);
+    Float4 u = Sub(Mul(col0, y), Mul(col1, x));
+    Float4 v = Sub(Mul(col2, w), Mul(col3, z));
+    
+    float determinant = Dot3(s, v) + Dot3(t, u);
+    if(Math::IsZero(determinant))
+    {
+        return;
+    }
+    Float4 invDet = Splat(1.0f / determinant);
+    s = Mul(s, invDet);
+    t = Mul(t, invDet);
+    u = Mul(u, invDet);
+    v = Mul(v, invDet);
+    
+    Float4 row0 = MulAdd(Cross3(col1, v), t, y);
+    Float4 row1 = Sub(Cross3(v, col0), Mul(t, x));
+    Float4 row2 = MulAdd(Cross3(col3, u), s, w);
+    Float4 row3 = Sub(Cross3(u, col2), Mul(s, z));
+    
+    float colX = -Dot3(col1, t);
+    float colY =  Dot3(col0, t);
+    float colZ = -Dot3(col3, s);
+    float colW =  Dot3(col2, s);
+    
+    // Rows to columns - the fourth "column" this produces is garbage, and is overwritten by the right column.
+    Transpose4(row0, row1, row2, row3);
+    Store(&mVals[0], row0);
+    Store(&mVals[4], row1);
+    Store(&mVals[8], row2);
+    mVals[12] = colX;
+    mVals[13] = colY;
+    mVals[14] = colZ;
+    mVals[15] = colW;
+    #else
     // Grab 4 3D column vectors from the matrix.
     // matrix[x] returns reference to 4D column vector, but we only need first 3 values, so reinterpret to get that.
     const Vector3& col0 = reinterpret_cast<const Vector3&>((*this)[0]);
@@ -431,6 +570,7 @@ void Matrix4::Invert()
     mVals[13] = colY;
     mVals[14] = colZ;
     mVals[15] = colW;
+    #endif
 }
 
 /*static*/ Matrix4 Matrix4::Inverse(const Matrix4& matrix)
@@ -472,17 +612,29 @@ Quaternion Matrix4::GetRotation() const
 Vector3 Matrix4::TransformVector(const Vector3& vector) const
 {
     // Assume Vector3 is not a point, so w = 0.
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    float result[4];
+    Store(result, MultiplyColumns(mVals, vector.x, vector.y, vector.z, 0.0f));
+    return Vector3(result[0], result[1], result[2]);
+    #else
     return Vector3(mVals[0] * vector[0] + mVals[4] * vector[1] + mVals[8]  * vector[2],
                    mVals[1] * vector[0] + mVals[5] * vector[1] + mVals[9]  * vector[2],
                    mVals[2] * vector[0] + mVals[6] * vector[1] + mVals[10] * vector[2]);
+    #endif
 }
 
 Vector3 Matrix4::TransformPoint(const Vector3& point) const
 {
     // Assume Vector3 is a point, so w = 1.
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    float result[4];
+    Store(result, MultiplyColumns(mVals, point.x, point.y, point.z, 1.0f));
+    return Vector3(result[0], result[1], result[2]);
+    #else
     return Vector3(mVals[0] * point[0] + mVals[4] * point[1] + mVals[8]  * point[2] + mVals[12],
                    mVals[1] * point[0] + mVals[5] * point[1] + mVals[9]  * point[2] + mVals[13],
                    mVals[2] * point[0] + mVals[6] * point[1] + mVals[10] * point[2] + mVals[14]);
+    #endif
 }
 
 void Matrix4::InvertTransform()
@@ -491,7 +643,38 @@ void Matrix4::InvertTransform()
     // When a matrix is a transform, the inverse math can be optimized.
     // A transform matrix's fourth row is always (0, 0, 0, 1).
     // See normal Inverse function for more in-depth explanation.
-    
+    #if defined(SIMD_SSE) || defined(SIMD_NEON)
+    Float4 col0 = Load(&mVals[0]);
+    Float4 col1 = Load(&mVals[4]);
+    Float4 col2 = Load(&mVals[8]);
+    Float4 col3 = Load(&mVals[12]);
+    
+    Float4 s = Cross3(col0, col1);
+    Float4 t = Cross3(col2, col3);
+    Float4 invDet = Splat(1.0f / Dot3(s, col2));
+    s = Mul(s, invDet);
+    t = Mul(t, invDet);
+    Float4 v = Mul(col2, invDet);
+    
+    Float4 row0 = Cross3(col1, v);
+    Float4 row1 = Cross3(v, col0);
+    Float4 row2 = s;
+    Float4 row3 = Splat(0.0f);
+    
+    float colX = -Dot3(col1, t);
+    float colY =  Dot3(col0, t);
+    float colZ = -Dot3(col3, s);
+    
+    // Fourth row is all zero, so the columns' w values come out as zero too.
+    Transpose4(row0, row1, row2, row3);
+    Store(&mVals[0], row0);
+    Store(&mVals[4], row1);
+    Store(&mVals[8], row2);
+    mVals[12] = colX;
+    mVals[13] = colY;
+    mVals[14] = colZ;
+    mVals[15] = 1.0f;
+    #else
     // Grab 4 3D column vectors from the matrix.
     const Vector3& col0 = reinterpret_cast<const Vector3&>((*this)[0]);
     const Vector3& col1 = reinterpret_cast<const Vector3&>((*this)[1]);
@@ -540,6 +723,7 @@ void Matrix4::InvertTransform()
     mVals[13] = colY;
     mVals[14] = colZ;
     mVals[15] = 1.0f;
+    #endif
 }
 
 /*static*/ Matrix4 Matrix4::InverseTransform(const Matrix4& matrix)
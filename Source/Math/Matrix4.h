@@ -131,7 +131,8 @@ private:
     // | 01 05 09 13 |
     // | 02 06 10 14 |
     // | 03 07 11 15 |
-    float mVals[16];
+    // Aligned to 16 bytes so each column lines up with a SIMD register.
+    alignas(16) float mVals[16];
 };
 
 std::ostream& operator<<(std::ostream& os, const Matrix4& v);
@@ -6,6 +6,7 @@
 #include "Quaternion.h"
 
 #include "Matrix3.h"
+#include "SIMD.h"
 #include "Vector3.h"
 
 Quaternion Quaternion::Zero(0.0f, 0.0f, 0.0f, 0.0f);
@@ -474,8 +475,9 @@ Vector3 Quaternion::Rotate(const Vector3& vector) const
         // If angle is greater than zero, use standard slerp.
         if((1.0f - cosTheta) > Math::kEpsilon)
         {
+            // sin(acos(x)) == sqrt(1 - x^2), which saves a trig call.
             float theta = Math::Acos(cosTheta);
-            float recipSinTheta = 1.0f / Math::Sin(theta);
+            float recipSinTheta = 1.0f / Math::Sqrt(1.0f - cosTheta * cosTheta);
             
             startInterp = Math::Sin((1.0f - t) * theta) * recipSinTheta;
             endInterp = Math::Sin(t * theta) * recipSinTheta;
@@ -495,7 +497,7 @@ Vector3 Quaternion::Rotate(const Vector3& vector) const
         {
             // ...use slerp w/ negation of start quaternion.
             float theta = Math::Acos(-cosTheta);
-            float recipSinTheta = 1.0f / Math::Sin(theta);
+            float recipSinTheta = 1.0f / Math::Sqrt(1.0f - cosTheta * cosTheta);
             
             startInterp = Math::Sin((t - 1.0f) * theta) * recipSinTheta;
             endInterp = Math::Sin(t * theta) * recipSinTheta;
@@ -507,7 +509,20 @@ Vector3 Quaternion::Rotate(const Vector3& vector) const
             endInterp = t;
         }
     }
+    
+    // Quaternion components are contiguous, so the blend can be done 4-wide.
+    // Both inputs are loaded before storing, so result can be the same object as start or end.
+    #if defined(SIMD_SSE)
+    __m128 blend = _mm_mul_ps(_mm_loadu_ps(&start.x), _mm_set1_ps(startInterp));
+    blend = _mm_add_ps(blend, _mm_mul_ps(_mm_loadu_ps(&end.x), _mm_set1_ps(endInterp)));
+    _mm_storeu_ps(&result.x, blend);
+    #elif defined(SIMD_NEON)
+    float32x4_t blend = vmulq_n_f32(vld1q_f32(&start.x), startInterp);
+    blend = vmlaq_n_f32(blend, vld1q_f32(&end.x), endInterp);
+    vst1q_f32(&result.x, blend);
+    #else
     result = startInterp * start + endInterp * end;
+    #endif
 }
 
 std::ostream& operator<<(std::ostream& os, const Quaternion& q)
@@ -0,0 +1,21 @@
+//
+// SIMD.h
+//
+// Clark Kromenaker
+//
+// Detects which SIMD instruction set (if any) is available at compile time.
+// Code with SIMD paths checks these defines and must always provide a scalar fallback.
+//
+// Define NO_SIMD to force scalar code paths everywhere (handy for debugging or comparing results).
+//
+#pragma once
+
+#if !defined(NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define SIMD_SSE 1
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define SIMD_NEON 1
+		#include <arm_neon.h>
+	#endif
+#endif
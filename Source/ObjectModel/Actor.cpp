@@ -37,28 +37,45 @@ Actor::~Actor()
 {
 	//NOTE: GEngine class handles calling "delete". Others should call Destroy if needed.
 	
-    // Delete all components and clear list.
+    // Destroy all components (returning them to their pools) and clear list.
     for(auto& component : mComponents)
     {
-        delete component;
+        component->GetPool()->Destroy(component);
     }
     mComponents.clear();
+	mComponentSlots.clear();
 }
 
-void Actor::Update(float deltaTime)
+void Actor::Update(float deltaTime, UpdatePhase phase, std::vector<Component*>& parallelComponents)
 {
 	if(mState == State::Active)
 	{
 		// Do my own update (subclasses can override).
-		OnUpdate(deltaTime);
+		if(phase == UpdatePhase::PreUpdate)
+		{
+			OnUpdate(deltaTime);
+		}
 		
-		// Update all components.
+		// Update components in this phase.
 		for(auto& component : mComponents)
 		{
-			component->Update(deltaTime);
+			if(component->GetUpdatePhase() != phase) { continue; }
+			if(component->IsParallelUpdate())
+			{
+				if(component->IsEnabled())
+				{
+					parallelComponents.push_back(component);
+				}
+			}
+			else if(component->IsEnabled())
+			{
+				// Not updating in parallel, so the main thread part can happen right away.
+				component->Update(deltaTime);
+				component->MainThreadUpdate();
+			}
 		}
 		
-		if(Debug::RenderActorTransformAxes())
+		if(phase == UpdatePhase::PostUpdate && Debug::RenderActorTransformAxes())
 		{
 			Debug::DrawAxes(mTransform->GetLocalToWorldMatrix());
 		}
@@ -104,6 +121,12 @@ bool Actor::IsActive() const
 	return true;
 }
 
+// Defined with Actor, since it depends on Actor. That way, Component doesn't - ComponentPool tests need Component, but not Actor.
+bool Component::IsActiveAndEnabled() const
+{
+	return mEnabled && mOwner != nullptr && mOwner->IsActive();
+}
+
 void Actor::Destroy()
 {
 	mState = State::Destroyed;
@@ -13,6 +13,7 @@
 #include "Matrix4.h"
 
 #include "Component.h"
+#include "ComponentPool.h"
 #include "InputManager.h"
 #include "Transform.h"
 #include "Services.h"
@@ -38,9 +39,12 @@ public:
 	
     virtual ~Actor();
     
-	void Update(float deltaTime);
+	// Updates the actor and its components for one phase. The actor's own OnUpdate happens in the PreUpdate phase.
+	// Components that update in parallel are skipped, but added to the list, so the caller can update them all at once.
+	void Update(float deltaTime, UpdatePhase phase, std::vector<Component*>& parallelComponents);
     
     template<class T> T* AddComponent();
+    // Main thread only: results are cached on the actor, so this isn't safe from a parallel component update.
     template<class T> T* GetComponent();
 	
 	// STATE
@@ -92,28 +96,62 @@ private:
 	// Transform is accessed pretty often, so seems good to cache it.
 	Transform* mTransform = nullptr;
 	
-    // The components that are attached to this actor.
+    // The components that are attached to this actor, in the order they were added.
+    // Components themselves live in per-class pools (see ComponentPool).
     std::vector<Component*> mComponents;
 	
+	// Results of GetComponent, indexed by Component::GetTypeIndex, so each class only needs to be searched for once.
+	struct ComponentSlot
+	{
+		Component* component = nullptr;
+		bool found = false;	// If false, this class hasn't been searched for yet (or should be searched for again).
+	};
+	std::vector<ComponentSlot> mComponentSlots;
+	
 	void AddChild(Actor* child);
 	void RemoveChild(Actor* child);
 };
 
 template<class T> T* Actor::AddComponent()
 {
-    T* component = new T(this);
+    T* component = ComponentPool<T>::Instance().Create(this);
     mComponents.push_back(component);
+	
+	// Searches that came up empty might find this component now.
+	for(auto& slot : mComponentSlots)
+	{
+		if(slot.component == nullptr)
+		{
+			slot.found = false;
+		}
+	}
     return component;
 }
 
 template<class T> T* Actor::GetComponent()
 {
+	// Use the result from last time, if any.
+	int typeIndex = Component::GetTypeIndex<T>();
+	if(typeIndex < mComponentSlots.size() && mComponentSlots[typeIndex].found)
+	{
+		return static_cast<T*>(mComponentSlots[typeIndex].component);
+	}
+	
+	// First time looking for this class - search for it (this also finds subclasses) and remember the result.
+	Component* result = nullptr;
     for(auto& component : mComponents)
     {
         if(component->IsTypeOf(T::GetType()))
         {
-            return static_cast<T*>(component);
+			result = component;
+			break;
         }
     }
-    return nullptr;
+	if(typeIndex >= mComponentSlots.size())
+	{
+		mComponentSlots.resize(typeIndex + 1);
+	}
+	mComponentSlots[typeIndex].component = result;
+	mComponentSlots[typeIndex].found = true;
+    return static_cast<T*>(result);
 }
@@ -5,16 +5,11 @@
 //
 #include "Component.h"
 
-#include "Actor.h"
-
 TYPE_DEF_BASE(Component);
 
+std::atomic<int> Component::sNextTypeIndex { 0 };
+
 Component::Component(Actor* owner) : mOwner(owner)
 {
     
 }
-
-bool Component::IsActiveAndEnabled() const
-{
-	return mEnabled && mOwner != nullptr && mOwner->IsActive();
-}
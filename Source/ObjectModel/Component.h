@@ -6,9 +6,21 @@
 // A component is a reusable bit of functionality that can be attached to an Actor.
 //
 #pragma once
+#include <atomic>
+
 #include "Type.h" // For homebrew RTTI.
 
 class Actor;
+class ComponentPoolBase;
+
+// Each update is split into phases. All components in one phase update before any in the next.
+enum class UpdatePhase
+{
+	PreUpdate,	// General game logic, timers, and input. Most components update here.
+	Animation,	// Sampling animations.
+	Movement,	// Moving actors around (e.g. walking).
+	PostUpdate	// Anything that follows where actors ended up (e.g. the audio listener).
+};
 
 class Component
 {
@@ -18,24 +30,62 @@ public:
 	virtual ~Component() { }
     
 	void Update(float deltaTime);
+	void MainThreadUpdate() { OnMainThreadUpdate(); }
     
     Actor* GetOwner() const { return mOwner; }
 	
+	UpdatePhase GetUpdatePhase() const { return mUpdatePhase; }
+	bool IsParallelUpdate() const { return mParallelUpdate; }
+	
+	// The pool this component lives in, and where in the pool.
+	ComponentPoolBase* GetPool() const { return mPool; }
+	int GetPoolIndex() const { return mPoolIndex; }
+	
+	// A small number for each component class, assigned on first use.
+	// Unlike Type (a hash), it can index straight into an array - actors use it to look up components by class.
+	template<class T> static int GetTypeIndex()
+	{
+		static const int typeIndex = sNextTypeIndex++;
+		return typeIndex;
+	}
+	
 	void SetEnabled(bool enabled) { mEnabled = enabled; }
 	bool IsEnabled() const { return mEnabled; }
 	
 	bool IsActiveAndEnabled() const;
     
 protected:
+	// A component that updates in parallel may update on any thread, at the same time as the same kind of component on other actors.
+	// So, OnUpdate must only change the component's own data. Transforms (which reach child transforms), shared assets (meshes, textures),
+	// and GetComponent (which caches on the actor) can all reach other actors. Anything touching those, and anything else
+	// (GL calls, starting animations, callbacks), should be saved for OnMainThreadUpdate, which is called on the main thread
+	// once all components in the phase have updated.
+	// Components that don't update in parallel get OnMainThreadUpdate right after OnUpdate.
+	void SetUpdatePhase(UpdatePhase phase, bool parallel = false) { mUpdatePhase = phase; mParallelUpdate = parallel; }
+	
 	virtual void OnUpdate(float deltaTime) { }
+	virtual void OnMainThreadUpdate() { }
 	
 private:
+	template<class T> friend class ComponentPool;
+	
+	// Next index to be assigned by GetTypeIndex. Atomic, since classes can be looked up for the first time on any thread.
+	static std::atomic<int> sNextTypeIndex;
+	
 	// The component's owner.
 	Actor* mOwner = nullptr;
 	
 	// Is the component enabled? If not, OnUpdate won't be called.
 	// Components can otherwise use this as needed - for example, a disabled UIWidget may not render.
 	bool mEnabled = true;
+	
+	// When the component updates, and whether it's safe to update in parallel with other actors.
+	UpdatePhase mUpdatePhase = UpdatePhase::PreUpdate;
+	bool mParallelUpdate = false;
+	
+	// Set by the pool that created the component.
+	ComponentPoolBase* mPool = nullptr;
+	int mPoolIndex = -1;
 };
 
 inline void Component::Update(float deltaTime)
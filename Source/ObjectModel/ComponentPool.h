@@ -0,0 +1,193 @@
+//
+// ComponentPool.h
+//
+// Clark Kromenaker
+//
+// Storage for components - one pool for each component class.
+//
+// Rather than each component being allocated on its own, components of a class are stored
+// back-to-back in fixed-size chunks. So, a system that visits every component of a class
+// (e.g. rendering every MeshRenderer) walks through memory in order, instead of all over the heap.
+//
+// Chunks never move once allocated, so pointers to components stay valid until the component is destroyed.
+//
+// Each pool holds exactly one class: a subclass of T is created in ComponentPool<Subclass>, not ComponentPool<T>.
+// So, ForEach only visits components created as T exactly. Pool functions aren't thread safe - use them on the main thread.
+//
+#pragma once
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "Component.h"
+
+class Actor;
+
+class ComponentPoolBase
+{
+public:
+	virtual ~ComponentPoolBase() { }
+
+	// Destroys a component created by this pool.
+	virtual void Destroy(Component* component) = 0;
+
+	// Gets the component at an index, only if it's the same component the generation was taken from. Null otherwise.
+	virtual Component* Get(int index, unsigned int generation) const = 0;
+
+	// Goes up each time the component at an index is destroyed, so old handles to that index stop working.
+	virtual unsigned int GetGeneration(int index) const = 0;
+};
+
+template<class T>
+class ComponentPool : public ComponentPoolBase
+{
+public:
+	static ComponentPool<T>& Instance()
+	{
+		static ComponentPool<T> instance;
+		return instance;
+	}
+
+	T* Create(Actor* owner);
+	void Destroy(Component* component) override;
+
+	Component* Get(int index, unsigned int generation) const override;
+	unsigned int GetGeneration(int index) const override { return GetSlot(index).generation; }
+
+	int GetCount() const { return mCount; }
+
+	// Calls the function with every component in the pool, in memory order.
+	// It's fine for the function to destroy components, but components it creates may or may not be visited.
+	template<class Function> void ForEach(Function function);
+
+private:
+	// Components per chunk.
+	static const int kChunkSize = 64;
+
+	struct Slot
+	{
+		// Memory for the component. Only holds a constructed component while "alive."
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+		unsigned int generation = 0;
+		bool alive = false;
+
+		T* Get() { return reinterpret_cast<T*>(&storage); }
+	};
+
+	// All chunks allocated so far. Any components still alive when the pool goes away (at exit) are not destroyed -
+	// whatever they depend on may be gone by then - but their memory is freed.
+	std::vector<std::unique_ptr<Slot[]>> mChunks;
+
+	// Slots that have been used before, but are free now. Reused before any never-used slots.
+	std::vector<int> mFreeIndexes;
+
+	// Number of slots that have ever been used - every alive component is below this index.
+	int mUsedSlotCount = 0;
+
+	// Number of alive components.
+	int mCount = 0;
+
+	Slot& GetSlot(int index) const { return mChunks[index / kChunkSize][index % kChunkSize]; }
+};
+
+template<class T>
+T* ComponentPool<T>::Create(Actor* owner)
+{
+	// Reuse a free slot, or take the next never-used one (allocating a chunk if needed).
+	int index = 0;
+	if(!mFreeIndexes.empty())
+	{
+		index = mFreeIndexes.back();
+		mFreeIndexes.pop_back();
+	}
+	else
+	{
+		index = mUsedSlotCount++;
+		if(index / kChunkSize >= static_cast<int>(mChunks.size()))
+		{
+			mChunks.emplace_back(new Slot[kChunkSize]);
+		}
+	}
+
+	// Construct the component in the slot.
+	// Component constructors can add more components, maybe to this pool - fine, since slots don't move.
+	Slot& slot = GetSlot(index);
+	T* component = new(&slot.storage) T(owner);
+	component->mPool = this;
+	component->mPoolIndex = index;
+	slot.alive = true;
+	++mCount;
+	return component;
+}
+
+template<class T>
+void ComponentPool<T>::Destroy(Component* component)
+{
+	if(component == nullptr || component->mPool != this) { return; }
+
+	int index = component->mPoolIndex;
+	Slot& slot = GetSlot(index);
+	if(!slot.alive) { return; }
+
+	slot.Get()->~T();
+	slot.alive = false;
+	++slot.generation;
+	mFreeIndexes.push_back(index);
+	--mCount;
+}
+
+template<class T>
+Component* ComponentPool<T>::Get(int index, unsigned int generation) const
+{
+	if(index < 0 || index >= mUsedSlotCount) { return nullptr; }
+	Slot& slot = GetSlot(index);
+	return slot.alive && slot.generation == generation ? slot.Get() : nullptr;
+}
+
+template<class T>
+template<class Function>
+void ComponentPool<T>::ForEach(Function function)
+{
+	int usedSlotCount = mUsedSlotCount;
+	for(int chunkIndex = 0; chunkIndex * kChunkSize < usedSlotCount; ++chunkIndex)
+	{
+		Slot* slots = mChunks[chunkIndex].get();
+		int slotCount = usedSlotCount - chunkIndex * kChunkSize;
+		if(slotCount > kChunkSize) { slotCount = kChunkSize; }
+		for(int i = 0; i < slotCount; ++i)
+		{
+			if(slots[i].alive)
+			{
+				function(slots[i].Get());
+			}
+		}
+	}
+}
+
+// A reference to a component that knows whether the component still exists.
+// Unlike a pointer, Get returns null once the component is destroyed, even if its memory has been reused for another component.
+template<class T>
+class ComponentHandle
+{
+public:
+	ComponentHandle() = default;
+	ComponentHandle(T* component)
+	{
+		if(component != nullptr && component->GetPool() != nullptr)
+		{
+			mPool = component->GetPool();
+			mIndex = component->GetPoolIndex();
+			mGeneration = mPool->GetGeneration(mIndex);
+		}
+	}
+
+	T* Get() const { return mPool != nullptr ? static_cast<T*>(mPool->Get(mIndex, mGeneration)) : nullptr; }
+	T* operator->() const { return Get(); }
+	explicit operator bool() const { return Get() != nullptr; }
+
+private:
+	ComponentPoolBase* mPool = nullptr;
+	int mIndex = -1;
+	unsigned int mGeneration = 0;
+};
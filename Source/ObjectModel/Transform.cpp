@@ -7,6 +7,9 @@
 
 TYPE_DEF_CHILD(Component, Transform);
 
+float Transform::sInterpolation = 1.0f;
+unsigned int Transform::sInterpolationId = 1;
+
 Transform::Transform(Actor* owner) : Component(owner),
 	mLocalPosition(0.0f, 0.0f, 0.0f),
 	mLocalRotation(0.0f, 0.0f, 0.0f, 1.0f),
@@ -159,6 +162,60 @@ const Matrix4& Transform::GetWorldToLocalMatrix()
 	return mWorldToLocalMatrix;
 }
 
+void Transform::SaveInterpolationState()
+{
+	CalcLocalPosition();
+	mPreviousLocalPosition = mLocalPosition;
+	mPreviousLocalRotation = mLocalRotation;
+	mPreviousLocalScale = mLocalScale;
+	mPreviousChangeCount = mChangeCount;
+	mHasPreviousState = true;
+}
+
+void Transform::ResetInterpolation()
+{
+	// Saved state is the current state, so there's nothing to blend until something moves again.
+	SaveInterpolationState();
+	for(auto& child : mChildren)
+	{
+		child->ResetInterpolation();
+	}
+}
+
+const Matrix4& Transform::GetInterpolatedLocalToWorldMatrix()
+{
+	// If nothing moved during the last step (or there was no last step), current state is the same as the blended state.
+	if(!IsInterpolating())
+	{
+		return GetLocalToWorldMatrix();
+	}
+	
+	if(mInterpolatedId != sInterpolationId || mInterpolatedChangeCount != mChangeCount)
+	{
+		CalcLocalPosition();
+		Vector3 position = Vector3::Lerp(mPreviousLocalPosition, mLocalPosition, sInterpolation);
+		Quaternion rotation;
+		Quaternion::Slerp(rotation, mPreviousLocalRotation, mLocalRotation, sInterpolation);
+		Vector3 scale = Vector3::Lerp(mPreviousLocalScale, mLocalScale, sInterpolation);
+		
+		// Same as the regular local-to-world matrix, but with blended values.
+		mInterpolatedLocalToWorldMatrix = Matrix4::MakeTranslate(position) * Matrix4::MakeRotate(rotation) * Matrix4::MakeScale(scale);
+		if(mParent != nullptr)
+		{
+			mInterpolatedLocalToWorldMatrix = mParent->GetInterpolatedLocalToWorldMatrix() * mInterpolatedLocalToWorldMatrix;
+		}
+		mInterpolatedId = sInterpolationId;
+		mInterpolatedChangeCount = mChangeCount;
+	}
+	return mInterpolatedLocalToWorldMatrix;
+}
+
+/*static*/ void Transform::SetInterpolation(float interpolation)
+{
+	sInterpolation = interpolation;
+	++sInterpolationId;
+}
+
 Vector3 Transform::LocalToWorldPoint(const Vector3& localPoint)
 {
 	return GetLocalToWorldMatrix().TransformPoint(localPoint);
@@ -244,6 +301,7 @@ void Transform::SetDirty()
 {
 	mLocalToWorldDirty = true;
 	mWorldToLocalDirty = true;
+	++mChangeCount;
 	
 	for(auto& child : mChildren)
 	{
@@ -57,10 +57,28 @@ public:
 	Transform* GetParent() const { return mParent; }
 	const std::vector<Transform*>& GetChildren() const { return mChildren; }
 	
+	// Goes up every time this transform (or any parent) changes.
+	// Handy for caching things calculated from the transform - if the count is the same, the cache is still good.
+	unsigned int GetChangeCount() const { return mChangeCount; }
+	
 	// Transform matrices.
 	const Matrix4& GetLocalToWorldMatrix();
 	const Matrix4& GetWorldToLocalMatrix();
 	
+	// The game simulates in fixed steps, but renders whenever it can - usually somewhere in between two steps.
+	// To render smoothly, the state before each step is saved, and rendering blends from that state to the current one.
+	void SaveInterpolationState();
+	const Matrix4& GetInterpolatedLocalToWorldMatrix();
+	
+	// If false, the interpolated matrix is the same as the regular local-to-world matrix (nothing moved during the last step).
+	bool IsInterpolating() const { return mHasPreviousState && mPreviousChangeCount != mChangeCount && sInterpolation < 1.0f; }
+	
+	// Call after a jump (camera cut, teleport, scene load), so rendering doesn't blend from where this was before. Includes children.
+	void ResetInterpolation();
+	
+	// How far (0 to 1) rendering is from the previous simulation step to the current one. Applies to all transforms.
+	static void SetInterpolation(float interpolation);
+	
 	// Transforms points/directions from local space to world space.
 	Vector3 LocalToWorldPoint(const Vector3& localPoint);
 	Vector3 LocalToWorldDirection(const Vector3& localDirection);
@@ -99,6 +117,24 @@ protected:
 	// We only recalculate our matrices when we have to. This keeps track of that.
 	bool mLocalToWorldDirty = true;
 	bool mWorldToLocalDirty = true;
+	unsigned int mChangeCount = 0;
+	
+	// Local position/rotation/scale saved before the last simulation step, and the change count at the time.
+	// If the change count is the same now, nothing moved during the step, so there's nothing to blend.
+	Vector3 mPreviousLocalPosition;
+	Quaternion mPreviousLocalRotation;
+	Vector3 mPreviousLocalScale;
+	unsigned int mPreviousChangeCount = 0;
+	bool mHasPreviousState = false;
+	
+	// Blended local-to-world matrix, and the interpolation/change count it was calculated with.
+	Matrix4 mInterpolatedLocalToWorldMatrix;
+	unsigned int mInterpolatedId = 0;
+	unsigned int mInterpolatedChangeCount = 0;
+	
+	// Current interpolation for all transforms. The ID goes up each time it's set, so cached blends are recalculated.
+	static float sInterpolation;
+	static unsigned int sInterpolationId;
 	
 	// If we are a child of any other transform, parent is set.
 	// If we have any children, they are in the children vector.
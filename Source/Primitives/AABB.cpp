@@ -5,6 +5,8 @@
 //
 #include "AABB.h"
 
+#include "Matrix4.h"
+
 AABB::AABB(const Vector3& min, const Vector3& max) :
     mMin(min),
     mMax(max)
@@ -32,6 +34,14 @@ void AABB::GrowToContain(const Vector3& point)
 	mMax.z = Math::Max(mMax.z, point.z);
 }
 
+void AABB::GrowToContain(const AABB& other)
+{
+	// An invalid (empty) AABB has nothing to contain.
+	if(!other.IsValid()) { return; }
+	GrowToContain(other.mMin);
+	GrowToContain(other.mMax);
+}
+
 bool AABB::ContainsPoint(const Vector3& point) const
 {
 	// Point should be greater than min and less than max.
@@ -76,3 +86,18 @@ Vector3 AABB::GetClosestPoint(const Vector3& point) const
 	}
 	return result;
 }
+
+/*static*/ AABB AABB::Transform(const AABB& aabb, const Matrix4& matrix)
+{
+	// Transform the center as a point.
+	Vector3 center = matrix.TransformPoint(aabb.GetCenter());
+	
+	// Each transformed axis contributes its absolute value (scaled by extents) to the new extents.
+	// This gives the tightest AABB around the transformed box (Arvo's method).
+	Vector3 extents = aabb.GetExtents();
+	Vector3 newExtents;
+	newExtents.x = Math::Abs(matrix(0, 0)) * extents.x + Math::Abs(matrix(0, 1)) * extents.y + Math::Abs(matrix(0, 2)) * extents.z;
+	newExtents.y = Math::Abs(matrix(1, 0)) * extents.x + Math::Abs(matrix(1, 1)) * extents.y + Math::Abs(matrix(1, 2)) * extents.z;
+	newExtents.z = Math::Abs(matrix(2, 0)) * extents.x + Math::Abs(matrix(2, 1)) * extents.y + Math::Abs(matrix(2, 2)) * extents.z;
+	return AABB(center - newExtents, center + newExtents);
+}
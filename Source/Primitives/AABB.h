@@ -9,6 +9,8 @@
 #pragma once
 #include "Vector3.h"
 
+class Matrix4;
+
 class AABB
 {
 public:
@@ -23,12 +25,17 @@ public:
 	Vector3 GetExtents() const { return ((mMax - mMin) * 0.5f); }
 	
 	void GrowToContain(const Vector3& point);
+	void GrowToContain(const AABB& other);
 	
 	bool IsValid() const { return mMin.x <= mMax.x && mMin.y <= mMax.y && mMin.z <= mMax.z; }
 	
 	bool ContainsPoint(const Vector3& point) const;
 	Vector3 GetClosestPoint(const Vector3& point) const;
 	
+	// Calculates an AABB that contains the given AABB after it's transformed by a matrix.
+	// The result is usually bigger than the original box (unless the matrix only translates/scales).
+	static AABB Transform(const AABB& aabb, const Matrix4& matrix);
+	
 private:
     // Min and max points of the AABB.
     // Keep private b/c AABB can be represented as min/max points or center/size...may want or need to switch this at some point.
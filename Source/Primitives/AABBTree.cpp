@@ -0,0 +1,401 @@
+//
+// AABBTree.cpp
+//
+// Clark Kromenaker
+//
+#include "AABBTree.h"
+
+#include <algorithm>
+
+#include "Collisions.h"
+#include "Ray.h"
+#include "Sphere.h"
+
+namespace
+{
+	AABB Combine(const AABB& a, const AABB& b)
+	{
+		AABB combined = a;
+		combined.GrowToContain(b);
+		return combined;
+	}
+
+	// Half the surface area - all that's needed to compare boxes for the insert cost.
+	float GetHalfArea(const AABB& aabb)
+	{
+		Vector3 size = aabb.GetMax() - aabb.GetMin();
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	bool Contains(const AABB& outer, const AABB& inner)
+	{
+		Vector3 outerMin = outer.GetMin();
+		Vector3 outerMax = outer.GetMax();
+		Vector3 innerMin = inner.GetMin();
+		Vector3 innerMax = inner.GetMax();
+		return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+			   innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+	}
+
+	// Slab test against a box. Gives the "t" where the ray enters the box (or zero, if it starts inside).
+	bool RayIntersectsBounds(const AABB& bounds, const Vector3& origin, const Vector3& inverseDirection, float maxT, float& outEntryT)
+	{
+		Vector3 min = bounds.GetMin();
+		Vector3 max = bounds.GetMax();
+		float entryT = 0.0f;
+		float exitT = maxT;
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			float t0 = (min[axis] - origin[axis]) * inverseDirection[axis];
+			float t1 = (max[axis] - origin[axis]) * inverseDirection[axis];
+			if(t0 > t1) { std::swap(t0, t1); }
+			entryT = t0 > entryT ? t0 : entryT;
+			exitT = t1 < exitT ? t1 : exitT;
+			if(entryT > exitT) { return false; }
+		}
+		outEntryT = entryT;
+		return true;
+	}
+}
+
+AABBTree::AABBTree(float margin) :
+	mMargin(margin)
+{
+
+}
+
+int AABBTree::Insert(const AABB& aabb, int userIndex)
+{
+	int proxyId = AllocateNode();
+	Vector3 margin(mMargin, mMargin, mMargin);
+	mNodes[proxyId].bounds = AABB(aabb.GetMin() - margin, aabb.GetMax() + margin);
+	mNodes[proxyId].userIndex = userIndex;
+	mNodes[proxyId].height = 0;
+	InsertLeaf(proxyId);
+	++mProxyCount;
+	return proxyId;
+}
+
+void AABBTree::Remove(int proxyId)
+{
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+	--mProxyCount;
+}
+
+bool AABBTree::Update(int proxyId, const AABB& aabb)
+{
+	// Still inside the fat box? Then the tree is still correct as is.
+	if(Contains(mNodes[proxyId].bounds, aabb)) { return false; }
+
+	RemoveLeaf(proxyId);
+	Vector3 margin(mMargin, mMargin, mMargin);
+	mNodes[proxyId].bounds = AABB(aabb.GetMin() - margin, aabb.GetMax() + margin);
+	InsertLeaf(proxyId);
+	return true;
+}
+
+void AABBTree::Clear()
+{
+	mNodes.clear();
+	mRootIndex = kNullNode;
+	mFreeIndex = kNullNode;
+	mProxyCount = 0;
+}
+
+void AABBTree::Query(const AABB& aabb, std::vector<int>& outUserIndexes) const
+{
+	outUserIndexes.clear();
+	if(mRootIndex == kNullNode) { return; }
+
+	// Tree is balanced, so depth is about 1.44 * log2(proxies) at worst. This is plenty.
+	const int kMaxStackSize = 64;
+	int stack[kMaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = mRootIndex;
+	while(stackSize > 0)
+	{
+		const Node& node = mNodes[stack[--stackSize]];
+		if(!Collisions::TestAABBAABB(node.bounds, aabb)) { continue; }
+
+		if(node.IsLeaf())
+		{
+			outUserIndexes.push_back(node.userIndex);
+		}
+		else if(stackSize + 2 <= kMaxStackSize)
+		{
+			stack[stackSize++] = node.child2;
+			stack[stackSize++] = node.child1;
+		}
+	}
+}
+
+void AABBTree::Query(const Sphere& sphere, std::vector<int>& outUserIndexes) const
+{
+	outUserIndexes.clear();
+	if(mRootIndex == kNullNode) { return; }
+
+	const int kMaxStackSize = 64;
+	int stack[kMaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = mRootIndex;
+	while(stackSize > 0)
+	{
+		const Node& node = mNodes[stack[--stackSize]];
+		if(!Collisions::TestSphereAABB(sphere, node.bounds)) { continue; }
+
+		if(node.IsLeaf())
+		{
+			outUserIndexes.push_back(node.userIndex);
+		}
+		else if(stackSize + 2 <= kMaxStackSize)
+		{
+			stack[stackSize++] = node.child2;
+			stack[stackSize++] = node.child1;
+		}
+	}
+}
+
+void AABBTree::Raycast(const Ray& ray, float maxT, const std::function<float(int userIndex, float maxT)>& callback) const
+{
+	if(mRootIndex == kNullNode) { return; }
+
+	// Dividing by a zero direction gives infinity, which the slab test handles fine.
+	Vector3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+	float entryT = 0.0f;
+	if(!RayIntersectsBounds(mNodes[mRootIndex].bounds, ray.origin, inverseDirection, maxT, entryT)) { return; }
+
+	// Stack holds nodes already known to be hit by the ray, and the "t" they were entered at.
+	const int kMaxStackSize = 64;
+	std::pair<int, float> stack[kMaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = std::make_pair(mRootIndex, entryT);
+	while(stackSize > 0)
+	{
+		std::pair<int, float> entry = stack[--stackSize];
+
+		// A hit found since this was pushed may be nearer than the node now.
+		if(entry.second >= maxT) { continue; }
+
+		const Node& node = mNodes[entry.first];
+		if(node.IsLeaf())
+		{
+			maxT = callback(node.userIndex, maxT);
+			continue;
+		}
+
+		// Push the farther child first, so the nearer one is visited first (and likely shrinks maxT).
+		float entryT1 = 0.0f;
+		float entryT2 = 0.0f;
+		bool hit1 = RayIntersectsBounds(mNodes[node.child1].bounds, ray.origin, inverseDirection, maxT, entryT1);
+		bool hit2 = RayIntersectsBounds(mNodes[node.child2].bounds, ray.origin, inverseDirection, maxT, entryT2);
+		if(stackSize + 2 > kMaxStackSize) { continue; }
+		if(hit1 && hit2)
+		{
+			bool firstIsNearer = entryT1 <= entryT2;
+			stack[stackSize++] = firstIsNearer ? std::make_pair(node.child2, entryT2) : std::make_pair(node.child1, entryT1);
+			stack[stackSize++] = firstIsNearer ? std::make_pair(node.child1, entryT1) : std::make_pair(node.child2, entryT2);
+		}
+		else if(hit1)
+		{
+			stack[stackSize++] = std::make_pair(node.child1, entryT1);
+		}
+		else if(hit2)
+		{
+			stack[stackSize++] = std::make_pair(node.child2, entryT2);
+		}
+	}
+}
+
+int AABBTree::AllocateNode()
+{
+	// Reuse a free node, if there is one.
+	if(mFreeIndex != kNullNode)
+	{
+		int nodeIndex = mFreeIndex;
+		mFreeIndex = mNodes[nodeIndex].parent;
+		mNodes[nodeIndex] = Node();
+		return nodeIndex;
+	}
+	mNodes.emplace_back();
+	return static_cast<int>(mNodes.size()) - 1;
+}
+
+void AABBTree::FreeNode(int nodeIndex)
+{
+	mNodes[nodeIndex].parent = mFreeIndex;
+	mNodes[nodeIndex].height = -1;
+	mFreeIndex = nodeIndex;
+}
+
+void AABBTree::InsertLeaf(int leafIndex)
+{
+	if(mRootIndex == kNullNode)
+	{
+		mRootIndex = leafIndex;
+		mNodes[leafIndex].parent = kNullNode;
+		return;
+	}
+
+	// Walk down the tree to find the best sibling for the leaf - the one that adds the least total box area.
+	// At each node, either pair with the node itself, or go down to whichever child is cheaper.
+	AABB leafBounds = mNodes[leafIndex].bounds;
+	int index = mRootIndex;
+	while(!mNodes[index].IsLeaf())
+	{
+		const Node& node = mNodes[index];
+		float area = GetHalfArea(node.bounds);
+		float combinedArea = GetHalfArea(Combine(node.bounds, leafBounds));
+
+		// Cost of making a new parent for this node and the leaf.
+		float cost = 2.0f * combinedArea;
+
+		// Going down means every box from here up must grow to contain the leaf.
+		float inheritedCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.child1, node.child2 };
+		for(int i = 0; i < 2; ++i)
+		{
+			const Node& child = mNodes[children[i]];
+			float childCombinedArea = GetHalfArea(Combine(child.bounds, leafBounds));
+			childCosts[i] = (child.IsLeaf() ? childCombinedArea : childCombinedArea - GetHalfArea(child.bounds)) + inheritedCost;
+		}
+
+		if(cost < childCosts[0] && cost < childCosts[1]) { break; }
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	// Make a new parent for the sibling and the leaf.
+	int siblingIndex = index;
+	int oldParentIndex = mNodes[siblingIndex].parent;
+	int newParentIndex = AllocateNode();
+	Node& newParent = mNodes[newParentIndex];
+	newParent.parent = oldParentIndex;
+	newParent.bounds = Combine(leafBounds, mNodes[siblingIndex].bounds);
+	newParent.height = mNodes[siblingIndex].height + 1;
+	newParent.child1 = siblingIndex;
+	newParent.child2 = leafIndex;
+	mNodes[siblingIndex].parent = newParentIndex;
+	mNodes[leafIndex].parent = newParentIndex;
+
+	if(oldParentIndex != kNullNode)
+	{
+		ReplaceChild(oldParentIndex, siblingIndex, newParentIndex);
+	}
+	else
+	{
+		mRootIndex = newParentIndex;
+	}
+
+	// The new parent and boxes above it may need rebalancing, and boxes above it must grow.
+	RefitAncestors(newParentIndex);
+}
+
+void AABBTree::RemoveLeaf(int leafIndex)
+{
+	if(leafIndex == mRootIndex)
+	{
+		mRootIndex = kNullNode;
+		return;
+	}
+
+	// The leaf's parent goes away, and the sibling takes its place.
+	int parentIndex = mNodes[leafIndex].parent;
+	int grandparentIndex = mNodes[parentIndex].parent;
+	int siblingIndex = mNodes[parentIndex].child1 == leafIndex ? mNodes[parentIndex].child2 : mNodes[parentIndex].child1;
+
+	mNodes[siblingIndex].parent = grandparentIndex;
+	if(grandparentIndex != kNullNode)
+	{
+		ReplaceChild(grandparentIndex, parentIndex, siblingIndex);
+	}
+	else
+	{
+		mRootIndex = siblingIndex;
+	}
+	FreeNode(parentIndex);
+	RefitAncestors(grandparentIndex);
+}
+
+void AABBTree::RefitAncestors(int nodeIndex)
+{
+	while(nodeIndex != kNullNode)
+	{
+		nodeIndex = Balance(nodeIndex);
+
+		Node& node = mNodes[nodeIndex];
+		const Node& child1 = mNodes[node.child1];
+		const Node& child2 = mNodes[node.child2];
+		node.bounds = Combine(child1.bounds, child2.bounds);
+		node.height = 1 + std::max(child1.height, child2.height);
+		nodeIndex = node.parent;
+	}
+}
+
+int AABBTree::Balance(int indexA)
+{
+	// If one child of A is more than one level taller than the other, rotate it up to take A's place.
+	// A then takes the shorter of the taller child's children.
+	Node& a = mNodes[indexA];
+	if(a.IsLeaf() || a.height < 2) { return indexA; }
+
+	int indexB = a.child1;
+	int indexC = a.child2;
+	int balance = mNodes[indexC].height - mNodes[indexB].height;
+	if(balance >= -1 && balance <= 1) { return indexA; }
+
+	// Child to rotate up (and the one staying with A).
+	int indexUp = balance > 1 ? indexC : indexB;
+	int indexStay = balance > 1 ? indexB : indexC;
+	Node& up = mNodes[indexUp];
+
+	// Up takes A's place, with A as a child.
+	up.parent = a.parent;
+	a.parent = indexUp;
+	if(up.parent != kNullNode)
+	{
+		ReplaceChild(up.parent, indexA, indexUp);
+	}
+	else
+	{
+		mRootIndex = indexUp;
+	}
+
+	// Up keeps its taller child, and gives the shorter one to A.
+	int indexF = up.child1;
+	int indexG = up.child2;
+	int indexKeep = mNodes[indexF].height > mNodes[indexG].height ? indexF : indexG;
+	int indexGive = indexKeep == indexF ? indexG : indexF;
+	up.child1 = indexA;
+	up.child2 = indexKeep;
+	if(balance > 1)
+	{
+		a.child2 = indexGive;
+	}
+	else
+	{
+		a.child1 = indexGive;
+	}
+	mNodes[indexGive].parent = indexA;
+
+	a.bounds = Combine(mNodes[indexStay].bounds, mNodes[indexGive].bounds);
+	a.height = 1 + std::max(mNodes[indexStay].height, mNodes[indexGive].height);
+	up.bounds = Combine(a.bounds, mNodes[indexKeep].bounds);
+	up.height = 1 + std::max(a.height, mNodes[indexKeep].height);
+	return indexUp;
+}
+
+void AABBTree::ReplaceChild(int parentIndex, int oldChildIndex, int newChildIndex)
+{
+	Node& parent = mNodes[parentIndex];
+	if(parent.child1 == oldChildIndex)
+	{
+		parent.child1 = newChildIndex;
+	}
+	else
+	{
+		parent.child2 = newChildIndex;
+	}
+}
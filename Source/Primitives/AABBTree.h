@@ -0,0 +1,94 @@
+//
+// AABBTree.h
+//
+// Clark Kromenaker
+//
+// A dynamic bounding volume tree over boxes that can be added, moved, and removed at any time.
+// Used to find which of many objects a ray, sphere, or box might touch, without checking every object.
+//
+// Each box is stored "fat" (grown by a margin), so small movements don't change the tree at all.
+// The tree stays balanced as boxes come and go, using the same rotations as an AVL tree.
+//
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "AABB.h"
+
+class Ray;
+class Sphere;
+
+class AABBTree
+{
+public:
+	AABBTree() = default;
+	AABBTree(float margin);
+
+	// Adds a box to the tree. The user index is handed back by queries, to identify what the box belongs to.
+	// Returns a proxy ID, used to update or remove the box later.
+	int Insert(const AABB& aabb, int userIndex);
+	void Remove(int proxyId);
+
+	// Moves a box. Only changes the tree if the box has left its fat box; returns true if so.
+	bool Update(int proxyId, const AABB& aabb);
+
+	void Clear();
+
+	int GetUserIndex(int proxyId) const { return mNodes[proxyId].userIndex; }
+	const AABB& GetFatAABB(int proxyId) const { return mNodes[proxyId].bounds; }
+
+	int GetProxyCount() const { return mProxyCount; }
+	int GetHeight() const { return mRootIndex != kNullNode ? mNodes[mRootIndex].height : 0; }
+
+	// Finds user indexes of all boxes overlapping the box or sphere.
+	// Since boxes are fat, this may include some that don't quite touch - callers should do an exact test if it matters.
+	void Query(const AABB& aabb, std::vector<int>& outUserIndexes) const;
+	void Query(const Sphere& sphere, std::vector<int>& outUserIndexes) const;
+
+	// Calls back for each box the ray enters at a "t" less than maxT, roughly nearest first.
+	// The callback gets the user index and current maxT, and returns the new maxT - return a smaller value
+	// after finding a hit (to skip anything farther away), or maxT unchanged to keep looking.
+	void Raycast(const Ray& ray, float maxT, const std::function<float(int userIndex, float maxT)>& callback) const;
+
+private:
+	static const int kNullNode = -1;
+
+	struct Node
+	{
+		// For leaves, the fat box. For others, a box containing both children.
+		AABB bounds;
+
+		// For leaves, the index given to Insert.
+		int userIndex = -1;
+
+		// Parent node. When the node is unused, this is instead the next node in the free list.
+		int parent = kNullNode;
+
+		// Children - leaves have none.
+		int child1 = kNullNode;
+		int child2 = kNullNode;
+
+		// Leaves have a height of zero, unused nodes -1.
+		int height = -1;
+
+		bool IsLeaf() const { return child1 == kNullNode; }
+	};
+
+	// How much to grow boxes in every direction when inserting them.
+	float mMargin = 0.0f;
+
+	// All nodes, used or not. Proxy IDs are indexes into this, so nodes never move.
+	std::vector<Node> mNodes;
+	int mRootIndex = kNullNode;
+	int mFreeIndex = kNullNode;
+	int mProxyCount = 0;
+
+	int AllocateNode();
+	void FreeNode(int nodeIndex);
+
+	void InsertLeaf(int leafIndex);
+	void RemoveLeaf(int leafIndex);
+	void RefitAncestors(int nodeIndex);
+	int Balance(int nodeIndex);
+	void ReplaceChild(int parentIndex, int oldChildIndex, int newChildIndex);
+};
@@ -63,14 +63,16 @@
 
 /*static*/ bool Collisions::TestAABBAABB(const AABB& aabb1, const AABB& aabb2)
 {
-	// There are 4 cases where the AABBs are not intersecting.
+	// There are 6 cases where the AABBs are not intersecting.
 	bool case1 = aabb1.GetMax().x < aabb2.GetMin().x;
 	bool case2 = aabb1.GetMin().x > aabb2.GetMax().x;
 	bool case3 = aabb1.GetMax().y < aabb2.GetMin().y;
 	bool case4 = aabb1.GetMin().y > aabb2.GetMax().y;
+	bool case5 = aabb1.GetMax().z < aabb2.GetMin().z;
+	bool case6 = aabb1.GetMin().z > aabb2.GetMax().z;
 	
 	// If none of those cases are true, they must be intersecting.
-	return !case1 && !case2 && !case3 && !case4;
+	return !case1 && !case2 && !case3 && !case4 && !case5 && !case6;
 }
 
 /*static*/ bool Collisions::TestPlanePlane(const Plane& p1, const Plane& p2)
@@ -10,6 +10,8 @@
 #include <cfloat>
 #include <string>
 
+#include "Vector3.h"
+
 class Actor;
 class AABB;
 class LineSegment;
@@ -17,13 +19,15 @@ class Plane;
 class Ray;
 class Sphere;
 class Triangle;
-class Vector3;
 
 struct RaycastHit
 {
 	// The "t" value at which the hit occurred.
 	float t = FLT_MAX;
 	
+	// The point hit. Only filled in by some raycasts (e.g. scene and mesh raycasts), which note that they do.
+	Vector3 point;
+	
 	// A name/identifier for the thing hit.
 	std::string name;
 	
@@ -0,0 +1,147 @@
+//
+// Frustum.cpp
+//
+// Clark Kromenaker
+//
+#include "Frustum.h"
+
+#include "AABB.h"
+#include "GMath.h"
+#include "Matrix4.h"
+#include "SIMD.h"
+
+Frustum::Frustum(const Matrix4& m)
+{
+	// Gribb/Hartmann plane extraction: a clip space point is inside the frustum if -w <= x,y,z <= w.
+	// Each of those six inequalities, written in terms of the matrix rows, is a plane equation in world space.
+	// (e.g. "-w <= x" becomes "(row3 + row0) dot p >= 0").
+	for(int i = 0; i < 3; ++i)
+	{
+		Plane& positive = planes[i * 2];
+		positive.normal.x = m(3, 0) + m(i, 0);
+		positive.normal.y = m(3, 1) + m(i, 1);
+		positive.normal.z = m(3, 2) + m(i, 2);
+		positive.distance = m(3, 3) + m(i, 3);
+		
+		Plane& negative = planes[i * 2 + 1];
+		negative.normal.x = m(3, 0) - m(i, 0);
+		negative.normal.y = m(3, 1) - m(i, 1);
+		negative.normal.z = m(3, 2) - m(i, 2);
+		negative.distance = m(3, 3) - m(i, 3);
+	}
+	
+	// Normalize planes so signed distances are actual distances.
+	for(int i = 0; i < kPlaneCount; ++i)
+	{
+		float length = planes[i].normal.GetLength();
+		if(!Math::IsZero(length))
+		{
+			planes[i].normal /= length;
+			planes[i].distance /= length;
+		}
+	}
+}
+
+bool Frustum::ContainsPoint(const Vector3& point) const
+{
+	for(int i = 0; i < kPlaneCount; ++i)
+	{
+		if(planes[i].GetSignedDistance(point) < 0.0f) { return false; }
+	}
+	return true;
+}
+
+bool Frustum::IntersectsAABB(const AABB& aabb) const
+{
+	Vector3 center = aabb.GetCenter();
+	Vector3 extents = aabb.GetExtents();
+	for(int i = 0; i < kPlaneCount; ++i)
+	{
+		// Project the box extents onto the plane normal to get the box's "radius" along the normal.
+		// If the center is further behind the plane than that radius, the whole box is behind the plane.
+		const Vector3& n = planes[i].normal;
+		float radius = Math::Abs(n.x) * extents.x + Math::Abs(n.y) * extents.y + Math::Abs(n.z) * extents.z;
+		if(planes[i].GetSignedDistance(center) < -radius) { return false; }
+	}
+	return true;
+}
+
+bool Frustum::IntersectsSphere(const Vector3& center, float radius) const
+{
+	for(int i = 0; i < kPlaneCount; ++i)
+	{
+		if(planes[i].GetSignedDistance(center) < -radius) { return false; }
+	}
+	return true;
+}
+
+void Frustum::CullAABBs(const std::vector<AABB>& aabbs, std::vector<int>& outVisibleIndexes) const
+{
+	outVisibleIndexes.clear();
+	int count = static_cast<int>(aabbs.size());
+	int index = 0;
+	
+	#if defined(SIMD_SSE)
+	// Broadcast each plane's values once up front.
+	__m128 nx[kPlaneCount], ny[kPlaneCount], nz[kPlaneCount], d[kPlaneCount];
+	__m128 absNx[kPlaneCount], absNy[kPlaneCount], absNz[kPlaneCount];
+	for(int i = 0; i < kPlaneCount; ++i)
+	{
+		nx[i] = _mm_set1_ps(planes[i].normal.x);
+		ny[i] = _mm_set1_ps(planes[i].normal.y);
+		nz[i] = _mm_set1_ps(planes[i].normal.z);
+		d[i] = _mm_set1_ps(planes[i].distance);
+		absNx[i] = _mm_set1_ps(Math::Abs(planes[i].normal.x));
+		absNy[i] = _mm_set1_ps(Math::Abs(planes[i].normal.y));
+		absNz[i] = _mm_set1_ps(Math::Abs(planes[i].normal.z));
+	}
+	
+	// Test four boxes at a time - same math as IntersectsAABB, but with one box per SIMD lane.
+	const __m128 zero = _mm_setzero_ps();
+	for(; index + 4 <= count; index += 4)
+	{
+		float cx[4], cy[4], cz[4], ex[4], ey[4], ez[4];
+		for(int j = 0; j < 4; ++j)
+		{
+			Vector3 center = aabbs[index + j].GetCenter();
+			Vector3 extents = aabbs[index + j].GetExtents();
+			cx[j] = center.x; cy[j] = center.y; cz[j] = center.z;
+			ex[j] = extents.x; ey[j] = extents.y; ez[j] = extents.z;
+		}
+		__m128 centerX = _mm_loadu_ps(cx);
+		__m128 centerY = _mm_loadu_ps(cy);
+		__m128 centerZ = _mm_loadu_ps(cz);
+		__m128 extentsX = _mm_loadu_ps(ex);
+		__m128 extentsY = _mm_loadu_ps(ey);
+		__m128 extentsZ = _mm_loadu_ps(ez);
+		
+		__m128 outside = _mm_setzero_ps();
+		for(int i = 0; i < kPlaneCount; ++i)
+		{
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[i], centerX), _mm_mul_ps(ny[i], centerY)),
+									 _mm_add_ps(_mm_mul_ps(nz[i], centerZ), d[i]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNx[i], extentsX), _mm_mul_ps(absNy[i], extentsY)),
+									   _mm_mul_ps(absNz[i], extentsZ));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+		}
+		
+		int outsideMask = _mm_movemask_ps(outside);
+		for(int j = 0; j < 4; ++j)
+		{
+			if((outsideMask & (1 << j)) == 0)
+			{
+				outVisibleIndexes.push_back(index + j);
+			}
+		}
+	}
+	#endif
+	
+	// Scalar path for any remaining boxes (or all boxes, if no SIMD).
+	for(; index < count; ++index)
+	{
+		if(IntersectsAABB(aabbs[index]))
+		{
+			outVisibleIndexes.push_back(index);
+		}
+	}
+}
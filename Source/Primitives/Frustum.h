@@ -0,0 +1,40 @@
+//
+// Frustum.h
+//
+// Clark Kromenaker
+//
+// A view frustum: the volume of space visible to a camera, bounded by six planes.
+// Plane normals face into the frustum, so a point is inside if it's in front of all six planes.
+//
+#pragma once
+#include <vector>
+
+#include "Plane.h"
+
+class AABB;
+class Matrix4;
+
+class Frustum
+{
+public:
+	Frustum() = default;
+	
+	// Extracts frustum planes from a "world to projection" (proj * view) matrix.
+	// If the matrix is only a projection matrix, the resulting planes are in view space.
+	Frustum(const Matrix4& worldToProjMatrix);
+	
+	bool ContainsPoint(const Vector3& point) const;
+	
+	// Conservative tests - may report an intersection for shapes that are just outside a frustum corner.
+	// That's fine for culling, where false positives just mean drawing something off-screen.
+	bool IntersectsAABB(const AABB& aabb) const;
+	bool IntersectsSphere(const Vector3& center, float radius) const;
+	
+	// Tests many AABBs at once, using SIMD when available.
+	// Indexes of AABBs that intersect the frustum are output (in order).
+	void CullAABBs(const std::vector<AABB>& aabbs, std::vector<int>& outVisibleIndexes) const;
+	
+	// Left, right, bottom, top, near, far.
+	static const int kPlaneCount = 6;
+	Plane planes[kPlaneCount];
+};
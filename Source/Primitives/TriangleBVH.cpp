@@ -0,0 +1,193 @@
+//
+// TriangleBVH.cpp
+//
+// Clark Kromenaker
+//
+#include "TriangleBVH.h"
+
+#include <algorithm>
+
+#include "Ray.h"
+
+namespace
+{
+	AABB GetTriangleBounds(const Triangle& triangle)
+	{
+		AABB bounds(triangle.p0, triangle.p0);
+		bounds.GrowToContain(triangle.p1);
+		bounds.GrowToContain(triangle.p2);
+		return bounds;
+	}
+
+	// Slab test against a box. Gives the "t" where the ray enters the box (or zero, if it starts inside).
+	bool RayIntersectsBounds(const AABB& bounds, const Vector3& origin, const Vector3& inverseDirection, float maxT, float& outEntryT)
+	{
+		Vector3 min = bounds.GetMin();
+		Vector3 max = bounds.GetMax();
+		float entryT = 0.0f;
+		float exitT = maxT;
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			float t0 = (min[axis] - origin[axis]) * inverseDirection[axis];
+			float t1 = (max[axis] - origin[axis]) * inverseDirection[axis];
+			if(t0 > t1) { std::swap(t0, t1); }
+			entryT = t0 > entryT ? t0 : entryT;
+			exitT = t1 < exitT ? t1 : exitT;
+			if(entryT > exitT) { return false; }
+		}
+		outEntryT = entryT;
+		return true;
+	}
+}
+
+void TriangleBVH::Build(const std::vector<Triangle>& triangles)
+{
+	Clear();
+	if(triangles.empty()) { return; }
+
+	std::vector<Vector3> centroids;
+	centroids.reserve(triangles.size());
+	mTriangleIndexes.reserve(triangles.size());
+	for(int i = 0; i < triangles.size(); ++i)
+	{
+		centroids.push_back((triangles[i].p0 + triangles[i].p1 + triangles[i].p2) / 3.0f);
+		mTriangleIndexes.push_back(i);
+	}
+
+	mNodes.reserve(2 * (triangles.size() / kMaxLeafSize) + 1);
+	BuildNode(triangles, centroids, 0, static_cast<int>(triangles.size()));
+	FillTriangles(triangles);
+}
+
+void TriangleBVH::Refit(const std::vector<Triangle>& triangles)
+{
+	if(triangles.size() != mTriangleIndexes.size() || mNodes.empty())
+	{
+		Build(triangles);
+		return;
+	}
+	FillTriangles(triangles);
+
+	// Children always come after their parents, so going backwards updates children first.
+	for(int i = static_cast<int>(mNodes.size()) - 1; i >= 0; --i)
+	{
+		Node& node = mNodes[i];
+		if(node.count > 0)
+		{
+			node.bounds = GetTriangleBounds(triangles[mTriangleIndexes[node.start]]);
+			for(int j = node.start + 1; j < node.start + node.count; ++j)
+			{
+				node.bounds.GrowToContain(GetTriangleBounds(triangles[mTriangleIndexes[j]]));
+			}
+		}
+		else
+		{
+			node.bounds = mNodes[i + 1].bounds;
+			node.bounds.GrowToContain(mNodes[node.start].bounds);
+		}
+	}
+}
+
+void TriangleBVH::Clear()
+{
+	mNodes.clear();
+	mTriangles.Clear();
+	mTriangleIndexes.clear();
+}
+
+bool TriangleBVH::Raycast(const Ray& ray, float& outT, int& outTriangleIndex) const
+{
+	if(mNodes.empty()) { return false; }
+
+	// Dividing by a zero direction gives infinity, which the slab test handles fine.
+	Vector3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+	// Median splits keep the tree balanced, so depth is about log2(triangles / leaf size). This is plenty.
+	const int kMaxStackSize = 64;
+	int stack[kMaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	float nearestT = outT;
+	int nearestIndex = -1;
+	while(stackSize > 0)
+	{
+		int nodeIndex = stack[--stackSize];
+		const Node& node = mNodes[nodeIndex];
+
+		// Skip nodes the ray misses, or that start farther away than the nearest hit so far.
+		float entryT = 0.0f;
+		if(!RayIntersectsBounds(node.bounds, ray.origin, inverseDirection, nearestT, entryT)) { continue; }
+
+		if(node.count > 0)
+		{
+			int hitIndex = -1;
+			if(mTriangles.Raycast(ray, node.start, node.start + node.count, nearestT, hitIndex))
+			{
+				nearestIndex = hitIndex;
+			}
+		}
+		else if(stackSize + 2 <= kMaxStackSize)
+		{
+			// Push the farther child first, so the nearer one is visited first (and likely shrinks nearestT).
+			bool firstIsNearer = ray.direction[node.axis] >= 0.0f;
+			stack[stackSize++] = firstIsNearer ? node.start : nodeIndex + 1;
+			stack[stackSize++] = firstIsNearer ? nodeIndex + 1 : node.start;
+		}
+	}
+
+	if(nearestIndex < 0) { return false; }
+	outT = nearestT;
+	outTriangleIndex = mTriangleIndexes[nearestIndex];
+	return true;
+}
+
+int TriangleBVH::BuildNode(const std::vector<Triangle>& triangles, const std::vector<Vector3>& centroids, int start, int end)
+{
+	int nodeIndex = static_cast<int>(mNodes.size());
+	mNodes.emplace_back();
+
+	AABB bounds = GetTriangleBounds(triangles[mTriangleIndexes[start]]);
+	AABB centroidBounds(centroids[mTriangleIndexes[start]], centroids[mTriangleIndexes[start]]);
+	for(int i = start + 1; i < end; ++i)
+	{
+		bounds.GrowToContain(GetTriangleBounds(triangles[mTriangleIndexes[i]]));
+		centroidBounds.GrowToContain(centroids[mTriangleIndexes[i]]);
+	}
+	mNodes[nodeIndex].bounds = bounds;
+
+	int count = end - start;
+	if(count <= kMaxLeafSize)
+	{
+		mNodes[nodeIndex].start = start;
+		mNodes[nodeIndex].count = count;
+		return nodeIndex;
+	}
+
+	// Split at the median along the axis the centroids are most spread out on.
+	// The left half is rounded up to a whole number of leaves, so leaves line up with the batch's SIMD blocks.
+	Vector3 spread = centroidBounds.GetMax() - centroidBounds.GetMin();
+	int axis = 0;
+	if(spread.y > spread[axis]) { axis = 1; }
+	if(spread.z > spread[axis]) { axis = 2; }
+	int mid = start + ((count / 2 + kMaxLeafSize - 1) / kMaxLeafSize) * kMaxLeafSize;
+	std::nth_element(mTriangleIndexes.begin() + start, mTriangleIndexes.begin() + mid, mTriangleIndexes.begin() + end, [&centroids, axis](int a, int b) {
+		return centroids[a][axis] < centroids[b][axis];
+	});
+
+	BuildNode(triangles, centroids, start, mid);
+	int secondChild = BuildNode(triangles, centroids, mid, end);
+	mNodes[nodeIndex].start = secondChild;
+	mNodes[nodeIndex].axis = axis;
+	return nodeIndex;
+}
+
+void TriangleBVH::FillTriangles(const std::vector<Triangle>& triangles)
+{
+	mTriangles.Clear();
+	mTriangles.Reserve(static_cast<int>(mTriangleIndexes.size()));
+	for(int index : mTriangleIndexes)
+	{
+		mTriangles.Add(triangles[index].p0, triangles[index].p1, triangles[index].p2);
+	}
+}
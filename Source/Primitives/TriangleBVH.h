@@ -0,0 +1,65 @@
+//
+// TriangleBVH.h
+//
+// Clark Kromenaker
+//
+// A bounding volume hierarchy over a set of triangles, for finding the nearest triangle a ray hits.
+// Each node has a box containing all its triangles; a ray that misses the box can skip all of them.
+//
+// Leaves hold a few triangles, stored back-to-back in a TriangleBatch so they are tested together.
+//
+#pragma once
+#include <vector>
+
+#include "AABB.h"
+#include "Triangle.h"
+#include "TriangleBatch.h"
+
+class Ray;
+
+class TriangleBVH
+{
+public:
+	// Builds the tree for the given triangles, replacing any existing contents.
+	void Build(const std::vector<Triangle>& triangles);
+
+	// Updates triangle positions and node bounds, but keeps the tree's shape.
+	// Much cheaper than a rebuild, and fine for meshes that deform (e.g. vertex animation).
+	// The triangles must be the same count and order as when built - if the count differs, this does a full build.
+	void Refit(const std::vector<Triangle>& triangles);
+
+	void Clear();
+
+	// Finds the nearest triangle the ray hits at a "t" less than outT.
+	// If found, outT and outTriangleIndex (index into the triangles given to Build) are updated and true is returned.
+	bool Raycast(const Ray& ray, float& outT, int& outTriangleIndex) const;
+
+	int GetTriangleCount() const { return static_cast<int>(mTriangleIndexes.size()); }
+
+private:
+	// Max triangles in a leaf - one SIMD block's worth.
+	static const int kMaxLeafSize = 4;
+
+	struct Node
+	{
+		AABB bounds;
+
+		// For leaves, the first triangle (in tree order) and number of triangles.
+		// Other nodes have a count of zero; their first child is the next node, and "start" is the second child.
+		int start = 0;
+		int count = 0;
+
+		// Axis the children were split along. Used to visit the nearer child first.
+		int axis = 0;
+	};
+
+	// Nodes, parents before children.
+	std::vector<Node> mNodes;
+
+	// Triangles in tree order (each leaf's triangles are together), and the original index of each.
+	TriangleBatch mTriangles;
+	std::vector<int> mTriangleIndexes;
+
+	int BuildNode(const std::vector<Triangle>& triangles, const std::vector<Vector3>& centroids, int start, int end);
+	void FillTriangles(const std::vector<Triangle>& triangles);
+};
@@ -0,0 +1,230 @@
+//
+// TriangleBatch.cpp
+//
+// Clark Kromenaker
+//
+#include "TriangleBatch.h"
+
+#include "GMath.h"
+#include "Ray.h"
+#include "SIMD.h"
+#include "Vector3.h"
+
+void TriangleBatch::Clear()
+{
+	mBlocks.clear();
+	mTriangleCount = 0;
+}
+
+void TriangleBatch::Reserve(int triangleCount)
+{
+	mBlocks.reserve(((triangleCount + kBlockSize - 1) / kBlockSize) * kBlockFloatCount);
+}
+
+void TriangleBatch::Add(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+{
+	// Start a new (zeroed) block when the last one is full.
+	int lane = mTriangleCount % kBlockSize;
+	if(lane == 0)
+	{
+		mBlocks.resize(mBlocks.size() + kBlockFloatCount, 0.0f);
+	}
+	float* block = &mBlocks[(mTriangleCount / kBlockSize) * kBlockFloatCount];
+
+	Vector3 edge1 = p1 - p0;
+	Vector3 edge2 = p2 - p0;
+	for(int i = 0; i < 3; ++i)
+	{
+		block[i * kBlockSize + lane] = p0[i];
+		block[(3 + i) * kBlockSize + lane] = edge1[i];
+		block[(6 + i) * kBlockSize + lane] = edge2[i];
+	}
+	++mTriangleCount;
+}
+
+bool TriangleBatch::Raycast(const Ray& ray, int start, int end, float& outT, int& outIndex) const
+{
+	if(start < 0) { start = 0; }
+	if(end > mTriangleCount) { end = mTriangleCount; }
+	if(start >= end) { return false; }
+
+	// This is the same math as Collisions::TestRayTriangle, done for a whole block of triangles at once.
+	int firstBlock = start / kBlockSize;
+	int lastBlock = (end - 1) / kBlockSize;
+	float bestT = outT;
+	int bestIndex = -1;
+
+	#if defined(SIMD_SSE) || defined(SIMD_NEON)
+	// Each lane tracks the nearest hit among the triangles it has seen.
+	// Triangles outside [start, end) are masked out, so ranges don't need to line up with blocks.
+	float laneTs[kBlockSize];
+	int laneIndexes[kBlockSize];
+	#if defined(SIMD_SSE)
+	__m128 originX = _mm_set1_ps(ray.origin.x);
+	__m128 originY = _mm_set1_ps(ray.origin.y);
+	__m128 originZ = _mm_set1_ps(ray.origin.z);
+	__m128 dirX = _mm_set1_ps(ray.direction.x);
+	__m128 dirY = _mm_set1_ps(ray.direction.y);
+	__m128 dirZ = _mm_set1_ps(ray.direction.z);
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 epsilon = _mm_set1_ps(Math::kEpsilon);
+	__m128 signBit = _mm_set1_ps(-0.0f);
+	__m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i rangeStart = _mm_set1_epi32(start);
+	__m128i rangeEnd = _mm_set1_epi32(end);
+
+	__m128 nearestTs = _mm_set1_ps(outT);
+	__m128i nearestIndexes = _mm_set1_epi32(-1);
+	for(int block = firstBlock; block <= lastBlock; ++block)
+	{
+		const float* data = &mBlocks[block * kBlockFloatCount];
+		__m128 edge1X = _mm_loadu_ps(data + 12);
+		__m128 edge1Y = _mm_loadu_ps(data + 16);
+		__m128 edge1Z = _mm_loadu_ps(data + 20);
+		__m128 edge2X = _mm_loadu_ps(data + 24);
+		__m128 edge2Y = _mm_loadu_ps(data + 28);
+		__m128 edge2Z = _mm_loadu_ps(data + 32);
+
+		// p = cross(direction, edge2), a = dot(edge1, p). A near-zero a means the ray is parallel to the triangle.
+		__m128 pX = _mm_sub_ps(_mm_mul_ps(dirY, edge2Z), _mm_mul_ps(dirZ, edge2Y));
+		__m128 pY = _mm_sub_ps(_mm_mul_ps(dirZ, edge2X), _mm_mul_ps(dirX, edge2Z));
+		__m128 pZ = _mm_sub_ps(_mm_mul_ps(dirX, edge2Y), _mm_mul_ps(dirY, edge2X));
+		__m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+		__m128 hit = _mm_cmpge_ps(_mm_andnot_ps(signBit, a), epsilon);
+		__m128 f = _mm_div_ps(one, a);
+
+		__m128 sX = _mm_sub_ps(originX, _mm_loadu_ps(data));
+		__m128 sY = _mm_sub_ps(originY, _mm_loadu_ps(data + 4));
+		__m128 sZ = _mm_sub_ps(originZ, _mm_loadu_ps(data + 8));
+		__m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, pX), _mm_mul_ps(sY, pY)), _mm_mul_ps(sZ, pZ)));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+		__m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(sZ, edge1Y));
+		__m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(sX, edge1Z));
+		__m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(sY, edge1X));
+		__m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, qX), _mm_mul_ps(dirY, qY)), _mm_mul_ps(dirZ, qZ)));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+		__m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, nearestTs)));
+
+		__m128i indexes = _mm_add_epi32(_mm_set1_epi32(block * kBlockSize), laneOffsets);
+		__m128i inRange = _mm_andnot_si128(_mm_cmplt_epi32(indexes, rangeStart), _mm_cmplt_epi32(indexes, rangeEnd));
+		hit = _mm_and_ps(hit, _mm_castsi128_ps(inRange));
+		if(_mm_movemask_ps(hit) == 0) { continue; }
+
+		__m128i hitMask = _mm_castps_si128(hit);
+		nearestTs = _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, nearestTs));
+		nearestIndexes = _mm_or_si128(_mm_and_si128(hitMask, indexes), _mm_andnot_si128(hitMask, nearestIndexes));
+	}
+	_mm_storeu_ps(laneTs, nearestTs);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(laneIndexes), nearestIndexes);
+	#elif defined(SIMD_NEON)
+	float32x4_t originX = vdupq_n_f32(ray.origin.x);
+	float32x4_t originY = vdupq_n_f32(ray.origin.y);
+	float32x4_t originZ = vdupq_n_f32(ray.origin.z);
+	float32x4_t dirX = vdupq_n_f32(ray.direction.x);
+	float32x4_t dirY = vdupq_n_f32(ray.direction.y);
+	float32x4_t dirZ = vdupq_n_f32(ray.direction.z);
+	float32x4_t zero = vdupq_n_f32(0.0f);
+	float32x4_t one = vdupq_n_f32(1.0f);
+	float32x4_t epsilon = vdupq_n_f32(Math::kEpsilon);
+	const int32_t laneOffsetValues[kBlockSize] = { 0, 1, 2, 3 };
+	int32x4_t laneOffsets = vld1q_s32(laneOffsetValues);
+	int32x4_t rangeStart = vdupq_n_s32(start);
+	int32x4_t rangeEnd = vdupq_n_s32(end);
+
+	float32x4_t nearestTs = vdupq_n_f32(outT);
+	int32x4_t nearestIndexes = vdupq_n_s32(-1);
+	for(int block = firstBlock; block <= lastBlock; ++block)
+	{
+		const float* data = &mBlocks[block * kBlockFloatCount];
+		float32x4_t edge1X = vld1q_f32(data + 12);
+		float32x4_t edge1Y = vld1q_f32(data + 16);
+		float32x4_t edge1Z = vld1q_f32(data + 20);
+		float32x4_t edge2X = vld1q_f32(data + 24);
+		float32x4_t edge2Y = vld1q_f32(data + 28);
+		float32x4_t edge2Z = vld1q_f32(data + 32);
+
+		float32x4_t pX = vmlsq_f32(vmulq_f32(dirY, edge2Z), dirZ, edge2Y);
+		float32x4_t pY = vmlsq_f32(vmulq_f32(dirZ, edge2X), dirX, edge2Z);
+		float32x4_t pZ = vmlsq_f32(vmulq_f32(dirX, edge2Y), dirY, edge2X);
+		float32x4_t a = vmlaq_f32(vmlaq_f32(vmulq_f32(edge1X, pX), edge1Y, pY), edge1Z, pZ);
+		uint32x4_t hit = vcgeq_f32(vabsq_f32(a), epsilon);
+
+		// No divide on all NEON targets - a reciprocal estimate with two refinement steps is close enough.
+		float32x4_t f = vrecpeq_f32(a);
+		f = vmulq_f32(vrecpsq_f32(a, f), f);
+		f = vmulq_f32(vrecpsq_f32(a, f), f);
+
+		float32x4_t sX = vsubq_f32(originX, vld1q_f32(data));
+		float32x4_t sY = vsubq_f32(originY, vld1q_f32(data + 4));
+		float32x4_t sZ = vsubq_f32(originZ, vld1q_f32(data + 8));
+		float32x4_t u = vmulq_f32(f, vmlaq_f32(vmlaq_f32(vmulq_f32(sX, pX), sY, pY), sZ, pZ));
+		hit = vandq_u32(hit, vandq_u32(vcgeq_f32(u, zero), vcleq_f32(u, one)));
+
+		float32x4_t qX = vmlsq_f32(vmulq_f32(sY, edge1Z), sZ, edge1Y);
+		float32x4_t qY = vmlsq_f32(vmulq_f32(sZ, edge1X), sX, edge1Z);
+		float32x4_t qZ = vmlsq_f32(vmulq_f32(sX, edge1Y), sY, edge1X);
+		float32x4_t v = vmulq_f32(f, vmlaq_f32(vmlaq_f32(vmulq_f32(dirX, qX), dirY, qY), dirZ, qZ));
+		hit = vandq_u32(hit, vandq_u32(vcgeq_f32(v, zero), vcleq_f32(vaddq_f32(u, v), one)));
+
+		float32x4_t t = vmulq_f32(f, vmlaq_f32(vmlaq_f32(vmulq_f32(edge2X, qX), edge2Y, qY), edge2Z, qZ));
+		hit = vandq_u32(hit, vandq_u32(vcgeq_f32(t, zero), vcltq_f32(t, nearestTs)));
+
+		int32x4_t indexes = vaddq_s32(vdupq_n_s32(block * kBlockSize), laneOffsets);
+		hit = vandq_u32(hit, vandq_u32(vcgeq_s32(indexes, rangeStart), vcltq_s32(indexes, rangeEnd)));
+
+		nearestTs = vbslq_f32(hit, t, nearestTs);
+		nearestIndexes = vbslq_s32(hit, indexes, nearestIndexes);
+	}
+	vst1q_f32(laneTs, nearestTs);
+	vst1q_s32(laneIndexes, nearestIndexes);
+	#endif
+
+	// Nearest over all lanes.
+	for(int lane = 0; lane < kBlockSize; ++lane)
+	{
+		if(laneIndexes[lane] < 0) { continue; }
+		if(laneTs[lane] < bestT || (laneTs[lane] == bestT && laneIndexes[lane] < bestIndex))
+		{
+			bestT = laneTs[lane];
+			bestIndex = laneIndexes[lane];
+		}
+	}
+	#else
+	for(int i = start; i < end; ++i)
+	{
+		const float* data = &mBlocks[(i / kBlockSize) * kBlockFloatCount + (i % kBlockSize)];
+		Vector3 p0(data[0], data[kBlockSize], data[kBlockSize * 2]);
+		Vector3 edge1(data[kBlockSize * 3], data[kBlockSize * 4], data[kBlockSize * 5]);
+		Vector3 edge2(data[kBlockSize * 6], data[kBlockSize * 7], data[kBlockSize * 8]);
+
+		Vector3 p = Vector3::Cross(ray.direction, edge2);
+		float a = Vector3::Dot(edge1, p);
+		if(Math::IsZero(a)) { continue; }
+		float f = 1.0f / a;
+
+		Vector3 s = ray.origin - p0;
+		float u = f * Vector3::Dot(s, p);
+		if(u < 0.0f || u > 1.0f) { continue; }
+
+		Vector3 q = Vector3::Cross(s, edge1);
+		float v = f * Vector3::Dot(ray.direction, q);
+		if(v < 0.0f || u + v > 1.0f) { continue; }
+
+		float t = f * Vector3::Dot(edge2, q);
+		if(t >= 0.0f && t < bestT)
+		{
+			bestT = t;
+			bestIndex = i;
+		}
+	}
+	#endif
+
+	if(bestIndex < 0) { return false; }
+	outT = bestT;
+	outIndex = bestIndex;
+	return true;
+}
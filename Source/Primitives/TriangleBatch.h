@@ -0,0 +1,43 @@
+//
+// TriangleBatch.h
+//
+// Clark Kromenaker
+//
+// A list of triangles stored for fast ray tests.
+//
+// Triangles are stored as a corner and two edges (what the Moller-Trumbore test uses), in blocks of 4:
+// each block holds the x values of 4 triangles' corners, then the y values, and so on.
+// That lets SIMD code test a ray against 4 triangles at once with no gathering or index lookups.
+//
+#pragma once
+#include <vector>
+
+class Ray;
+class Vector3;
+
+class TriangleBatch
+{
+public:
+	void Clear();
+	void Reserve(int triangleCount);
+
+	// Adds a triangle. Triangles are numbered in the order they are added.
+	void Add(const Vector3& p0, const Vector3& p1, const Vector3& p2);
+	int GetTriangleCount() const { return mTriangleCount; }
+
+	// Finds the nearest triangle with index in [start, end) that the ray hits at a "t" less than outT.
+	// If one is found, outT and outIndex are updated and true is returned. Otherwise, they are left unchanged.
+	// Calling this for several ranges (or batches) with the same outT finds the nearest hit over all of them.
+	// Ties go to the lowest index, same as testing triangles one at a time in order.
+	bool Raycast(const Ray& ray, int start, int end, float& outT, int& outIndex) const;
+	bool Raycast(const Ray& ray, float& outT, int& outIndex) const { return Raycast(ray, 0, mTriangleCount, outT, outIndex); }
+
+private:
+	// Triangles per block, and floats per block (4 each of corner xyz, edge1 xyz, edge2 xyz).
+	static const int kBlockSize = 4;
+	static const int kBlockFloatCount = kBlockSize * 9;
+
+	// Triangle data in blocks. Unused slots in the last block are zero (a degenerate triangle that is never hit).
+	std::vector<float> mBlocks;
+	int mTriangleCount = 0;
+};
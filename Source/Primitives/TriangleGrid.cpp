@@ -0,0 +1,154 @@
+//
+// TriangleGrid.cpp
+//
+// Clark Kromenaker
+//
+#include "TriangleGrid.h"
+
+#include <algorithm>
+
+#include "GMath.h"
+
+void TriangleGrid::Build(const std::vector<Triangle>& triangles)
+{
+	Clear();
+	if(triangles.empty()) { return; }
+	mTriangles = triangles;
+
+	// Find bounds of each triangle, and of all triangles.
+	mTriangleBounds.reserve(mTriangles.size());
+	for(auto& triangle : mTriangles)
+	{
+		AABB bounds(triangle.p0, triangle.p0);
+		bounds.GrowToContain(triangle.p1);
+		bounds.GrowToContain(triangle.p2);
+		mTriangleBounds.push_back(bounds);
+	}
+	mBounds = mTriangleBounds[0];
+	for(auto& bounds : mTriangleBounds)
+	{
+		mBounds.GrowToContain(bounds);
+	}
+
+	// Aim for about one cell per triangle - fine enough that a query only sees nearby triangles,
+	// but coarse enough that big triangles don't land in a huge number of cells.
+	// Flat bounds (e.g. all walls the same height) shouldn't collapse the volume to zero, so each side is at least 1 unit.
+	Vector3 size = mBounds.GetMax() - mBounds.GetMin();
+	float volume = Math::Max(size.x, 1.0f) * Math::Max(size.y, 1.0f) * Math::Max(size.z, 1.0f);
+	mCellSize = Math::Max(Math::Pow(volume / mTriangles.size(), 1.0f / 3.0f), 1.0f);
+	float largestSide = Math::Max(size.x, Math::Max(size.y, size.z));
+	mCellSize = Math::Max(mCellSize, largestSide / kMaxCellsPerAxis);
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		mCellCounts[axis] = Math::Clamp(Math::FloorToInt(size[axis] / mCellSize) + 1, 1, kMaxCellsPerAxis);
+	}
+
+	// Count triangles in each cell, then turn counts into start offsets, then fill in.
+	// Two passes over the triangles, but all the cell lists end up packed in one array.
+	int cellCount = mCellCounts[0] * mCellCounts[1] * mCellCounts[2];
+	mCellStarts.assign(cellCount + 1, 0);
+	int cellMin[3];
+	int cellMax[3];
+	for(auto& bounds : mTriangleBounds)
+	{
+		GetCellRange(bounds, cellMin, cellMax);
+		for(int z = cellMin[2]; z <= cellMax[2]; ++z)
+		{
+			for(int y = cellMin[1]; y <= cellMax[1]; ++y)
+			{
+				for(int x = cellMin[0]; x <= cellMax[0]; ++x)
+				{
+					++mCellStarts[GetCellIndex(x, y, z) + 1];
+				}
+			}
+		}
+	}
+	for(int i = 0; i < cellCount; ++i)
+	{
+		mCellStarts[i + 1] += mCellStarts[i];
+	}
+
+	mCellTriangles.resize(mCellStarts[cellCount]);
+	std::vector<int> cellFill(mCellStarts.begin(), mCellStarts.end() - 1);
+	for(int i = 0; i < mTriangles.size(); ++i)
+	{
+		GetCellRange(mTriangleBounds[i], cellMin, cellMax);
+		for(int z = cellMin[2]; z <= cellMax[2]; ++z)
+		{
+			for(int y = cellMin[1]; y <= cellMax[1]; ++y)
+			{
+				for(int x = cellMin[0]; x <= cellMax[0]; ++x)
+				{
+					mCellTriangles[cellFill[GetCellIndex(x, y, z)]++] = i;
+				}
+			}
+		}
+	}
+}
+
+void TriangleGrid::Clear()
+{
+	mTriangles.clear();
+	mTriangleBounds.clear();
+	mBounds = AABB();
+	mCellCounts[0] = mCellCounts[1] = mCellCounts[2] = 0;
+	mCellStarts.clear();
+	mCellTriangles.clear();
+}
+
+void TriangleGrid::Query(const AABB& aabb, std::vector<int>& outIndexes) const
+{
+	outIndexes.clear();
+	if(mTriangles.empty()) { return; }
+
+	int cellMin[3];
+	int cellMax[3];
+	if(!GetCellRange(aabb, cellMin, cellMax)) { return; }
+
+	// Gather triangles from all overlapped cells. Those that don't overlap the box themselves are skipped.
+	Vector3 queryMin = aabb.GetMin();
+	Vector3 queryMax = aabb.GetMax();
+	for(int z = cellMin[2]; z <= cellMax[2]; ++z)
+	{
+		for(int y = cellMin[1]; y <= cellMax[1]; ++y)
+		{
+			for(int x = cellMin[0]; x <= cellMax[0]; ++x)
+			{
+				int cellIndex = GetCellIndex(x, y, z);
+				for(int i = mCellStarts[cellIndex]; i < mCellStarts[cellIndex + 1]; ++i)
+				{
+					int triangleIndex = mCellTriangles[i];
+					Vector3 min = mTriangleBounds[triangleIndex].GetMin();
+					Vector3 max = mTriangleBounds[triangleIndex].GetMax();
+					if(min.x <= queryMax.x && max.x >= queryMin.x &&
+					   min.y <= queryMax.y && max.y >= queryMin.y &&
+					   min.z <= queryMax.z && max.z >= queryMin.z)
+					{
+						outIndexes.push_back(triangleIndex);
+					}
+				}
+			}
+		}
+	}
+
+	// A triangle spanning several cells shows up once per cell.
+	std::sort(outIndexes.begin(), outIndexes.end());
+	outIndexes.erase(std::unique(outIndexes.begin(), outIndexes.end()), outIndexes.end());
+}
+
+bool TriangleGrid::GetCellRange(const AABB& aabb, int* outMin, int* outMax) const
+{
+	Vector3 gridMin = mBounds.GetMin();
+	Vector3 gridMax = mBounds.GetMax();
+	Vector3 min = aabb.GetMin();
+	Vector3 max = aabb.GetMax();
+	for(int axis = 0; axis < 3; ++axis)
+	{
+		// Entirely outside the grid? Then nothing can overlap.
+		if(max[axis] < gridMin[axis] || min[axis] > gridMax[axis]) { return false; }
+
+		outMin[axis] = Math::Clamp(Math::FloorToInt((min[axis] - gridMin[axis]) / mCellSize), 0, mCellCounts[axis] - 1);
+		outMax[axis] = Math::Clamp(Math::FloorToInt((max[axis] - gridMin[axis]) / mCellSize), 0, mCellCounts[axis] - 1);
+	}
+	return true;
+}
@@ -0,0 +1,51 @@
+//
+// TriangleGrid.h
+//
+// Clark Kromenaker
+//
+// A set of triangles, bucketed into a uniform 3D grid of cells.
+// Answers "which triangles might overlap this box?" without looking at every triangle.
+//
+// Good for static collision geometry (like camera bounds), where the grid is built once and queried often.
+//
+#pragma once
+#include <vector>
+
+#include "AABB.h"
+#include "Triangle.h"
+
+class TriangleGrid
+{
+public:
+	// Builds the grid for the given triangles, replacing any existing contents.
+	// Cell size is picked based on the triangles' overall bounds and count.
+	void Build(const std::vector<Triangle>& triangles);
+	void Clear();
+
+	// Finds triangles whose bounds overlap the box. Results are in ascending index order, with no duplicates.
+	// Triangles that are found may still not actually touch the box - only their bounds are checked.
+	void Query(const AABB& aabb, std::vector<int>& outIndexes) const;
+
+	int GetTriangleCount() const { return static_cast<int>(mTriangles.size()); }
+	const Triangle& GetTriangle(int index) const { return mTriangles[index]; }
+
+private:
+	// Limit on cells per axis, to keep memory reasonable for large or oddly-shaped bounds.
+	static const int kMaxCellsPerAxis = 64;
+
+	std::vector<Triangle> mTriangles;
+	std::vector<AABB> mTriangleBounds;
+
+	// Bounds of all triangles, and the size/count of cells dividing it up.
+	AABB mBounds;
+	float mCellSize = 1.0f;
+	int mCellCounts[3] = { 0, 0, 0 };
+
+	// Triangle indexes for each cell, packed together.
+	// Cell N's triangles are mCellTriangles[mCellStarts[N]] up to (not including) mCellTriangles[mCellStarts[N + 1]].
+	std::vector<int> mCellStarts;
+	std::vector<int> mCellTriangles;
+
+	bool GetCellRange(const AABB& aabb, int* outMin, int* outMax) const;
+	int GetCellIndex(int x, int y, int z) const { return (z * mCellCounts[1] + y) * mCellCounts[0] + x; }
+};
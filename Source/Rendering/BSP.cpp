@@ -6,11 +6,14 @@
 #include "BSP.h"
 
 #include <bitset>
+#include <cfloat>
 #include <iostream>
 
 #include "BinaryReader.h"
 #include "BSPActor.h"
 #include "Debug.h"
+#include "Frustum.h"
+#include "RenderStats.h"
 #include "Services.h"
 #include "StringUtil.h"
 #include "Vector2.h"
@@ -31,118 +34,82 @@ BSP::BSP(std::string name, char* data, int dataLength) : Asset(name)
 
 bool BSP::RaycastNearest(const Ray& ray, RaycastHit& outHitInfo)
 {
-	// Values for tracking closest found hit.
-    outHitInfo.t = FLT_MAX;
-    std::string* closest = nullptr;
-	
-	// Iterate through all polygons in the BSP and see if the ray intersects
-	// with any triangles inside the polygon. Triangles within the BSP are made
-	// up of "triangle fans", so the first vertex in a polygon is shared by all triangles.
-    for(auto& polygon : mPolygons)
-    {
-        BSPSurface& surface = mSurfaces[polygon.surfaceIndex];
-        if(!surface.interactive) { continue; }
-		
-        Vector3 p0 = mVertices[mVertexIndices[polygon.vertexIndexOffset]];
-        for(int i = 1; i < polygon.vertexIndexCount - 1; i++)
-        {
-            Vector3 p1 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i]];
-            Vector3 p2 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i + 1]];
-			RaycastHit hitInfo;
-			if(Collisions::TestRayTriangle(ray, p0, p1, p2, hitInfo))
-            {
-                if(hitInfo.t < outHitInfo.t)
-                {
-					// Save closest distance.
-                    outHitInfo.t = hitInfo.t;
-                    
-                    // Find surface for this polygon, and then name for the surface.
-                    closest = &mObjectNames[surface.objectIndex];
-                }
-            }
-        }
-    }
-	
-	// If no closest object was found, no hits occurred. Early out.
-	if(closest == nullptr) { return false; }
+	int objectIndex = -1;
+	return RaycastNearest(ray, outHitInfo, objectIndex);
+}
+
+bool BSP::RaycastNearest(const Ray& ray, RaycastHit& outHitInfo, int& outObjectIndex)
+{
+	// Find closest hit on any interactive surface.
+	float nearestT = FLT_MAX;
+	int nearestTriangleIndex = -1;
+	if(!RaycastInteractive(ray, -1, nearestT, nearestTriangleIndex)) { return false; }
 	
-	// Otherwise, fill in out hit info and return.
-	outHitInfo.name = *closest;
+	// Fill in hit info with name of object the triangle belongs to.
+	BSPSurface& surface = mSurfaces[mPolygons[mTrianglePolygonIndexes[nearestTriangleIndex]].surfaceIndex];
+	outHitInfo.t = nearestT;
+	outHitInfo.point = ray.GetPoint(nearestT);
+	outHitInfo.name = mObjectNames[surface.objectIndex];
+	outObjectIndex = surface.objectIndex;
 	return true;
 }
 
 bool BSP::RaycastSingle(const Ray& ray, std::string name, RaycastHit& outHitInfo)
 {
-	for(auto& polygon : mPolygons)
+	// We're only interested in intersections with a certain object (or objects, if the name is used more than once).
+	float nearestT = FLT_MAX;
+	int nearestTriangleIndex = -1;
+	for(int i = 0; i < mObjectNames.size(); i++)
 	{
-		// We're only interested in intersections with a certain object.
-		// So, if this isn't the object, we can continue!
-        BSPSurface& surface = mSurfaces[polygon.surfaceIndex];
-        if(mObjectNames[surface.objectIndex] != name) { continue; }
-        if(!surface.interactive) { continue; }
-		
-        Vector3 p0 = mVertices[mVertexIndices[polygon.vertexIndexOffset]];
-        for(int i = 1; i < polygon.vertexIndexCount - 1; i++)
+		if(mObjectNames[i] == name)
 		{
-            Vector3 p1 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i]];
-            Vector3 p2 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i + 1]];
-			if(Collisions::TestRayTriangle(ray, p0, p1, p2, outHitInfo))
-			{
-				// Save name of hit object.
-				outHitInfo.name = name;
-				return true;
-			}
+			RaycastInteractive(ray, i, nearestT, nearestTriangleIndex);
 		}
 	}
 	
 	// Couldn't find the given name, or ray didn't intersect object with given name.
-	return false;
+	if(nearestTriangleIndex < 0) { return false; }
+	
+	outHitInfo.t = nearestT;
+	outHitInfo.point = ray.GetPoint(nearestT);
+	outHitInfo.name = name;
+	return true;
 }
 
 std::vector<RaycastHit> BSP::RaycastAll(const Ray& ray)
 {
 	std::vector<RaycastHit> hits;
-	
-	// Iterate through all polygons in the BSP and see if the ray intersects
-	// with any triangles inside the polygon. Triangles within the BSP are made
-	// up of "triangle fans", so the first vertex in a polygon is shared by all triangles.
 	for(auto& polygon : mPolygons)
 	{
         BSPSurface& surface = mSurfaces[polygon.surfaceIndex];
         if(!surface.interactive) { continue; }
 		
-        Vector3 p0 = mVertices[mVertexIndices[polygon.vertexIndexOffset]];
-        for(int i = 1; i < polygon.vertexIndexCount - 1; i++)
+		// Every triangle hit counts, so test them one at a time.
+		int end = polygon.triangleOffset + GetTriangleCount(polygon);
+		for(int i = polygon.triangleOffset; i < end; i++)
 		{
-            Vector3 p1 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i]];
-            Vector3 p2 = mVertices[mVertexIndices[polygon.vertexIndexOffset + i + 1]];
 			RaycastHit hitInfo;
-			if(Collisions::TestRayTriangle(ray, p0, p1, p2, hitInfo))
+			int triangleIndex = -1;
+			if(mRaycastTriangles.Raycast(ray, i, i + 1, hitInfo.t, triangleIndex))
 			{
-				// Save hit object name.
+                hitInfo.point = ray.GetPoint(hitInfo.t);
                 hitInfo.name = mObjectNames[surface.objectIndex];
-				
-				// Add to hit info vector.
 				hits.push_back(hitInfo);
 			}
 		}
 	}
-
-	// Return vector of hits.
 	return hits;
 }
 
 bool BSP::RaycastPolygon(const Ray& ray, const BSPPolygon* polygon, RaycastHit& outHitInfo)
 {
-	Vector3 p0 = mVertices[mVertexIndices[polygon->vertexIndexOffset]];
-	for(int i = 1; i < polygon->vertexIndexCount - 1; i++)
+	float t = FLT_MAX;
+	int triangleIndex = -1;
+	if(mRaycastTriangles.Raycast(ray, polygon->triangleOffset, polygon->triangleOffset + GetTriangleCount(*polygon), t, triangleIndex))
 	{
-		Vector3 p1 = mVertices[mVertexIndices[polygon->vertexIndexOffset + i]];
-		Vector3 p2 = mVertices[mVertexIndices[polygon->vertexIndexOffset + i + 1]];
-		if(Collisions::TestRayTriangle(ray, p0, p1, p2, outHitInfo))
-		{
-			return true;
-		}
+		outHitInfo.t = t;
+		outHitInfo.point = ray.GetPoint(t);
+		return true;
 	}
 	return false;
 }
@@ -162,7 +129,7 @@ BSPActor* BSP::CreateBSPActor(const std::string& objectName)
 	if(objectIndex == -1) { return nullptr; }
 	
 	// OK, we found it! Create the actor.
-	BSPActor* actor = new BSPActor(this, objectName);
+	BSPActor* actor = new BSPActor(this, objectIndex, objectName);
 	
 	// Generate AABB from this BSP object's position data.
 	bool firstPoint = true;
@@ -355,7 +322,7 @@ void BSP::ApplyLightmap(const BSPLightmap& lightmap)
 int renderedPolygonCount = 0;
 int treeDepth = 0;
 
-void BSP::RenderOpaque(const Vector3& cameraPosition, const Vector3& cameraDirection)
+void BSP::RenderOpaque(const Vector3& cameraPosition, const Vector3& cameraDirection, const Frustum& frustum)
 {
     // Activate material for rendering.
     mMaterial.Activate(Matrix4::Identity);
@@ -365,7 +332,7 @@ void BSP::RenderOpaque(const Vector3& cameraPosition, const Vector3& cameraDirec
     treeDepth = 0;
     
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    RenderTree(mNodes[mRootNodeIndex], cameraPosition, cameraDirection);
+    RenderTree(mNodes[mRootNodeIndex], cameraPosition, cameraDirection, frustum);
     //glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     
     //std::cout << "Rendered " << renderedPolygonCount << " polygons." << std::endl;
@@ -382,15 +349,18 @@ void BSP::RenderTranslucent()
     mAlphaPolygons = nullptr;
 }
 
-void BSP::RenderTree(const BSPNode& node, const Vector3& cameraPosition, const Vector3& cameraDirection)
+void BSP::RenderTree(const BSPNode& node, const Vector3& cameraPosition, const Vector3& cameraDirection, const Frustum& frustum)
 {
+    // If nothing in this subtree is within the view frustum, none of it needs to be rendered.
+    if(!node.bounds.IsValid() || !frustum.IntersectsAABB(node.bounds))
+    {
+        ++RenderStats::sCurrent.culledBSPNodeCount;
+        return;
+    }
+    
     // Check signed distance of point to plane to determine if point is in front of, behind, or on the plane.
     float signedDistance = mPlanes[node.planeIndex].GetSignedDistance(cameraPosition);
     
-    // Based on camera position/facing direction, we can sometimes avoid rendering entire parts of the BSP tree.
-    //TODO: Maybe base this on the camera's FOV rather than hardcoding?
-    const float kCameraFacingDot = 0.9f;
-    
     // Determine render order for this node.
     // This makes a "front-to-back" renderer, resulting in no overdraw for opaque rendering.
     bool renderCurrent = true;
@@ -408,33 +378,19 @@ void BSP::RenderTree(const BSPNode& node, const Vector3& cameraPosition, const V
         // Point is in front of plane - render front, then back trees.
         firstNodeIndex = node.frontChildIndex;
         secondNodeIndex = node.backChildIndex;
-        
-        // If in front of plane AND facing away from plane, there's no need to render the back at all.
-        float dot = Vector3::Dot(mPlanes[node.planeIndex].normal, cameraDirection);
-        if(dot > kCameraFacingDot)
-        {
-            secondNodeIndex = -1;
-        }
     }
     else
     {
         // Point is behind plane - render back, then front trees.
         firstNodeIndex = node.backChildIndex;
         secondNodeIndex = node.frontChildIndex;
-        
-        // If behind plane AND facing away from plane, there's no need to render the front at all.
-        float dot = Vector3::Dot(mPlanes[node.planeIndex].normal, cameraDirection);
-        if(dot < -kCameraFacingDot)
-        {
-            secondNodeIndex = -1;
-        }
     }
     
     // Render first tree.
     if(firstNodeIndex >= 0 && firstNodeIndex < mNodes.size())
     {
         ++treeDepth;
-        RenderTree(mNodes[firstNodeIndex], cameraPosition, cameraDirection);
+        RenderTree(mNodes[firstNodeIndex], cameraPosition, cameraDirection, frustum);
         --treeDepth;
     }
     
@@ -480,7 +436,7 @@ void BSP::RenderTree(const BSPNode& node, const Vector3& cameraPosition, const V
     if(secondNodeIndex >= 0 && secondNodeIndex < mNodes.size())
     {
         ++treeDepth;
-        RenderTree(mNodes[secondNodeIndex], cameraPosition, cameraDirection);
+        RenderTree(mNodes[secondNodeIndex], cameraPosition, cameraDirection, frustum);
         --treeDepth;
     }
 }
@@ -523,7 +479,8 @@ void BSP::RenderPolygon(BSPPolygon& polygon, bool translucent)
                           surface.lightmapUvScale.y,
                           surface.lightmapUvOffset.x,
                           surface.lightmapUvOffset.y);
-    mMaterial.GetShader()->SetUniformVector4("uLightmapScaleOffset", lightmapUvScaleOffset);
+    static constexpr UniformId kLightmapScaleOffsetId = HashUniformName("uLightmapScaleOffset");
+    mMaterial.GetShader()->SetUniformVector4(kLightmapScaleOffsetId, lightmapUvScaleOffset);
     
     /*
     if((surface.flags & BSPSurface::kUnknownFlag7) != 0)
@@ -579,6 +536,10 @@ void BSP::ParseFromData(char *data, int dataLength)
         surface.objectIndex = reader.ReadUInt();
         
         surface.texture = Services::GetAssets()->LoadTexture(reader.ReadString(32));
+        if(surface.texture != nullptr)
+        {
+            surface.texture->SetStatic(true);
+        }
         
         surface.lightmapUvOffset = reader.ReadVector2();
         surface.lightmapUvScale = reader.ReadVector2();
@@ -735,4 +696,96 @@ void BSP::ParseFromData(char *data, int dataLength)
     
     // Create vertex array.
     mVertexArray = VertexArray(meshDefinition);
+    
+    // Calculate bounds for each node in the tree, for use in frustum culling.
+    if(mRootNodeIndex < mNodes.size())
+    {
+        CalculateNodeBounds(mRootNodeIndex);
+    }
+    
+    BuildRaycastTriangles();
+}
+
+void BSP::BuildRaycastTriangles()
+{
+    // Unpack each polygon's triangle fan, so raycasts don't need to go through the index array.
+    int triangleCount = 0;
+    for(auto& polygon : mPolygons)
+    {
+        triangleCount += GetTriangleCount(polygon);
+    }
+    mRaycastTriangles.Reserve(triangleCount);
+    mTrianglePolygonIndexes.reserve(triangleCount);
+    
+    for(int i = 0; i < mPolygons.size(); i++)
+    {
+        BSPPolygon& polygon = mPolygons[i];
+        polygon.triangleOffset = mRaycastTriangles.GetTriangleCount();
+        
+        // Fans share the first vertex in every triangle.
+        int count = GetTriangleCount(polygon);
+        const Vector3& p0 = mVertices[mVertexIndices[polygon.vertexIndexOffset]];
+        for(int j = 1; j <= count; j++)
+        {
+            const Vector3& p1 = mVertices[mVertexIndices[polygon.vertexIndexOffset + j]];
+            const Vector3& p2 = mVertices[mVertexIndices[polygon.vertexIndexOffset + j + 1]];
+            mRaycastTriangles.Add(p0, p1, p2);
+            mTrianglePolygonIndexes.push_back(i);
+        }
+    }
+}
+
+bool BSP::RaycastInteractive(const Ray& ray, int objectIndex, float& outT, int& outTriangleIndex)
+{
+    // Polygons' triangles are stored back-to-back, so each run of polygons that can be hit is tested in one go.
+    // An objectIndex of -1 means any object.
+    bool hit = false;
+    int runStart = 0;
+    for(auto& polygon : mPolygons)
+    {
+        const BSPSurface& surface = mSurfaces[polygon.surfaceIndex];
+        if(!surface.interactive || (objectIndex >= 0 && surface.objectIndex != objectIndex))
+        {
+            hit |= mRaycastTriangles.Raycast(ray, runStart, polygon.triangleOffset, outT, outTriangleIndex);
+            runStart = polygon.triangleOffset + GetTriangleCount(polygon);
+        }
+    }
+    hit |= mRaycastTriangles.Raycast(ray, runStart, mRaycastTriangles.GetTriangleCount(), outT, outTriangleIndex);
+    return hit;
+}
+
+const AABB& BSP::CalculateNodeBounds(int nodeIndex)
+{
+    BSPNode& node = mNodes[nodeIndex];
+    
+    // Start with an empty (invalid) AABB, so the first contained point defines it.
+    node.bounds = AABB(Vector3(FLT_MAX, FLT_MAX, FLT_MAX), Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+    
+    // Contain all vertices of both polygon sets in this node.
+    unsigned short polygonIndexes[2] = { node.polygonIndex, node.polygonIndex2 };
+    unsigned short polygonCounts[2] = { node.polygonCount, node.polygonCount2 };
+    for(int set = 0; set < 2; ++set)
+    {
+        if(polygonIndexes[set] == 65535) { continue; }
+        for(int i = polygonIndexes[set]; i < polygonIndexes[set] + polygonCounts[set] && i < mPolygons.size(); ++i)
+        {
+            int start = mPolygons[i].vertexIndexOffset;
+            int end = start + mPolygons[i].vertexIndexCount;
+            for(int k = start; k < end && k < mVertexIndices.size(); ++k)
+            {
+                node.bounds.GrowToContain(mVertices[mVertexIndices[k]]);
+            }
+        }
+    }
+    
+    // Contain children's bounds.
+    if(node.frontChildIndex < mNodes.size())
+    {
+        node.bounds.GrowToContain(CalculateNodeBounds(node.frontChildIndex));
+    }
+    if(node.backChildIndex < mNodes.size())
+    {
+        node.bounds.GrowToContain(CalculateNodeBounds(node.backChildIndex));
+    }
+    return node.bounds;
 }
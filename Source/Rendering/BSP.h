@@ -12,16 +12,19 @@
 #include <unordered_map>
 #include <vector>
 
+#include "AABB.h"
 #include "Material.h"
 #include "Mesh.h"
 #include "Plane.h"
 #include "Ray.h"
 #include "Collisions.h"
+#include "TriangleBatch.h"
 #include "Vector2.h"
 #include "Vector3.h"
 
 class BSPActor;
 class BSPLightmap;
+class Frustum;
 class Texture;
 
 // A node in the BSP tree.
@@ -46,6 +49,11 @@ struct BSPNode
     // These appear to be used for rendering 2-sided polygons (though I haven't totally figured that out yet).
     unsigned short polygonIndex2;
     unsigned short polygonCount2;
+    
+    // Bounds of all polygons in this node and its children.
+    // Calculated after load, and used to cull entire subtrees that are outside the view frustum.
+    // Invalid if the subtree has no polygons.
+    AABB bounds;
 };
 
 // A polygon is made up of at least three vertices and can be rendered.
@@ -59,6 +67,10 @@ struct BSPPolygon
     // These are an offset + count into the index array, defining what vertices make up this polygon.
     unsigned short vertexIndexOffset;
     unsigned short vertexIndexCount;
+    
+    // Polygons are triangle fans - this is the index of the first triangle in the BSP's raycast triangles.
+    // The polygon has (vertexIndexCount - 2) triangles.
+    int triangleOffset = 0;
 	
 	// Used for creating a linked list of alpha surfaces.
     BSPPolygon* next = nullptr;
@@ -110,6 +122,7 @@ public:
 	BSPActor* CreateBSPActor(const std::string& objectName);
 	
     bool RaycastNearest(const Ray& ray, RaycastHit& outHitInfo);
+    bool RaycastNearest(const Ray& ray, RaycastHit& outHitInfo, int& outObjectIndex);
 	bool RaycastSingle(const Ray& ray, std::string name, RaycastHit& outHitInfo);
 	std::vector<RaycastHit> RaycastAll(const Ray& ray);
 	bool RaycastPolygon(const Ray& ray, const BSPPolygon* polygon, RaycastHit& outHitInfo);
@@ -124,7 +137,7 @@ public:
     
     void ApplyLightmap(const BSPLightmap& lightmap);
     
-    void RenderOpaque(const Vector3& cameraPosition, const Vector3& cameraDirection);
+    void RenderOpaque(const Vector3& cameraPosition, const Vector3& cameraDirection, const Frustum& frustum);
     void RenderTranslucent();
 	
 private:
@@ -160,14 +173,24 @@ private:
     // Vertex indices for BSP mesh.
     std::vector<unsigned short> mVertexIndices;
     
+    // Every polygon's triangles, in polygon order, laid out for fast raycasts.
+    // Also, the index of the polygon each triangle came from.
+    TriangleBatch mRaycastTriangles;
+    std::vector<int> mTrianglePolygonIndexes;
+    
     // Vertex array is loaded up with vertices/uvs/indices to perform rendering.
     VertexArray mVertexArray;
     
     // Material for rendering BSP.
 	Material mMaterial;
     
-    void RenderTree(const BSPNode& node, const Vector3& cameraPosition, const Vector3& cameraDirection);
+    void RenderTree(const BSPNode& node, const Vector3& cameraPosition, const Vector3& cameraDirection, const Frustum& frustum);
     void RenderPolygon(BSPPolygon& polygon, bool translucent);
     
+    int GetTriangleCount(const BSPPolygon& polygon) const { return polygon.vertexIndexCount > 2 ? polygon.vertexIndexCount - 2 : 0; }
+    bool RaycastInteractive(const Ray& ray, int objectIndex, float& outT, int& outTriangleIndex);
+    
     void ParseFromData(char* data, int dataLength);
+    void BuildRaycastTriangles();
+    const AABB& CalculateNodeBounds(int nodeIndex);
 };
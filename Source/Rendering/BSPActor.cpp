@@ -5,8 +5,9 @@
 //
 #include "BSPActor.h"
 
-BSPActor::BSPActor(BSP* bsp, const std::string& name) : GKObject(),
+BSPActor::BSPActor(BSP* bsp, int objectIndex, const std::string& name) : GKObject(),
 	mBSP(bsp),
+	mObjectIndex(objectIndex),
 	mName(name)
 {
 	
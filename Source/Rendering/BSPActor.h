@@ -17,12 +17,14 @@
 class BSPActor : public GKObject
 {
 public:
-	BSPActor(BSP* bsp, const std::string& name);
+	BSPActor(BSP* bsp, int objectIndex, const std::string& name);
 	
 	void AddSurface(BSPSurface* surface) { mSurfaces.push_back(surface); }
 	void AddPolygon(BSPPolygon* polygon) { mPolygons.push_back(polygon); }
 	void SetAABB(const AABB& aabb) { mAABB = aabb; }
+	const AABB& GetAABB() const { return mAABB; }
 	
+	int GetObjectIndex() const { return mObjectIndex; }
 	const std::string& GetName() const { return mName; }
 	
 	void SetVisible(bool visible);
@@ -39,7 +41,8 @@ private:
 	// The BSP this actor was created from.
 	BSP* mBSP = nullptr;
 	
-	// The name of the object in the BSP.
+	// The index and name of the object in the BSP.
+	int mObjectIndex = -1;
 	std::string mName;
 	
 	// An AABB around the BSP geometry that makes up the object.
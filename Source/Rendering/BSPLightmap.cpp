@@ -33,6 +33,7 @@ BSPLightmap::BSPLightmap(std::string name, char* data, int dataLength) :
         Texture* texture = new Texture(reader);
         texture->SetFilterMode(Texture::FilterMode::Bilinear);
         texture->SetWrapMode(Texture::WrapMode::Clamp);
+        texture->SetStatic(true);
         mLightmapTextures.push_back(texture);
     }
     
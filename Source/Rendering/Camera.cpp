@@ -18,20 +18,23 @@ Camera::Camera(Actor* owner) : Component(owner)
 
 Matrix4 Camera::GetLookAtMatrix()
 {
-    Vector3 eye = GetOwner()->GetPosition();
+    // Camera view is from between the last two simulation steps, to match what's rendered.
+    const Matrix4& cameraToWorld = GetOwner()->GetTransform()->GetInterpolatedLocalToWorldMatrix();
+    Vector3 eye = cameraToWorld.TransformPoint(Vector3::Zero);
     
     // World space axes directions are all a matter of perspective.
     // Here, we say that view forward equals Actor forward (mapped to Z axis).
     // And view up equals Actor up (mapped to Y axis).
-    Vector3 lookAt = eye + GetOwner()->GetForward();
-    Vector3 up = GetOwner()->GetUp();
+    Vector3 lookAt = eye + cameraToWorld.TransformVector(Vector3::UnitZ);
+    Vector3 up = cameraToWorld.TransformVector(Vector3::UnitY);
     return RenderTransforms::MakeLookAt(eye, lookAt, up);
 }
 
 Matrix4 Camera::GetLookAtMatrixNoTranslate()
 {
-    Vector3 lookAt = GetOwner()->GetForward();
-    Vector3 up = GetOwner()->GetUp();
+    const Matrix4& cameraToWorld = GetOwner()->GetTransform()->GetInterpolatedLocalToWorldMatrix();
+    Vector3 lookAt = cameraToWorld.TransformVector(Vector3::UnitZ);
+    Vector3 up = cameraToWorld.TransformVector(Vector3::UnitY);
 	return RenderTransforms::MakeLookAt(Vector3::Zero, lookAt, up);
 }
 
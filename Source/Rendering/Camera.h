@@ -29,6 +29,9 @@ public:
 	void SetCameraFovRadians(float fovRad);
 	void SetCameraFovDegrees(float fovDeg);
 	
+	float GetNearClipPlane() const { return mNearClipPlane; }
+	float GetFarClipPlane() const { return mFarClipPlane; }
+	
 private:
     // Field of view angle, in radians, for perspective projection.
     float mFovAngleRad = 1.0472f;
@@ -5,6 +5,8 @@
 //
 #include "Material.h"
 
+#include <cstring>
+
 #include "Matrix4.h"
 #include "Shader.h"
 #include "Texture.h"
@@ -17,14 +19,30 @@ Matrix4 Material::sCurrentProjMatrix;
 
 float Material::sAlphaTestValue = 0.0f;
 
+GLuint Material::sGlobalUniformBuffer = GL_NONE;
+bool Material::sGlobalUniformsDirty = true;
+
+// Built-in uniform IDs, hashed at compile time.
+static constexpr UniformId kObjectToWorldMatrixId = HashUniformName("gObjectToWorldMatrix");
+static constexpr UniformId kAlphaTestId = HashUniformName("gAlphaTest");
+
 void Material::SetViewMatrix(const Matrix4& viewMatrix)
 {
-	sCurrentViewMatrix = viewMatrix;
+	// Compare exactly (not with epsilon) so that even tiny camera changes are uploaded.
+	if(memcmp(sCurrentViewMatrix, viewMatrix, sizeof(float) * 16) != 0)
+	{
+		sCurrentViewMatrix = viewMatrix;
+		sGlobalUniformsDirty = true;
+	}
 }
 
 void Material::SetProjMatrix(const Matrix4& projMatrix)
 {
-	sCurrentProjMatrix = projMatrix;
+	if(memcmp(sCurrentProjMatrix, projMatrix, sizeof(float) * 16) != 0)
+	{
+		sCurrentProjMatrix = projMatrix;
+		sGlobalUniformsDirty = true;
+	}
 }
 
 void Material::UseAlphaTest(bool use)
@@ -48,19 +66,28 @@ void Material::Activate(const Matrix4& objectToWorldMatrix)
     // See https://stackoverflow.com/questions/42357380/why-must-i-use-a-shader-program-before-i-can-set-its-uniforms
     mShader->Activate();
     
-	// Set built-in transform matrices.
-    mShader->SetUniformMatrix4("gObjectToWorldMatrix", objectToWorldMatrix);
-    mShader->SetUniformMatrix4("gViewMatrix", sCurrentViewMatrix);
-    mShader->SetUniformMatrix4("gProjMatrix", sCurrentProjMatrix);
-	mShader->SetUniformMatrix4("gWorldToProjMatrix", sCurrentProjMatrix * sCurrentViewMatrix);
+    // View/proj matrices are shared by all shaders via uniform buffer; update it if they've changed.
+    if(sGlobalUniformsDirty)
+    {
+        UploadGlobalUniforms();
+    }
+    
+	// Set built-in object transform matrix.
+    mShader->SetUniformMatrix4(kObjectToWorldMatrixId, objectToWorldMatrix);
 	
 	// Set built-in alpha test value.
-	mShader->SetUniformFloat("gAlphaTest", sAlphaTestValue);
+	mShader->SetUniformFloat(kAlphaTestId, sAlphaTestValue);
 	
     // Set user-defined color values.
     for(auto& entry : mColors)
     {
-        mShader->SetUniformColor(entry.first.c_str(), entry.second);
+        mShader->SetUniformColor(entry.first, entry.second);
+    }
+    
+    // Set user-defined float values.
+    for(auto& entry : mFloats)
+    {
+        mShader->SetUniformFloat(entry.first, entry.second);
     }
     
     // Set user-defined textures.
@@ -69,7 +96,7 @@ void Material::Activate(const Matrix4& objectToWorldMatrix)
     {
         if(entry.second != nullptr)
         {
-            mShader->SetUniformInt(entry.first.c_str(), textureUnit);
+            mShader->SetUniformInt(entry.first, textureUnit);
             entry.second->Activate(textureUnit);
             ++textureUnit;
         }
@@ -78,22 +105,53 @@ void Material::Activate(const Matrix4& objectToWorldMatrix)
 	//TODO: May need to "deactivate" texture units if no texture is defined in material, but a texture sampler exists in the shader.
 }
 
-void Material::SetColor(const std::string& name, const Color32& color)
+void Material::SetColor(UniformId id, const Color32& color)
 {
-    mColors[name] = color;
+    for(auto& entry : mColors)
+    {
+        if(entry.first == id)
+        {
+            entry.second = color;
+            return;
+        }
+    }
+    mColors.push_back(std::make_pair(id, color));
 }
 
-void Material::SetTexture(const std::string& name, Texture* texture)
+void Material::SetFloat(UniformId id, float value)
 {
-    mTextures[name] = texture;
+    for(auto& entry : mFloats)
+    {
+        if(entry.first == id)
+        {
+            entry.second = value;
+            return;
+        }
+    }
+    mFloats.push_back(std::make_pair(id, value));
 }
 
-Texture* Material::GetTexture(const std::string& name) const
+void Material::SetTexture(UniformId id, Texture* texture)
 {
-    auto it = mTextures.find(name);
-    if(it != mTextures.end())
+    for(auto& entry : mTextures)
     {
-        return it->second;
+        if(entry.first == id)
+        {
+            entry.second = texture;
+            return;
+        }
+    }
+    mTextures.push_back(std::make_pair(id, texture));
+}
+
+Texture* Material::GetTexture(UniformId id) const
+{
+    for(auto& entry : mTextures)
+    {
+        if(entry.first == id)
+        {
+            return entry.second;
+        }
     }
     return nullptr;
 }
@@ -103,3 +161,28 @@ bool Material::IsTranslucent()
 	//TODO: Maybe use render queue value for this?
 	return false;
 }
+
+/*static*/ void Material::UploadGlobalUniforms()
+{
+    // Layout matches the std140 "GlobalUniforms" block declared in shaders:
+    // view matrix, projection matrix, world-to-projection matrix.
+    Matrix4 matrices[3];
+    matrices[0] = sCurrentViewMatrix;
+    matrices[1] = sCurrentProjMatrix;
+    matrices[2] = sCurrentProjMatrix * sCurrentViewMatrix;
+    
+    if(sGlobalUniformBuffer == GL_NONE)
+    {
+        // Create the buffer on first use, when we know a GL context exists.
+        glGenBuffers(1, &sGlobalUniformBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, sGlobalUniformBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(matrices), matrices, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, Shader::kGlobalUniformsBinding, sGlobalUniformBuffer);
+    }
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, sGlobalUniformBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(matrices), matrices);
+    }
+    sGlobalUniformsDirty = false;
+}
@@ -7,13 +7,16 @@
 // It indicates the shader to use and any input parameters for the shader (texture, color, etc).
 //
 #pragma once
-#include <unordered_map>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <GL/glew.h>
+
 #include "Color32.h"
 #include "Matrix4.h"
+#include "Shader.h"
 
-class Shader;
 class Texture;
 
 class Material
@@ -32,17 +35,23 @@ public:
     void SetShader(Shader* shader) { mShader = shader; }
     Shader* GetShader() const { return mShader; }
     
-    void SetColor(const std::string& name, const Color32& color);
+    void SetColor(const std::string& name, const Color32& color) { SetColor(HashUniformName(name.c_str()), color); }
+    void SetColor(UniformId id, const Color32& color);
     //GetColor
     
-    void SetTexture(const std::string& name, Texture* texture);
-    Texture* GetTexture(const std::string& name) const;
+    void SetFloat(const std::string& name, float value) { SetFloat(HashUniformName(name.c_str()), value); }
+    void SetFloat(UniformId id, float value);
+    
+    void SetTexture(const std::string& name, Texture* texture) { SetTexture(HashUniformName(name.c_str()), texture); }
+    void SetTexture(UniformId id, Texture* texture);
+    Texture* GetTexture(const std::string& name) const { return GetTexture(HashUniformName(name.c_str())); }
+    Texture* GetTexture(UniformId id) const;
     
     // Helpers for setting/getting frequently accessed shader uniforms.
-    void SetColor(const Color32& color) { SetColor("uColor", color); }
+    void SetColor(const Color32& color) { SetColor(HashUniformName("uColor"), color); }
     
-    void SetDiffuseTexture(Texture* texture) { SetTexture("uDiffuse", texture); }
-    Texture* GetDiffuseTexture() const { return GetTexture("uDiffuse"); }
+    void SetDiffuseTexture(Texture* texture) { SetTexture(HashUniformName("uDiffuse"), texture); }
+    Texture* GetDiffuseTexture() const { return GetTexture(HashUniformName("uDiffuse")); }
     
 	bool IsTranslucent();
 	
@@ -51,11 +60,20 @@ private:
 	static Matrix4 sCurrentProjMatrix;
 	static float sAlphaTestValue;
 	
+	// Uniform buffer holding view/proj matrices, shared by all shaders.
+	// Only re-uploaded when the view or projection actually changes.
+	static GLuint sGlobalUniformBuffer;
+	static bool sGlobalUniformsDirty;
+	static void UploadGlobalUniforms();
+	
     // Shader to use.
     Shader* mShader = nullptr;
     
-    std::unordered_map<std::string, Color32> mColors;
-    std::unordered_map<std::string, Texture*> mTextures;
+    // User-defined uniform values, keyed by uniform ID.
+    // Materials only have a few of these, so vectors are faster to iterate and search than maps.
+    std::vector<std::pair<UniformId, Color32>> mColors;
+    std::vector<std::pair<UniformId, float>> mFloats;
+    std::vector<std::pair<UniformId, Texture*>> mTextures;
     
     //TODO: Opaque vs. transparent? Render queue value?
 };
@@ -47,20 +47,19 @@ Submesh* Mesh::AddSubmesh(const MeshDefinition& meshDefinition)
 bool Mesh::Raycast(const Ray& ray, RaycastHit& hitInfo)
 {
 	// Check against Mesh's AABB to see if we hit it.
-	if(Collisions::TestRayAABB(ray, mAABB, hitInfo))
+	RaycastHit aabbHitInfo;
+	if(mHasAABB && !Collisions::TestRayAABB(ray, mAABB, aabbHitInfo))
 	{
-		// If hit the AABB, do a per-triangle check as well for more precise detection.
-		// For example, Gabe's AABBs are pretty rough, so you can select him when clicking nowhere near him (a foot left of his arm).
-		// This isn't how the original game works, so I think they must do a per-triangle check as well.
-		for(auto& submesh : mSubmeshes)
-		{
-			if(submesh->Raycast(ray))
-			{
-				return true;
-			}
-		}
+		return false;
 	}
 	
-	// Either didn't hit AABB or did hit AABB, but failed triangle test.
-	return false;
+	// If hit the AABB, do a per-triangle check as well for more precise detection.
+	// For example, Gabe's AABBs are pretty rough, so you can select him when clicking nowhere near him (a foot left of his arm).
+	// This isn't how the original game works, so I think they must do a per-triangle check as well.
+	bool hit = false;
+	for(auto& submesh : mSubmeshes)
+	{
+		hit |= submesh->Raycast(ray, hitInfo);
+	}
+	return hit;
 }
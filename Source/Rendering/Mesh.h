@@ -30,11 +30,15 @@ public:
 	void Render(unsigned int submeshIndex);
 	void Render(unsigned int submeshIndex, unsigned int offset, unsigned int count);
     
-    void SetMeshToLocalMatrix(const Matrix4& mat) { mMeshToLocalMatrix = mat; }
-    Matrix4& GetMeshToLocalMatrix() { return mMeshToLocalMatrix; }
+    void SetMeshToLocalMatrix(const Matrix4& mat) { mMeshToLocalMatrix = mat; ++mMeshToLocalChangeCount; }
+    const Matrix4& GetMeshToLocalMatrix() const { return mMeshToLocalMatrix; }
+    
+    // Goes up every time the mesh->local matrix changes, so anything derived from it can tell when to recalculate.
+    unsigned int GetMeshToLocalChangeCount() const { return mMeshToLocalChangeCount; }
 	
-	void SetAABB(const AABB& aabb) { mAABB = aabb; }
+	void SetAABB(const AABB& aabb) { mAABB = aabb; mHasAABB = true; }
 	const AABB& GetAABB() const { return mAABB; }
+	bool HasAABB() const { return mHasAABB; }
 	
     Submesh* AddSubmesh(const MeshDefinition& meshDefinition);
     
@@ -43,6 +47,7 @@ public:
 	
 	const std::vector<Submesh*>& GetSubmeshes() const { return mSubmeshes; }
 	
+	// Finds the nearest triangle hit by a mesh space ray, if closer than hitInfo.t.
 	bool Raycast(const Ray& ray, RaycastHit& hitInfo);
 	
 private:
@@ -53,7 +58,10 @@ private:
 	// and Submesh vertices are relative to the Mesh coordinate system.
 	// This matrix represents the Mesh's coordinate system and can be used to transform from mesh space to parent space.
     Matrix4 mMeshToLocalMatrix;
+    unsigned int mMeshToLocalChangeCount = 0;
 	
 	// An AABB for the mesh, in its own local space.
+	// Meshes created in code may not have one - those can't be culled.
 	AABB mAABB;
+	bool mHasAABB = false;
 };
@@ -6,9 +6,11 @@
 #include "MeshRenderer.h"
 
 #include "Actor.h"
+#include "Collisions.h"
 #include "Debug.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "Services.h"
 #include "Texture.h"
 
@@ -16,20 +18,16 @@ TYPE_DEF_CHILD(Component, MeshRenderer);
 
 MeshRenderer::MeshRenderer(Actor* owner) : Component(owner)
 {
-    Services::GetRenderer()->AddMeshRenderer(this);
-}
-
-MeshRenderer::~MeshRenderer()
-{
-    Services::GetRenderer()->RemoveMeshRenderer(this);
+    
 }
 
-void MeshRenderer::RenderOpaque()
+void MeshRenderer::RenderOpaque(RenderQueue& queue)
 {
 	// Don't render if actor is inactive or component is disabled.
 	if(!IsActiveAndEnabled()) { return; }
 	
-	Matrix4 actorWorldTransform = GetOwner()->GetTransform()->GetLocalToWorldMatrix();
+	// Render between the last two simulation steps, for smooth movement.
+	const Matrix4& actorWorldTransform = GetOwner()->GetTransform()->GetInterpolatedLocalToWorldMatrix();
 	
 	int materialIndex = 0;
 	int maxMaterialIndex = static_cast<int>(mMaterials.size()) - 1;
@@ -38,19 +36,16 @@ void MeshRenderer::RenderOpaque()
 	{
 		Matrix4 meshWorldTransformMatrix = actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix();
 		
-		auto submeshes = mMeshes[i]->GetSubmeshes();
+		const std::vector<Submesh*>& submeshes = mMeshes[i]->GetSubmeshes();
 		for(int j = 0; j < submeshes.size(); j++)
 		{
 			Material& material = mMaterials[materialIndex];
 			
 			// Ignore translucent rendering.
+			// Opaque submeshes are queued, so they can be sorted to reduce state changes.
 			if(!material.IsTranslucent())
 			{
-				// Activate material.
-				material.Activate(meshWorldTransformMatrix);
-				
-				// Render the submesh!
-				submeshes[j]->Render();
+				queue.Submit(&material, submeshes[j], meshWorldTransformMatrix);
 			}
 			
 			// Draw debug axes if desired.
@@ -67,7 +62,7 @@ void MeshRenderer::RenderOpaque()
 
 void MeshRenderer::RenderTranslucent()
 {
-	Matrix4 actorWorldTransform = GetOwner()->GetTransform()->GetLocalToWorldMatrix();
+	Matrix4 actorWorldTransform = GetOwner()->GetTransform()->GetInterpolatedLocalToWorldMatrix();
 	
 	int materialIndex = 0;
 	int maxMaterialIndex = static_cast<int>(mMaterials.size()) - 1;
@@ -76,7 +71,7 @@ void MeshRenderer::RenderTranslucent()
 	{
 		Matrix4 meshWorldTransform = actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix();
 		
-		auto submeshes = mMeshes[i]->GetSubmeshes();
+		const std::vector<Submesh*>& submeshes = mMeshes[i]->GetSubmeshes();
 		for(int j = 0; j < submeshes.size(); j++)
 		{
 			Material& material = mMaterials[materialIndex];
@@ -105,6 +100,7 @@ void MeshRenderer::SetModel(Model* model)
     // Clear any existing.
     mMeshes.clear();
     mMaterials.clear();
+    mMeshCaches.clear();
     
     // Add each mesh.
     for(auto& mesh : model->GetMeshes())
@@ -117,6 +113,7 @@ void MeshRenderer::SetMesh(Mesh* mesh)
 {
     mMeshes.clear();
     mMaterials.clear();
+    mMeshCaches.clear();
     AddMesh(mesh);
 }
 
@@ -124,6 +121,7 @@ void MeshRenderer::AddMesh(Mesh* mesh)
 {
 	// Add mesh to array.
 	mMeshes.push_back(mesh);
+	mMeshCaches.emplace_back();
 	
 	// Create a material for each submesh.
 	const std::vector<Submesh*>& submeshes = mesh->GetSubmeshes();
@@ -136,6 +134,10 @@ void MeshRenderer::AddMesh(Mesh* mesh)
 		if(!submesh->GetTextureName().empty())
 		{
 			Texture* tex = Services::GetAssets()->LoadTexture(submesh->GetTextureName());
+			if(tex != nullptr)
+			{
+				tex->SetStatic(true);
+			}
 			m.SetDiffuseTexture(tex);
 		}
 		
@@ -189,31 +191,66 @@ Mesh* MeshRenderer::GetMesh(int index) const
 
 bool MeshRenderer::Raycast(const Ray& ray, RaycastHit& hitInfo)
 {
-	Matrix4 localToWorldMatrix = GetOwner()->GetTransform()->GetLocalToWorldMatrix();
+	UpdateMeshCaches();
 	
-	// Raycast against triangles in the mesh.
-	for(auto& mesh : mMeshes)
+	// Quick check against bounds of all meshes. If that's missed, no need to check each mesh.
+	RaycastHit aabbHitInfo;
+	if(mHasWorldAABB && !Collisions::TestRayAABB(ray, mWorldAABB, aabbHitInfo))
 	{
-		// Calculate world->local space transform by creating object->local and inverting.
-		Matrix4 meshToWorldMatrix = localToWorldMatrix * mesh->GetMeshToLocalMatrix();
-        Matrix4 worldToMeshMatrix = Matrix4::InverseTransform(meshToWorldMatrix);
-		
-		// Transform the ray to object space.
-        Vector3 rayLocalPos = worldToMeshMatrix.TransformPoint(ray.origin);
-        Vector3 rayLocalDir = worldToMeshMatrix.TransformVector(ray.direction);
-		rayLocalDir.Normalize();
-		Ray localRay(rayLocalPos, rayLocalDir);
-		
-		// See if the local ray intersects the local space triangles of the mesh.
-		if(mesh->Raycast(localRay, hitInfo))
+		return false;
+	}
+	
+	// Raycast against triangles in each mesh, keeping the nearest hit.
+	bool hit = false;
+	for(int i = 0; i < mMeshes.size(); i++)
+	{
+		// Transform the ray to mesh space.
+		// The direction is NOT normalized afterwards, so a "t" along the mesh space ray is the same "t" along the world space ray.
+		const Matrix4& worldToMeshMatrix = mMeshCaches[i].worldToMeshMatrix;
+		Ray meshRay(worldToMeshMatrix.TransformPoint(ray.origin), worldToMeshMatrix.TransformVector(ray.direction));
+		hit |= mMeshes[i]->Raycast(meshRay, hitInfo);
+	}
+	
+	if(hit)
+	{
+		hitInfo.point = ray.GetPoint(hitInfo.t);
+	}
+	return hit;
+}
+
+bool MeshRenderer::GetWorldAABB(AABB& outAABB)
+{
+	if(mMeshes.empty()) { return false; }
+	
+	UpdateMeshCaches();
+	if(!mHasWorldAABB) { return false; }
+	outAABB = mWorldAABB;
+	return true;
+}
+
+bool MeshRenderer::GetInterpolatedWorldAABB(AABB& outAABB)
+{
+	if(!GetWorldAABB(outAABB)) { return false; }
+	
+	// Cached bounds are for the current simulated pose. That's where meshes are drawn, unless they moved during the last step.
+	Transform* transform = GetOwner()->GetTransform();
+	if(!transform->IsInterpolating()) { return true; }
+	
+	// Moving objects are drawn somewhere between their previous and current pose, so calculate bounds at the drawn pose.
+	const Matrix4& actorWorldTransform = transform->GetInterpolatedLocalToWorldMatrix();
+	for(int i = 0; i < mMeshes.size(); i++)
+	{
+		AABB meshAABB = AABB::Transform(mMeshes[i]->GetAABB(), actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix());
+		if(i == 0)
+		{
+			outAABB = meshAABB;
+		}
+		else
 		{
-			//TODO: Convert hit info back to world space.
-			return true;
+			outAABB.GrowToContain(meshAABB);
 		}
 	}
-	
-	// Ray did not intersect with any part of the mesh renderer.
-	return false;
+	return true;
 }
 
 void MeshRenderer::DebugDrawAABBs()
@@ -230,3 +267,47 @@ void MeshRenderer::DebugDrawAABBs()
         Debug::DrawAABB(mesh->GetAABB(), Color32::Magenta, 60.0f, &meshToWorldMatrix);
 	}
 }
+
+void MeshRenderer::UpdateMeshCaches()
+{
+	// Everything is stale if the transform moved. Otherwise, only meshes whose mesh->local matrix changed (e.g. from animation).
+	Transform* transform = GetOwner()->GetTransform();
+	bool transformChanged = transform->GetChangeCount() != mTransformChangeCount;
+	mTransformChangeCount = transform->GetChangeCount();
+	
+	bool anyChanged = false;
+	for(int i = 0; i < mMeshes.size(); i++)
+	{
+		MeshCache& cache = mMeshCaches[i];
+		if(cache.valid && !transformChanged && cache.meshToLocalChangeCount == mMeshes[i]->GetMeshToLocalChangeCount()) { continue; }
+		
+		Matrix4 meshToWorldMatrix = transform->GetLocalToWorldMatrix() * mMeshes[i]->GetMeshToLocalMatrix();
+		cache.worldToMeshMatrix = Matrix4::InverseTransform(meshToWorldMatrix);
+		if(mMeshes[i]->HasAABB())
+		{
+			// Mesh AABBs are in mesh space, so transform to world space using current mesh->local transform.
+			cache.worldAABB = AABB::Transform(mMeshes[i]->GetAABB(), meshToWorldMatrix);
+		}
+		cache.meshToLocalChangeCount = mMeshes[i]->GetMeshToLocalChangeCount();
+		cache.valid = true;
+		anyChanged = true;
+	}
+	
+	// Combine mesh bounds. If any mesh doesn't have bounds, we can't know the full extent.
+	if(anyChanged)
+	{
+		mHasWorldAABB = !mMeshes.empty();
+		for(int i = 0; i < mMeshes.size() && mHasWorldAABB; i++)
+		{
+			mHasWorldAABB = mMeshes[i]->HasAABB();
+			if(i == 0)
+			{
+				mWorldAABB = mMeshCaches[i].worldAABB;
+			}
+			else
+			{
+				mWorldAABB.GrowToContain(mMeshCaches[i].worldAABB);
+			}
+		}
+	}
+}
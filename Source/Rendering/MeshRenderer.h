@@ -10,22 +10,26 @@
 
 #include <vector>
 
+#include "AABB.h"
 #include "Material.h"
+#include "Matrix4.h"
 
 class Mesh;
 class Model;
 class Ray;
 struct RaycastHit;
+class RenderQueue;
 class Texture;
 
-class MeshRenderer : public Component
+// Final, because the renderer draws everything in ComponentPool<MeshRenderer>, and each pool holds exactly one class.
+// A subclass would be created in its own pool, and would never be drawn.
+class MeshRenderer final : public Component
 {
     TYPE_DECL_CHILD();
 public:
     MeshRenderer(Actor* actor);
-    ~MeshRenderer();
 	
-	void RenderOpaque();
+	void RenderOpaque(RenderQueue& queue);
 	void RenderTranslucent();
     
     void SetModel(Model* model);
@@ -42,8 +46,17 @@ public:
 	const std::vector<Mesh*>& GetMeshes() const { return mMeshes; }
 	Mesh* GetMesh(int index) const;
 	
+	// Finds the nearest triangle hit by a world space ray, if closer than hitInfo.t.
+	// On a hit, hitInfo's "t" and world space point are filled in.
 	bool Raycast(const Ray& ray, RaycastHit& hitInfo);
 	
+	// Calculates a world space AABB containing all meshes.
+	// Returns false if any mesh doesn't have bounds, since then we can't know the full extent.
+	bool GetWorldAABB(AABB& outAABB);
+	
+	// Same, but for where the meshes are drawn this frame (between the last two simulation steps). Use for culling.
+	bool GetInterpolatedWorldAABB(AABB& outAABB);
+	
 	void DebugDrawAABBs();
     
 private:
@@ -59,4 +72,22 @@ private:
     // Each mesh *must have* a material!
 	// If a mesh has multiple submeshes, each submesh *must have* a material!
     std::vector<Material> mMaterials;
+    
+    // Per-mesh world->mesh matrices and world bounds. These only change when the transform or a mesh->local matrix does,
+    // so they are cached rather than recalculated (and inverted!) on every raycast.
+    struct MeshCache
+    {
+        Matrix4 worldToMeshMatrix;
+        AABB worldAABB;
+        unsigned int meshToLocalChangeCount = 0;
+        bool valid = false;
+    };
+    std::vector<MeshCache> mMeshCaches;
+    unsigned int mTransformChangeCount = 0;
+    
+    // Bounds of all meshes in world space. Only valid if every mesh has bounds.
+    AABB mWorldAABB;
+    bool mHasWorldAABB = false;
+    
+    void UpdateMeshCaches();
 };
@@ -382,6 +382,7 @@ void Model::ParseFromData(char *data, int dataLength)
             submesh->SetNormals(vertexNormals);
             submesh->SetUV1s(vertexUVs);
             submesh->SetIndexes(vertexIndexes);
+            submesh->UpdateRaycastBVH();
             
             // Save texture name.
             submesh->SetTextureName(textureName);
@@ -0,0 +1,153 @@
+//
+// PixelDecode.cpp
+//
+// Clark Kromenaker
+//
+#include "PixelDecode.h"
+
+#include <cstring>
+
+#include "SIMD.h"
+
+namespace
+{
+	// Expands 5-bit and 6-bit color channels to 8 bits by replicating the top bits into the bottom bits.
+	// This maps 0 to 0 and max to 255 exactly, with no multiply or divide.
+	inline uint8_t Expand5(uint32_t value) { return static_cast<uint8_t>((value << 3) | (value >> 2)); }
+	inline uint8_t Expand6(uint32_t value) { return static_cast<uint8_t>((value << 2) | (value >> 4)); }
+
+	// Transparency key is "magenta-ish": red > 200, green < 100, blue > 200 (after expanding to 8 bits).
+	// In terms of the packed channels, that's red >= 25, green <= 24, blue >= 25.
+	const int kKeyMinRed5 = 25;
+	const int kKeyMaxGreen6 = 24;
+	const int kKeyMinBlue5 = 25;
+
+	inline bool DecodeRGB565Pixel(uint16_t pixel, uint8_t* dst)
+	{
+		uint32_t red = (pixel >> 11) & 0x1F;
+		uint32_t green = (pixel >> 5) & 0x3F;
+		uint32_t blue = pixel & 0x1F;
+		dst[0] = Expand5(red);
+		dst[1] = Expand6(green);
+		dst[2] = Expand5(blue);
+
+		bool transparent = red >= kKeyMinRed5 && green <= kKeyMaxGreen6 && blue >= kKeyMinBlue5;
+		dst[3] = transparent ? 0 : 255;
+		return transparent;
+	}
+}
+
+bool PixelDecode::RGB565ToRGBA8(const uint8_t* src, int pixelCount, uint8_t* dst)
+{
+	int i = 0;
+	bool anyTransparent = false;
+
+	#if defined(SIMD_SSE)
+	{
+		// 8 pixels at a time: each channel is unpacked to its own 16-bit lanes, expanded, and then interleaved back to bytes.
+		const __m128i kMask5 = _mm_set1_epi16(0x1F);
+		const __m128i kMask6 = _mm_set1_epi16(0x3F);
+		const __m128i kOpaque = _mm_set1_epi16(0xFF);
+		const __m128i kKeyRed = _mm_set1_epi16(kKeyMinRed5 - 1);
+		const __m128i kKeyGreen = _mm_set1_epi16(kKeyMaxGreen6 + 1);
+		const __m128i kKeyBlue = _mm_set1_epi16(kKeyMinBlue5 - 1);
+		__m128i anyKey = _mm_setzero_si128();
+		for(; i + 8 <= pixelCount; i += 8)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+			__m128i red = _mm_srli_epi16(pixels, 11);
+			__m128i green = _mm_and_si128(_mm_srli_epi16(pixels, 5), kMask6);
+			__m128i blue = _mm_and_si128(pixels, kMask5);
+
+			// Alpha key with masks rather than branches.
+			__m128i key = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi16(red, kKeyRed), _mm_cmplt_epi16(green, kKeyGreen)),
+										_mm_cmpgt_epi16(blue, kKeyBlue));
+			anyKey = _mm_or_si128(anyKey, key);
+			__m128i alpha = _mm_andnot_si128(key, kOpaque);
+
+			red = _mm_or_si128(_mm_slli_epi16(red, 3), _mm_srli_epi16(red, 2));
+			green = _mm_or_si128(_mm_slli_epi16(green, 2), _mm_srli_epi16(green, 4));
+			blue = _mm_or_si128(_mm_slli_epi16(blue, 3), _mm_srli_epi16(blue, 2));
+
+			// Pack pairs of channels into 16-bit lanes (RG and BA), then interleave those into 32-bit RGBA pixels.
+			__m128i redGreen = _mm_or_si128(red, _mm_slli_epi16(green, 8));
+			__m128i blueAlpha = _mm_or_si128(blue, _mm_slli_epi16(alpha, 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi16(redGreen, blueAlpha));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_unpackhi_epi16(redGreen, blueAlpha));
+		}
+		anyTransparent = _mm_movemask_epi8(anyKey) != 0;
+	}
+	#elif defined(SIMD_NEON)
+	{
+		// 8 pixels at a time, with the interleaving store doing the work of packing channels into RGBA.
+		const uint16x8_t kMask5 = vdupq_n_u16(0x1F);
+		const uint16x8_t kMask6 = vdupq_n_u16(0x3F);
+		uint16x8_t anyKey = vdupq_n_u16(0);
+		for(; i + 8 <= pixelCount; i += 8)
+		{
+			uint16x8_t pixels = vreinterpretq_u16_u8(vld1q_u8(src + i * 2));
+			uint16x8_t red = vshrq_n_u16(pixels, 11);
+			uint16x8_t green = vandq_u16(vshrq_n_u16(pixels, 5), kMask6);
+			uint16x8_t blue = vandq_u16(pixels, kMask5);
+
+			uint16x8_t key = vandq_u16(vandq_u16(vcgeq_u16(red, vdupq_n_u16(kKeyMinRed5)), vcleq_u16(green, vdupq_n_u16(kKeyMaxGreen6))),
+									   vcgeq_u16(blue, vdupq_n_u16(kKeyMinBlue5)));
+			anyKey = vorrq_u16(anyKey, key);
+
+			uint8x8x4_t rgba;
+			rgba.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(red, 3), vshrq_n_u16(red, 2)));
+			rgba.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(green, 2), vshrq_n_u16(green, 4)));
+			rgba.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(blue, 3), vshrq_n_u16(blue, 2)));
+			rgba.val[3] = vmvn_u8(vmovn_u16(key));
+			vst4_u8(dst + i * 4, rgba);
+		}
+		uint16x4_t anyKeyHalf = vorr_u16(vget_low_u16(anyKey), vget_high_u16(anyKey));
+		anyTransparent = vget_lane_u64(vreinterpret_u64_u16(anyKeyHalf), 0) != 0;
+	}
+	#endif
+
+	// Scalar for whatever is left (or everything, without SIMD).
+	for(; i < pixelCount; ++i)
+	{
+		uint16_t pixel = static_cast<uint16_t>(src[i * 2] | (src[i * 2 + 1] << 8));
+		anyTransparent |= DecodeRGB565Pixel(pixel, dst + i * 4);
+	}
+	return anyTransparent;
+}
+
+void PixelDecode::BuildPaletteTable(const uint8_t* paletteBGRA, int paletteColorCount, uint32_t* outTable)
+{
+	for(int i = 0; i < 256; ++i)
+	{
+		// Palette color order is BGRA. But our internal pixels are RGBA.
+		uint8_t rgba[4] = { 0, 0, 0, 255 };
+		if(paletteBGRA != nullptr && i < paletteColorCount)
+		{
+			rgba[0] = paletteBGRA[i * 4 + 2];
+			rgba[1] = paletteBGRA[i * 4 + 1];
+			rgba[2] = paletteBGRA[i * 4];
+		}
+		memcpy(&outTable[i], rgba, 4);
+	}
+}
+
+void PixelDecode::PaletteToRGBA8(const uint8_t* indexes, int pixelCount, const uint32_t* table, uint8_t* dst)
+{
+	// There's no efficient SIMD gather for byte indexes, but a whole pixel per lookup/store is already quick.
+	for(int i = 0; i < pixelCount; ++i)
+	{
+		memcpy(dst + i * 4, &table[indexes[i]], 4);
+	}
+}
+
+void PixelDecode::BGRToRGBA8(const uint8_t* src, int pixelCount, int bytesPerPixel, uint8_t* dst)
+{
+	for(int i = 0; i < pixelCount; ++i)
+	{
+		const uint8_t* pixel = src + i * bytesPerPixel;
+		dst[i * 4] = pixel[2];
+		dst[i * 4 + 1] = pixel[1];
+		dst[i * 4 + 2] = pixel[0];
+		dst[i * 4 + 3] = 255;
+	}
+}
@@ -0,0 +1,31 @@
+//
+// PixelDecode.h
+//
+// Clark Kromenaker
+//
+// Bulk conversion of raw texture pixel data (as stored in BMP files) into RGBA8.
+//
+// These work a row (or any run of pixels) at a time, straight from raw file bytes.
+// Where available, SIMD is used - results are identical to the scalar fallback.
+//
+#pragma once
+#include <cstdint>
+
+namespace PixelDecode
+{
+	// Converts RGB565 pixels (little-endian) to RGBA8.
+	// Magenta-ish pixels are the transparency key - they get zero alpha, everything else gets full alpha.
+	// Returns true if any pixel was transparent.
+	bool RGB565ToRGBA8(const uint8_t* src, int pixelCount, uint8_t* dst);
+
+	// Builds a lookup table for expanding palette indexes to RGBA8 from a BGRA palette.
+	// BMP palettes don't store alpha (it's usually zero), so all colors get full alpha.
+	// Table must have room for 256 entries. Indexes past the end of the palette are black.
+	void BuildPaletteTable(const uint8_t* paletteBGRA, int paletteColorCount, uint32_t* outTable);
+
+	// Converts palette indexes to RGBA8 using a table from BuildPaletteTable.
+	void PaletteToRGBA8(const uint8_t* indexes, int pixelCount, const uint32_t* table, uint8_t* dst);
+
+	// Converts BGR pixels, each taking up "bytesPerPixel" bytes (3 or 4), to RGBA8 with full alpha.
+	void BGRToRGBA8(const uint8_t* src, int pixelCount, int bytesPerPixel, uint8_t* dst);
+}
@@ -0,0 +1,79 @@
+//
+// RenderQueue.cpp
+//
+// Clark Kromenaker
+//
+#include "RenderQueue.h"
+
+#include "GMath.h"
+#include "Material.h"
+#include "RenderStats.h"
+#include "Shader.h"
+#include "SortUtil.h"
+#include "Submesh.h"
+#include "Texture.h"
+
+void RenderQueue::Begin(const Vector3& viewPosition, const Vector3& viewDirection, float maxDepth)
+{
+	mItems.clear();
+	mViewPosition = viewPosition;
+	mViewDirection = viewDirection;
+	mMaxDepth = maxDepth > 0.0f ? maxDepth : 1.0f;
+}
+
+void RenderQueue::Submit(Material* material, const Submesh* submesh, const Matrix4& objectToWorldMatrix)
+{
+	if(material == nullptr || material->GetShader() == nullptr || submesh == nullptr) { return; }
+	
+	Item item;
+	item.material = material;
+	item.submesh = submesh;
+	item.objectToWorldMatrix = objectToWorldMatrix;
+	mItems.push_back(item);
+	++RenderStats::sCurrent.queuedCount;
+}
+
+void RenderQueue::Execute()
+{
+	const uint32_t kShaderMask = (1 << kShaderBits) - 1;
+	const uint32_t kTextureMask = (1 << kTextureBits) - 1;
+	const uint32_t kDepthMask = (1 << kDepthBits) - 1;
+	
+	// Build a sort key for each item.
+	// GL object names are small integers handed out sequentially, so their low bits make decent IDs.
+	// Collisions only affect sort order, not correctness - redundant binds are detected by the objects themselves.
+	uint32_t count = static_cast<uint32_t>(mItems.size());
+	mKeys.resize(count);
+	mIndexes.resize(count);
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		const Item& item = mItems[i];
+		
+		uint32_t shaderId = item.material->GetShader()->GetProgram() & kShaderMask;
+		
+		Texture* texture = item.material->GetDiffuseTexture();
+		uint32_t textureId = (texture != nullptr ? texture->GetTextureId() : 0) & kTextureMask;
+		
+		// Depth along view direction, quantized to the available bits.
+		// Anything behind the view position or beyond max depth is clamped.
+		float depth = Vector3::Dot(item.objectToWorldMatrix.GetTranslation() - mViewPosition, mViewDirection);
+		float normalizedDepth = Math::Clamp(depth / mMaxDepth, 0.0f, 1.0f);
+		uint32_t depthId = static_cast<uint32_t>(normalizedDepth * kDepthMask);
+		
+		mKeys[i] = (shaderId << (kTextureBits + kDepthBits)) | (textureId << kDepthBits) | depthId;
+		mIndexes[i] = i;
+	}
+	
+	// Sort items by key.
+	SortUtil::RadixSort(mKeys, mIndexes, mTempKeys, mTempIndexes);
+	
+	// Draw in sorted order.
+	// Shaders, textures, and vertex arrays each skip re-binding if already bound, so sorted draws avoid most state changes.
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		Item& item = mItems[mIndexes[i]];
+		item.material->Activate(item.objectToWorldMatrix);
+		item.submesh->Render();
+	}
+	mItems.clear();
+}
@@ -0,0 +1,63 @@
+//
+// RenderQueue.h
+//
+// Clark Kromenaker
+//
+// Collects submesh draws for a frame, sorts them to minimize state changes, and then draws them.
+//
+// Each submitted draw gets a compact 32-bit sort key built from its shader, texture, and depth.
+// Keys are radix sorted, so draws sharing a shader end up together, then draws sharing a texture,
+// and finally draws are ordered front-to-back (which helps early depth rejection).
+//
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Matrix4.h"
+#include "Vector3.h"
+
+class Material;
+class Submesh;
+
+class RenderQueue
+{
+public:
+	// Starts a new frame of submissions. View position/direction are used to calculate depth.
+	void Begin(const Vector3& viewPosition, const Vector3& viewDirection, float maxDepth);
+	
+	// Adds a draw to the queue. Material and submesh must remain valid until Execute is called.
+	void Submit(Material* material, const Submesh* submesh, const Matrix4& objectToWorldMatrix);
+	
+	// Sorts and draws everything in the queue, then empties the queue.
+	void Execute();
+	
+	unsigned int GetCount() const { return static_cast<unsigned int>(mItems.size()); }
+	
+private:
+	// Sort key layout, from most to least significant bits.
+	static const int kShaderBits = 8;
+	static const int kTextureBits = 12;
+	static const int kDepthBits = 12;
+	
+	struct Item
+	{
+		Material* material;
+		const Submesh* submesh;
+		Matrix4 objectToWorldMatrix;
+	};
+	
+	// Items submitted this frame, in submission order.
+	std::vector<Item> mItems;
+	
+	// Sort keys for items (and the item index each key belongs to).
+	// These are kept around between frames to avoid reallocating every frame.
+	std::vector<uint32_t> mKeys;
+	std::vector<uint32_t> mIndexes;
+	std::vector<uint32_t> mTempKeys;
+	std::vector<uint32_t> mTempIndexes;
+	
+	// Used to calculate depth for sort keys.
+	Vector3 mViewPosition;
+	Vector3 mViewDirection;
+	float mMaxDepth = 1.0f;
+};
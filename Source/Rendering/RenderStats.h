@@ -0,0 +1,36 @@
+//
+// RenderStats.h
+//
+// Clark Kromenaker
+//
+// Counters for work done by the renderer in a single frame.
+// Low-level rendering classes increment the "current" stats as they issue GL calls;
+// the renderer saves and resets them at the end of each frame (so work done during update counts too).
+//
+#pragma once
+
+struct RenderStats
+{
+	// Stats for the frame currently being rendered.
+	static RenderStats sCurrent;
+	
+	// Number of draw calls issued.
+	unsigned int drawCount = 0;
+	
+	// Number of state changes that actually reached GL (redundant ones are skipped).
+	unsigned int shaderBindCount = 0;
+	unsigned int textureBindCount = 0;
+	unsigned int vertexArrayBindCount = 0;
+	
+	// Number of items submitted to the render queue.
+	unsigned int queuedCount = 0;
+	
+	// Number of mesh renderers and BSP nodes (including their subtrees) skipped by frustum culling.
+	unsigned int culledCount = 0;
+	unsigned int culledBSPNodeCount = 0;
+	
+	// Bytes of pixel data sent to textures on the GPU.
+	unsigned int textureUploadBytes = 0;
+	
+	void Reset() { *this = RenderStats(); }
+};
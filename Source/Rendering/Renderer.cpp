@@ -16,6 +16,8 @@
 #include "BSP.h"
 #include "Debug.h"
 #include "Camera.h"
+#include "ComponentPool.h"
+#include "Frustum.h"
 #include "Matrix4.h"
 #include "MeshRenderer.h"
 #include "Model.h"
@@ -25,6 +27,9 @@
 #include "Texture.h"
 #include "UICanvas.h"
 
+// Stats are accumulated here by low-level rendering classes during a frame.
+RenderStats RenderStats::sCurrent;
+
 float line_vertices[] = {
 	0.0f, 0.0f, 0.0f,
 	1.0f, 1.0f, 1.0f
@@ -258,6 +263,18 @@ void Renderer::Shutdown()
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
 }
 
+bool Renderer::SetVSync(bool enabled)
+{
+    return SDL_GL_SetSwapInterval(enabled ? 1 : 0) == 0;
+}
+
+float Renderer::GetRefreshRate() const
+{
+    SDL_DisplayMode displayMode;
+    if(mWindow == nullptr || SDL_GetWindowDisplayMode(mWindow, &displayMode) != 0) { return 0.0f; }
+    return static_cast<float>(displayMode.refresh_rate);
+}
+
 void Renderer::Render()
 {
 	// Enable opaque rendering (no blend, write to & test depth buffer).
@@ -278,6 +295,12 @@ void Renderer::Render()
         projectionMatrix = mCamera->GetProjectionMatrix();
         viewMatrix = mCamera->GetLookAtMatrix();
         
+        // Sorting and culling should use the same (interpolated) camera as the view.
+        const Matrix4& cameraToWorld = mCamera->GetOwner()->GetTransform()->GetInterpolatedLocalToWorldMatrix();
+        Vector3 cameraPosition = cameraToWorld.TransformPoint(Vector3::Zero);
+        Vector3 cameraForward = cameraToWorld.TransformVector(Vector3::UnitZ);
+        cameraForward.Normalize();
+        
         // SKYBOX RENDERING
         // Draw the skybox first, which is just a little cube around the camera.
         // Don't write to depth mask, or else you can ONLY see skybox (b/c again, little cube).
@@ -300,21 +323,52 @@ void Renderer::Render()
         Material::SetViewMatrix(viewMatrix);
         Material::SetProjMatrix(projectionMatrix);
         
+        // Anything outside the camera's view frustum doesn't need to be rendered.
+        Frustum frustum(projectionMatrix * viewMatrix);
+        
         // OPAQUE BSP RENDERING
         // Render opaque BSP. This should occur front-to-back, which has no overdraw.
         if(mBSP != nullptr)
         {
-            mBSP->RenderOpaque(mCamera->GetOwner()->GetPosition(), mCamera->GetOwner()->GetForward());
+            mBSP->RenderOpaque(cameraPosition, cameraForward, frustum);
         }
         
         // OPAQUE MESH RENDERING
-        // Render opaque meshes (no particular order).
-        // Sorting is probably not worthwhile b/c BSP likely mostly filled the z-buffer at this point.
-        // And with the z-buffer, we can render opaque meshed correctly regardless of order.
-        for(auto& meshRenderer : mMeshRenderers)
+        // With the z-buffer, we can render opaque meshes correctly regardless of order.
+        // So, mesh renderers submit to a queue, which sorts draws to minimize shader/texture changes.
+        mOpaqueQueue.Begin(cameraPosition, cameraForward, mCamera->GetFarClipPlane());
+        
+        // Gather bounds for all mesh renderers, so they can be culled in one batch.
+        // Mesh renderers without bounds can't be culled, so they're always submitted.
+        // Bounds are for the interpolated pose, since that's where meshes are drawn.
+        // Mesh renderers are stored together in their pool, so this walks straight through memory.
+        // The pool only holds components created as MeshRenderer exactly (which is why MeshRenderer is final).
+        // Pool order isn't creation order (freed slots are reused), but that's fine - the queue sorts draws anyway.
+        mCullRenderers.clear();
+        mCullBounds.clear();
+        ComponentPool<MeshRenderer>::Instance().ForEach([this](MeshRenderer* meshRenderer) {
+            if(!meshRenderer->IsActiveAndEnabled()) { return; }
+            
+            AABB bounds;
+            if(meshRenderer->GetInterpolatedWorldAABB(bounds))
+            {
+                mCullRenderers.push_back(meshRenderer);
+                mCullBounds.push_back(bounds);
+            }
+            else
+            {
+                meshRenderer->RenderOpaque(mOpaqueQueue);
+            }
+        });
+        
+        // Submit only mesh renderers that are at least partially in view.
+        frustum.CullAABBs(mCullBounds, mVisibleIndexes);
+        RenderStats::sCurrent.culledCount += static_cast<unsigned int>(mCullBounds.size() - mVisibleIndexes.size());
+        for(int index : mVisibleIndexes)
         {
-            meshRenderer->RenderOpaque();
+            mCullRenderers[index]->RenderOpaque(mOpaqueQueue);
         }
+        mOpaqueQueue.Execute();
         
         // Turn off alpha test.
         Material::UseAlphaTest(false);
@@ -363,20 +417,10 @@ void Renderer::Render()
     
 	// Present to window.
 	SDL_GL_SwapWindow(mWindow);
-}
-
-void Renderer::AddMeshRenderer(MeshRenderer* mr)
-{
-    mMeshRenderers.push_back(mr);
-}
-
-void Renderer::RemoveMeshRenderer(MeshRenderer* mr)
-{
-    auto it = std::find(mMeshRenderers.begin(), mMeshRenderers.end(), mr);
-    if(it != mMeshRenderers.end())
-    {
-        mMeshRenderers.erase(it);
-    }
+	
+	// Save stats for this frame, and start counting for the next one.
+	mStats = RenderStats::sCurrent;
+	RenderStats::sCurrent.Reset();
 }
 
 void Renderer::SetSkybox(Skybox* skybox)
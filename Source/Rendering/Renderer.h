@@ -11,8 +11,11 @@
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 
+#include "AABB.h"
 #include "Material.h"
 #include "Matrix4.h"
+#include "RenderQueue.h"
+#include "RenderStats.h"
 #include "Vector2.h"
 
 class BSP;
@@ -33,9 +36,6 @@ public:
     void SetCamera(Camera* camera) { mCamera = camera; }
     Camera* GetCamera() { return mCamera; }
 	
-    void AddMeshRenderer(MeshRenderer* mc);
-    void RemoveMeshRenderer(MeshRenderer* mc);
-    
     void SetBSP(BSP* bsp) { mBSP = bsp; }
     
 	void SetSkybox(Skybox* skybox);
@@ -44,6 +44,15 @@ public:
 	int GetWindowHeight() { return mScreenHeight; }
 	
 	Vector2 GetWindowSize() { return Vector2(static_cast<float>(mScreenWidth), static_cast<float>(mScreenHeight)); }
+	
+	// Vsync makes buffer swaps wait for the display to refresh. Returns false if the driver doesn't allow changing it.
+	bool SetVSync(bool enabled);
+	
+	// The display's refresh rate, or zero if unknown.
+	float GetRefreshRate() const;
+	
+	// Stats for the most recently completed frame.
+	const RenderStats& GetStats() const { return mStats; }
     
 private:
     // Screen's width and height, in pixels.
@@ -59,8 +68,16 @@ private:
     // Our camera in the scene - we currently only support one.
     Camera* mCamera = nullptr;
     
-    // List of mesh components to render.
-    std::vector<MeshRenderer*> mMeshRenderers;
+	// Opaque mesh draws are queued up and sorted before rendering.
+	RenderQueue mOpaqueQueue;
+	
+	// Scratch space for frustum culling mesh renderers (kept around to avoid allocating each frame).
+	std::vector<MeshRenderer*> mCullRenderers;
+	std::vector<AABB> mCullBounds;
+	std::vector<int> mVisibleIndexes;
+	
+	// Render stats from the last completed frame.
+	RenderStats mStats;
 	
     // A BSP to render.
     BSP* mBSP = nullptr;
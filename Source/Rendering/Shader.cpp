@@ -5,15 +5,22 @@
 //
 #include "Shader.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
 #include "Color32.h"
 #include "Matrix4.h"
+#include "RenderStats.h"
 #include "Vector3.h"
+#include "Vector4.h"
 #include "VertexDefinition.h"
 
+const char* Shader::kGlobalUniformsBlockName = "GlobalUniforms";
+
+GLuint Shader::sActiveProgram = GL_NONE;
+
 Shader::Shader(const char* vertShaderPath, const char* fragShaderPath)
 {
     // Load vertex and fragment shaders, and compile them.
@@ -56,79 +63,105 @@ Shader::Shader(const char* vertShaderPath, const char* fragShaderPath)
     glDetachShader(mProgram, vertexShader);
     glDetachShader(mProgram, fragmentShader);
     
-    // After shader program is compiled and linked, it's possible to query the program
-    // to determine the uniforms that exist in the program.
+    // If the shader uses the global uniform block, hook it up to the shared binding point.
+    GLuint globalBlockIndex = glGetUniformBlockIndex(mProgram, kGlobalUniformsBlockName);
+    if(globalBlockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(mProgram, globalBlockIndex, kGlobalUniformsBinding);
+    }
     
-    // This *may* be useful in the future so that a material knows what uniforms exist.
-    // But for now, we are assuming that the material has explicitly defined values for all uniforms.
-    //RefreshUniforms();
+    // After shader program is compiled and linked, query the program to determine the uniforms that exist.
+    // Caching locations here means we never need to call glGetUniformLocation while rendering.
+    RefreshUniforms();
 }
 
 Shader::~Shader()
 {
+    if(sActiveProgram == mProgram)
+    {
+        sActiveProgram = GL_NONE;
+    }
     glDeleteProgram(mProgram);
 }
 
 void Shader::Activate()
 {
-    if(mProgram != GL_NONE)
+    if(mProgram != GL_NONE && mProgram != sActiveProgram)
     {
         glUseProgram(mProgram);
+        sActiveProgram = mProgram;
+        ++RenderStats::sCurrent.shaderBindCount;
+    }
+}
+
+void Shader::SetUniformInt(UniformId id, int value)
+{
+    // Ints are cached by bit pattern in the float value array.
+    float bits = 0.0f;
+    memcpy(&bits, &value, sizeof(int));
+    
+    Uniform* uniform = GetUniformForSet(id, &bits, 1);
+    if(uniform != nullptr)
+    {
+        glUniform1i(uniform->location, value);
     }
 }
 
-void Shader::SetUniformInt(const char* name, int value)
+void Shader::SetUniformFloat(UniformId id, float value)
 {
-    if(mProgram != GL_NONE)
+    Uniform* uniform = GetUniformForSet(id, &value, 1);
+    if(uniform != nullptr)
     {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniform1i(loc, value);
+        glUniform1f(uniform->location, value);
     }
 }
 
-void Shader::SetUniformFloat(const char* name, float value)
+void Shader::SetUniformVector3(UniformId id, const Vector3& vector)
 {
-    if(mProgram != GL_NONE)
+    float values[3] = { vector.x, vector.y, vector.z };
+    Uniform* uniform = GetUniformForSet(id, values, 3);
+    if(uniform != nullptr)
     {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniform1f(loc, value);
+        glUniform3f(uniform->location, vector.x, vector.y, vector.z);
     }
 }
 
-void Shader::SetUniformVector3(const char* name, const Vector3& vector)
+void Shader::SetUniformVector4(UniformId id, const Vector4& vector)
 {
-    if(mProgram != GL_NONE)
+    float values[4] = { vector.x, vector.y, vector.z, vector.w };
+    Uniform* uniform = GetUniformForSet(id, values, 4);
+    if(uniform != nullptr)
     {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform3f(vecLoc, vector.x, vector.y, vector.z);
+        glUniform4f(uniform->location, vector.x, vector.y, vector.z, vector.w);
     }
 }
 
-void Shader::SetUniformVector4(const char *name, const Vector4& vector)
+void Shader::SetUniformMatrix4(UniformId id, const Matrix4& mat)
 {
-    if(mProgram != GL_NONE)
+    Uniform* uniform = GetUniformForSet(id, mat, 16);
+    if(uniform != nullptr)
     {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform4f(vecLoc, vector.x, vector.y, vector.z, vector.w);
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, mat);
     }
 }
 
-void Shader::SetUniformMatrix4(const char* name, const Matrix4& mat)
+void Shader::SetUniformColor(UniformId id, const Color32& color)
 {
-    if(mProgram != GL_NONE)
+    float values[4] = { color.GetR() / 255.0f, color.GetG() / 255.0f, color.GetB() / 255.0f, color.GetA() / 255.0f };
+    Uniform* uniform = GetUniformForSet(id, values, 4);
+    if(uniform != nullptr)
     {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniformMatrix4fv(loc, 1, GL_FALSE, mat);
+        glUniform4f(uniform->location, values[0], values[1], values[2], values[3]);
     }
 }
 
-void Shader::SetUniformColor(const char* name, const Color32& color)
+bool Shader::HasUniform(UniformId id) const
 {
-    if(mProgram != GL_NONE)
+    for(auto& uniform : mUniforms)
     {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform4f(vecLoc, color.GetR() / 255.0f, color.GetG() / 255.0f, color.GetB() / 255.0f, color.GetA() / 255.0f);
+        if(uniform.id == id) { return true; }
     }
+    return false;
 }
 
 GLuint Shader::LoadAndCompileShaderFromFile(const char* filePath, GLuint shaderType)
@@ -204,32 +237,40 @@ bool Shader::IsProgramLinked(GLuint program)
     return true;
 }
 
-/*
 void Shader::RefreshUniforms()
 {
+    mUniforms.clear();
+    if(mProgram == GL_NONE) { return; }
+    
     // Save listing of uniforms used by this shader.
-    const GLsizei kMaxUniformNameLength = 32;
+    const GLsizei kMaxUniformNameLength = 64;
     GLchar uniformNameBuffer[kMaxUniformNameLength];
     GLsizei uniformNameLength = 0;
-    GLsizei uniformSize = 0;
+    GLint uniformSize = 0;
     GLenum uniformType = GL_NONE;
     
     GLint uniformCount = 0;
     glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, &uniformCount);
-    for(GLuint i = 0; i < uniformCount; ++i)
+    for(GLuint i = 0; i < static_cast<GLuint>(uniformCount); ++i)
     {
         glGetActiveUniform(mProgram, i, kMaxUniformNameLength, &uniformNameLength, &uniformSize, &uniformType, uniformNameBuffer);
         
         // If returned name length is 0, that means the uniform is not valid (compile/link failed?).
         if(uniformNameLength <= 0) { continue; }
         
-        // We only want to track user-defined uniforms.
-        // We want to ignore built-in OpenGL uniforms, which have "gl_" prefix.
-        // We want to ignore built-in G-Engine uniforms, which have a "g" prefix.
-        // So really, we can just ignore any uniform with a "g" prefix to cover both scenarios!
-        if(uniformNameLength > 0 && uniformNameBuffer[0] == 'g') { continue; }
-        printf("Uniform %d, Type %u, Name %s\n", i, uniformType, uniformNameBuffer);
-           
+        // Uniforms inside a uniform block (e.g. the global uniforms) don't have a location.
+        // Those are set via uniform buffer, so they don't need to be tracked here.
+        GLint location = glGetUniformLocation(mProgram, uniformNameBuffer);
+        if(location < 0) { continue; }
+        
+        // Array uniforms are reported as "name[0]" - we want to address them by "name".
+        std::string name(uniformNameBuffer, uniformNameLength);
+        std::size_t bracketIndex = name.find('[');
+        if(bracketIndex != std::string::npos)
+        {
+            name.erase(bracketIndex);
+        }
+        
         // Convert GLenum type to an actual enum type.
         UniformType type = UniformType::Unknown;
         switch(uniformType)
@@ -280,13 +321,35 @@ void Shader::RefreshUniforms()
         }
         
         // Create and save uniform info.
-        if(type != UniformType::Unknown)
+        // Even unknown types are saved, so they can still be set by location.
+        Uniform uniform;
+        uniform.type = type;
+        uniform.name = name;
+        uniform.id = HashUniformName(name.c_str());
+        uniform.location = location;
+        mUniforms.push_back(uniform);
+    }
+}
+
+Uniform* Shader::GetUniformForSet(UniformId id, const float* value, int valueCount)
+{
+    // Shaders have only a handful of uniforms, so a linear search of IDs is as fast as anything fancier.
+    for(auto& uniform : mUniforms)
+    {
+        if(uniform.id != id) { continue; }
+        
+        // If GL already has this value, no need to set it again.
+        std::size_t valueSize = valueCount * sizeof(float);
+        if(uniform.hasValue && memcmp(uniform.value, value, valueSize) == 0)
         {
-            Uniform uniform;
-            uniform.type = type;
-            uniform.name = std::string(uniformNameBuffer);
-            mUniforms.push_back(uniform);
+            return nullptr;
         }
+        memcpy(uniform.value, value, valueSize);
+        uniform.hasValue = true;
+        
+        // glUniform* calls affect the active program, so make sure that's us.
+        Activate();
+        return &uniform;
     }
+    return nullptr;
 }
-*/
@@ -6,6 +6,7 @@
 // A compiled and linked shader program.
 //
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -38,44 +39,97 @@ enum class UniformType
     //TODO: Add more as needed
 };
 
+// Uniforms are identified by a hash of their name.
+// The hash is constexpr, so IDs for known uniform names can be computed at compile time.
+typedef uint32_t UniformId;
+
+constexpr UniformId HashUniformName(const char* name)
+{
+    // FNV-1a, which is simple and has few collisions for short identifiers.
+    UniformId hash = 2166136261u;
+    while(*name != '\0')
+    {
+        hash ^= static_cast<unsigned char>(*name);
+        hash *= 16777619u;
+        ++name;
+    }
+    return hash;
+}
+
 struct Uniform
 {
     // Type of the uniform.
     UniformType type = UniformType::Unknown;
     
-    // Uniform name.
+    // Uniform name, and the ID derived from it.
     std::string name;
+    UniformId id = 0;
+    
+    // Location of the uniform in the linked shader program.
+    GLint location = -1;
+    
+    // The last value sent to GL for this uniform (big enough for a 4x4 matrix).
+    // Used to skip GL calls when a uniform is set to the value it already has.
+    bool hasValue = false;
+    float value[16];
 };
 
 class Shader
 {
 public:
+    // Per-frame uniforms (view/projection matrices) live in a uniform block shared by all shaders.
+    // Any shader declaring this block is bound to this binding point at link time.
+    static const char* kGlobalUniformsBlockName;
+    static const GLuint kGlobalUniformsBinding = 0;
+    
     Shader(const char* vertShaderPath, const char* fragShaderPath);
     ~Shader();
     
     void Activate();
     
-	void SetUniformInt(const char* name, int value);
-	void SetUniformFloat(const char* name, float value);
+	void SetUniformInt(const char* name, int value) { SetUniformInt(HashUniformName(name), value); }
+	void SetUniformFloat(const char* name, float value) { SetUniformFloat(HashUniformName(name), value); }
 	
-    void SetUniformVector3(const char* name, const Vector3& vector);
-	void SetUniformVector4(const char* name, const Vector4& vector);
+    void SetUniformVector3(const char* name, const Vector3& vector) { SetUniformVector3(HashUniformName(name), vector); }
+	void SetUniformVector4(const char* name, const Vector4& vector) { SetUniformVector4(HashUniformName(name), vector); }
+    
+    void SetUniformMatrix4(const char* name, const Matrix4& mat) { SetUniformMatrix4(HashUniformName(name), mat); }
     
-    void SetUniformMatrix4(const char* name, const Matrix4& mat);
+    void SetUniformColor(const char* name, const Color32& color) { SetUniformColor(HashUniformName(name), color); }
     
-    void SetUniformColor(const char* name, const Color32& color);
+    // Faster versions of the above, for callers that pre-hash uniform names.
+    void SetUniformInt(UniformId id, int value);
+    void SetUniformFloat(UniformId id, float value);
+    
+    void SetUniformVector3(UniformId id, const Vector3& vector);
+    void SetUniformVector4(UniformId id, const Vector4& vector);
+    
+    void SetUniformMatrix4(UniformId id, const Matrix4& mat);
+    
+    void SetUniformColor(UniformId id, const Color32& color);
+    
+    bool HasUniform(UniformId id) const;
     
     bool IsGood() const { return mProgram != GL_NONE; }
+    GLuint GetProgram() const { return mProgram; }
     
 private:
+    // The currently active shader program; avoids redundant glUseProgram calls.
+    static GLuint sActiveProgram;
+    
     // Handle to the compiled and linked GL shader program.
     GLuint mProgram = GL_NONE;
     
-    // Uniforms for this shader, excluding "built-in" ones.
-    //std::vector<Uniform> mUniforms;
+    // Active uniforms for this shader, reflected from the program after link.
+    // Uniforms that live in the global uniform block are not included.
+    std::vector<Uniform> mUniforms;
     
     GLuint LoadAndCompileShaderFromFile(const char* filePath, GLuint shaderType);
     
     bool IsShaderCompiled(GLuint shader);
     bool IsProgramLinked(GLuint program);
+    
+    void RefreshUniforms();
+    
+    Uniform* GetUniformForSet(UniformId id, const float* value, int valueCount);
 };
@@ -112,7 +112,7 @@ bool Submesh::GetTriangle(int index, Vector3& p0, Vector3& p1, Vector3& p2) cons
 	return false;
 }
 
-bool Submesh::Raycast(const Ray& ray)
+bool Submesh::Raycast(const Ray& ray, RaycastHit& hitInfo)
 {
 	if(mRenderMode != RenderMode::Triangles || mIndexes == nullptr)
 	{
@@ -120,21 +120,31 @@ bool Submesh::Raycast(const Ray& ray)
 		return false;
 	}
 	
-    RaycastHit hitInfo;
-	for(int i = 0; i < mIndexCount; i += 3)
+	UpdateRaycastBVH();
+	int triangleIndex = -1;
+	return mRaycastBVH.Raycast(ray, hitInfo.t, triangleIndex);
+}
+
+void Submesh::UpdateRaycastBVH()
+{
+	if(!mRaycastBVHNeedsBuild && !mRaycastBVHNeedsRefit) { return; }
+	if(mRenderMode != RenderMode::Triangles || mIndexes == nullptr) { return; }
+	
+	std::vector<Triangle> triangles(GetTriangleCount());
+	for(int i = 0; i < triangles.size(); i++)
 	{
-		Vector3 vert1 = GetVertexPosition(mIndexes[i]);
-		Vector3 vert2 = GetVertexPosition(mIndexes[i + 1]);
-		Vector3 vert3 = GetVertexPosition(mIndexes[i + 2]);
-		
-		if(Collisions::TestRayTriangle(ray, vert1, vert2, vert3, hitInfo))
-		{
-			return true;
-		}
+		GetTriangle(i, triangles[i].p0, triangles[i].p1, triangles[i].p2);
 	}
-	
-	// Ray did not hit any triangles.
-	return false;
+	if(mRaycastBVHNeedsBuild)
+	{
+		mRaycastBVH.Build(triangles);
+	}
+	else
+	{
+		mRaycastBVH.Refit(triangles);
+	}
+	mRaycastBVHNeedsBuild = false;
+	mRaycastBVHNeedsRefit = false;
 }
 
 void Submesh::SetPositions(float* positions, bool createCopy)
@@ -153,6 +163,17 @@ void Submesh::SetPositions(float* positions, bool createCopy)
         mPositions = positions;
     }
     mVertexArray.ChangeVertexData(VertexAttribute::Semantic::Position, mPositions);
+    mRaycastBVHNeedsRefit = true;
+    
+    // Explicitly set positions should be rendered, so stop using any GPU keyframes.
+    mVertexArray.ClearPositionKeyframes();
+}
+
+void Submesh::SetPositionKeyframes(GLuint buffer, int fromIndex, int toIndex)
+{
+    // Each keyframe in the buffer is a full set of positions for this submesh.
+    unsigned int keyframeSize = mVertexCount * 3 * sizeof(float);
+    mVertexArray.SetPositionKeyframes(buffer, fromIndex * keyframeSize, toIndex * keyframeSize);
 }
 
 void Submesh::SetColors(float* colors, bool createCopy)
@@ -225,4 +246,5 @@ void Submesh::SetIndexes(unsigned short* indexes, bool createCopy)
         mIndexes = indexes;
     }
     mVertexArray.ChangeIndexData(mIndexes, mIndexCount);
+    mRaycastBVHNeedsBuild = true;
 }
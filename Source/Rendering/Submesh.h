@@ -9,10 +9,12 @@
 #pragma once
 #include <string>
 
+#include "TriangleBVH.h"
 #include "Vector3.h"
 #include "VertexArray.h"
 
 class Ray;
+struct RaycastHit;
 
 enum class RenderMode
 {
@@ -40,11 +42,19 @@ public:
 	int GetTriangleCount() const;
 	bool GetTriangle(int index, Vector3& p0, Vector3& p1, Vector3& p2) const;
 	
-	bool Raycast(const Ray& ray);
+	// Finds the nearest triangle the ray hits, if closer than hitInfo.t. Updates hitInfo.t if so.
+	bool Raycast(const Ray& ray, RaycastHit& hitInfo);
+	
+	// Builds (or updates) the tree used for raycasts. This happens on the first raycast otherwise, but loading is a better time.
+	void UpdateRaycastBVH();
     
     void SetPositions(float* positions, bool createCopy = false);
     float* GetPositions() { return mPositions; }
     
+    // Renders positions blended between two keyframes stored in a GPU buffer, rather than positions set above.
+    // Requires a shader that blends "vPos" and "vPos2". Calling SetPositions switches back to normal rendering.
+    void SetPositionKeyframes(GLuint buffer, int fromIndex, int toIndex);
+    
     void SetNormals(float* normals, bool createCopy = false);
     float* GetNormals() { return mNormals; }
     
@@ -82,6 +92,12 @@ private:
     // Vertex array that actually renders using the underlying rendering system.
     VertexArray mVertexArray;
     
+    // Triangles in a tree, for raycasts.
+    // New indexes mean a full rebuild, but new positions (e.g. animation) just need the tree's bounds updated.
+    TriangleBVH mRaycastBVH;
+    bool mRaycastBVHNeedsBuild = true;
+    bool mRaycastBVHNeedsRefit = false;
+    
 	// Name of the default texture to use for this submesh.
 	std::string mTextureName;
 };
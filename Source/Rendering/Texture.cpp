@@ -5,13 +5,109 @@
 //
 #include "Texture.h"
 
+#include <climits>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 #include <SDL2/SDL.h>
 
 #include "BinaryReader.h"
 #include "BinaryWriter.h"
 #include "GMath.h"
+#include "PixelDecode.h"
+#include "RenderStats.h"
+#include "Services.h"
+#include "SIMD.h"
+#include "TextureCompression.h"
+
+namespace
+{
+	// Blends a row of RGBA source pixels into dest pixels, based on source alpha. Dest alpha is left as-is.
+	// Each channel is (src * a + dst * (255 - a)) / 255, rounded, in integer math.
+	void BlendRow(const unsigned char* src, unsigned char* dst, int pixelCount)
+	{
+		int i = 0;
+		
+		#if defined(SIMD_SSE)
+		{
+			// 4 pixels at a time, each half widened to 16-bit lanes so the multiplies don't overflow.
+			const __m128i kZero = _mm_setzero_si128();
+			const __m128i k255 = _mm_set1_epi16(255);
+			const __m128i kHalf = _mm_set1_epi16(128);
+			const __m128i kAlphaMask = _mm_set1_epi32(0xFF000000);
+			for(; i + 4 <= pixelCount; i += 4)
+			{
+				__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+				__m128i dest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+				
+				__m128i blended[2];
+				for(int half = 0; half < 2; ++half)
+				{
+					__m128i s = half == 0 ? _mm_unpacklo_epi8(source, kZero) : _mm_unpackhi_epi8(source, kZero);
+					__m128i d = half == 0 ? _mm_unpacklo_epi8(dest, kZero) : _mm_unpackhi_epi8(dest, kZero);
+					
+					// Copy each pixel's alpha to all four of its lanes.
+					__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+					
+					// Divide by 255 with rounding as (t + (t >> 8)) >> 8, which is exact for this range.
+					__m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(k255, a))), kHalf);
+					blended[half] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+				}
+				
+				// Keep dest's alpha.
+				__m128i result = _mm_packus_epi16(blended[0], blended[1]);
+				result = _mm_or_si128(_mm_and_si128(kAlphaMask, dest), _mm_andnot_si128(kAlphaMask, result));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+			}
+		}
+		#elif defined(SIMD_NEON)
+		{
+			// 8 pixels at a time, deinterleaved so each channel has its own register.
+			const uint16x8_t kHalf = vdupq_n_u16(128);
+			for(; i + 8 <= pixelCount; i += 8)
+			{
+				uint8x8x4_t source = vld4_u8(src + i * 4);
+				uint8x8x4_t dest = vld4_u8(dst + i * 4);
+				uint8x8_t a = source.val[3];
+				uint8x8_t inverseA = vmvn_u8(a);
+				for(int c = 0; c < 3; ++c)
+				{
+					uint16x8_t t = vaddq_u16(vmlal_u8(vmull_u8(source.val[c], a), dest.val[c], inverseA), kHalf);
+					dest.val[c] = vaddhn_u16(t, vshrq_n_u16(t, 8));
+				}
+				vst4_u8(dst + i * 4, dest);
+			}
+		}
+		#endif
+		
+		// Scalar for whatever is left (or everything, without SIMD).
+		for(; i < pixelCount; ++i)
+		{
+			const unsigned char* s = src + i * 4;
+			unsigned char* d = dst + i * 4;
+			unsigned int a = s[3];
+			for(int c = 0; c < 3; ++c)
+			{
+				unsigned int t = s[c] * a + d[c] * (255 - a) + 128;
+				d[c] = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+			}
+		}
+	}
+}
+
+GLuint Texture::sBoundTextureIds[Texture::kMaxTrackedTextureUnits] = { GL_NONE };
+
+GLuint Texture::sUploadBuffers[Texture::kUploadBufferCount] = { GL_NONE };
+unsigned int Texture::sUploadBufferSizes[Texture::kUploadBufferCount] = { 0 };
+int Texture::sNextUploadBuffer = 0;
+
+float Texture::sAnisotropy = 1.0f;
+
+bool Texture::sCompressStaticTextures = false;
+
+size_t Texture::sTotalCPUMemoryBytes = 0;
+size_t Texture::sTotalGPUMemoryBytes = 0;
 
 Texture Texture::White(2, 2, Color32::White);
 Texture Texture::Black(2, 2, Color32::Black);
@@ -24,6 +120,7 @@ Texture::Texture(unsigned int width, unsigned int height) :
     // Create pixel array of desired size.
     int pixelsSize = mWidth * mHeight * 4;
     mPixels = new unsigned char[pixelsSize];
+    SetMemoryUsage(CalculateCPUMemoryBytes(), 0);
 }
 
 Texture::Texture(unsigned int width, unsigned int height, Color32 color) :
@@ -43,55 +140,66 @@ Texture::Texture(unsigned int width, unsigned int height, Color32 color) :
 		mPixels[i + 2] = color.GetB();
 		mPixels[i + 3] = color.GetA();
 	}
+	SetMemoryUsage(CalculateCPUMemoryBytes(), 0);
 }
 
 Texture::Texture(std::string name, char* data, int dataLength) :
-    Asset(name)
+    Asset(name),
+    mMipmaps(true)
 {
 	BinaryReader reader(data, dataLength);
     ParseFromData(reader);
+    SetMemoryUsage(CalculateCPUMemoryBytes(), 0);
 }
 
 Texture::Texture(BinaryReader& reader) :
-    Asset("")
+    Asset(""),
+    mMipmaps(true)
 {
     ParseFromData(reader);
+    SetMemoryUsage(CalculateCPUMemoryBytes(), 0);
 }
 
 Texture::~Texture()
 {
 	if(mTextureId != GL_NONE)
 	{
+		// Deleting unbinds the texture, and GL may reuse the name - forget any tracked bindings.
+		for(int i = 0; i < kMaxTrackedTextureUnits; ++i)
+		{
+			if(sBoundTextureIds[i] == mTextureId)
+			{
+				sBoundTextureIds[i] = GL_NONE;
+			}
+		}
 		glDeleteTextures(1, &mTextureId);
 	}
-	if(mPalette != nullptr)
-	{
-		delete[] mPalette;
-		mPalette = nullptr;
-	}
-	if(mPaletteIndexes != nullptr)
-	{
-		delete[] mPaletteIndexes;
-		mPaletteIndexes = nullptr;
-	}
-	if(mPixels != nullptr)
-	{
-		delete[] mPixels;
-		mPixels = nullptr;
-	}
+	FreeCPUData();
+	SetMemoryUsage(0, 0);
 }
 
 void Texture::Activate(int textureUnit)
 {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    
     if(mDirty)
     {
+        // Uploading binds the texture, so make sure that happens on the desired unit.
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
         UploadToGPU();
         mDirty = false;
     }
     
+    // Skip the bind if this texture is already bound to the unit.
+    bool tracked = textureUnit >= 0 && textureUnit < kMaxTrackedTextureUnits;
+    if(tracked && mTextureId != GL_NONE && sBoundTextureIds[textureUnit] == mTextureId) { return; }
+    
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(GL_TEXTURE_2D, mTextureId);
+    ++RenderStats::sCurrent.textureBindCount;
+    
+    if(tracked)
+    {
+        sBoundTextureIds[textureUnit] = mTextureId;
+    }
 }
 
 void Texture::Deactivate()
@@ -106,6 +214,7 @@ SDL_Surface* Texture::GetSurface()
 
 SDL_Surface* Texture::GetSurface(int x, int y, int width, int height)
 {
+    RestoreCPUData();
     unsigned int rmask, gmask, bmask, amask;
     #if SDL_BYTEORDER == SDL_BIG_ENDIAN
     int shift = 0;
@@ -132,8 +241,17 @@ SDL_Surface* Texture::GetSurface(int x, int y, int width, int height)
     return surface;
 }
 
+unsigned char* Texture::GetPixelData()
+{
+	RestoreCPUData();
+	return mPixels;
+}
+
 Color32 Texture::GetPixelColor32(int x, int y)
 {
+	// If pixels were freed after upload, this brings them back.
+	RestoreCPUData();
+	
 	// No pixels means...just return black.
 	if(mPixels == nullptr) { return Color32::Black; }
 	
@@ -152,6 +270,9 @@ Color32 Texture::GetPixelColor32(int x, int y)
 
 unsigned char Texture::GetPaletteIndex(int x, int y)
 {
+	// If palette indexes were freed after upload, this brings them back.
+	RestoreCPUData();
+	
 	// No palette indexes means we can't get a value!
 	if(mPaletteIndexes == nullptr) { return 0; }
 	
@@ -183,60 +304,48 @@ void Texture::Blit(Texture* source, int destX, int destY)
 }
 */
  
-void Texture::BlendPixels(const Texture& source, Texture& dest, int destX, int destY)
+void Texture::BlendPixels(Texture& source, Texture& dest, int destX, int destY)
 {
 	BlendPixels(source, 0, 0, source.mWidth, source.mHeight, dest, destX, destY);
 }
 
-void Texture::BlendPixels(const Texture& source, int sourceX, int sourceY, int sourceWidth, int sourceHeight,
+void Texture::BlendPixels(Texture& source, int sourceX, int sourceY, int sourceWidth, int sourceHeight,
 					     Texture& dest, int destX, int destY)
 {
-	// We can't copy out-of-bounds pixels from the source.
-	if(sourceX < 0 || sourceX >= static_cast<int>(source.mWidth)) { return; }
-	if(sourceY < 0 || sourceY >= static_cast<int>(source.mHeight)) { return; }
-	
-	// We can't copy to out-of-bounds pixels in the destination.
-	if(destX < 0 || destX >= static_cast<int>(dest.mWidth)) { return; }
-	if(destY < 0 || destY >= static_cast<int>(dest.mHeight)) { return; }
-	
-	// Brute force copy, pixel by pixel!
-	for(int y = sourceY; y < sourceY + sourceHeight && y < static_cast<int>(source.mHeight); ++y)
+	// Clip the copy rect to the source texture. Moving the source edge moves the dest edge equally.
+	if(sourceX < 0) { sourceWidth += sourceX; destX -= sourceX; sourceX = 0; }
+	if(sourceY < 0) { sourceHeight += sourceY; destY -= sourceY; sourceY = 0; }
+	sourceWidth = Math::Min(sourceWidth, static_cast<int>(source.mWidth) - sourceX);
+	sourceHeight = Math::Min(sourceHeight, static_cast<int>(source.mHeight) - sourceY);
+	
+	// Clip again to the dest texture.
+	if(destX < 0) { sourceWidth += destX; sourceX -= destX; destX = 0; }
+	if(destY < 0) { sourceHeight += destY; sourceY -= destY; destY = 0; }
+	sourceWidth = Math::Min(sourceWidth, static_cast<int>(dest.mWidth) - destX);
+	sourceHeight = Math::Min(sourceHeight, static_cast<int>(dest.mHeight) - destY);
+	
+	// Nothing left to copy?
+	if(sourceWidth <= 0 || sourceHeight <= 0) { return; }
+	
+	// Both textures need pixels on the CPU.
+	if(!source.RestoreCPUData() || !dest.RestoreCPUData()) { return; }
+	
+	// Everything in range, so blend a row at a time with no further checks.
+	for(int y = 0; y < sourceHeight; ++y)
 	{
-		for(int x = sourceX; x < sourceX + sourceWidth && x < static_cast<int>(source.mWidth); ++x)
-		{
-			// Calculate source pixel index.
-			int sourcePixelIndex = (y * source.mWidth + x) * 4;
-			
-			// Calculate dest x/y for this pixel.
-			int copyToY = destY + (y - sourceY);
-			int copyToX = destX + (x - sourceX);
-			if(copyToY < 0 || copyToY >= dest.mHeight) { continue; }
-			if(copyToX < 0 || copyToY >= dest.mWidth) { continue; }
-			
-			// Calculate dest pixel index based on x/y.
-			int destPixelIndex = (copyToY * dest.mWidth + copyToX) * 4;
-			
-			// Interpolate between source/dest pixel colors based on source alpha value.
-			// If source alpha is zero, use 100% dest color - this value will be 0.
-			// If source alpha is 255, use 100% source color - this value will be 1.
-			// If source alpha is between, use X% dest/source color - this value is 0-1.
-			float alphaPercent = (float)source.mPixels[sourcePixelIndex + 3] / 255.0f;
-			
-			// Copy!
-			dest.mPixels[destPixelIndex] = Math::Lerp(dest.mPixels[destPixelIndex], source.mPixels[sourcePixelIndex], alphaPercent);
-			dest.mPixels[destPixelIndex + 1] = Math::Lerp(dest.mPixels[destPixelIndex + 1], source.mPixels[sourcePixelIndex + 1], alphaPercent);
-			dest.mPixels[destPixelIndex + 2] = Math::Lerp(dest.mPixels[destPixelIndex + 2], source.mPixels[sourcePixelIndex + 2], alphaPercent);
-			// Don't make any changes to dest's alpha channel.
-		}
+		const unsigned char* sourceRow = source.mPixels + ((sourceY + y) * source.mWidth + sourceX) * 4;
+		unsigned char* destRow = dest.mPixels + ((destY + y) * dest.mWidth + destX) * 4;
+		BlendRow(sourceRow, destRow, sourceWidth);
 	}
 	
 	// Don't upload dest to GPU here, since we might be doing a bunch of copy operations in a row.
-	// We'll leave it up to the caller to do that manually (for now).
+	// But do remember what changed, so only that part needs to be uploaded.
+	dest.AddDirtyRect(destX, destY, sourceWidth, sourceHeight);
 }
 
 void Texture::SetTransparentColor(Color32 color)
 {
-	if(mPixels == nullptr) { return; }
+	if(!RestoreCPUData()) { return; }
 	
 	// Find instances of the desired transparent color and
 	// make sure the alpha value is zero.
@@ -257,9 +366,10 @@ void Texture::SetTransparentColor(Color32 color)
 	
     // Mark dirty so it uploads to GPU on next use.
     mDirty = true;
+    AddDirtyRect(0, 0, mWidth, mHeight);
 }
 
-void Texture::ApplyAlphaChannel(const Texture& alphaTexture)
+void Texture::ApplyAlphaChannel(Texture& alphaTexture)
 {
 	// For now, let's assume alpha texture has same width/height as target texture.
 	if(alphaTexture.mWidth != mWidth || alphaTexture.mHeight != mHeight)
@@ -268,6 +378,9 @@ void Texture::ApplyAlphaChannel(const Texture& alphaTexture)
 		return;
 	}
 	
+	// Both textures need pixels on the CPU.
+	if(!RestoreCPUData() || !alphaTexture.RestoreCPUData()) { return; }
+	
 	// If the alpha texture has a palette, we want to treat the R/G/B values as the alpha value.
 	// Palettized textures as alpha channels usually have palette colors like (255, 255, 255, 0) or (128, 128, 128, 0).
 	// At least, that's the case in GK3!
@@ -281,10 +394,39 @@ void Texture::ApplyAlphaChannel(const Texture& alphaTexture)
 		unsigned char alpha = useRgbForAlpha ? alphaTexture.mPixels[(i * 4)] : alphaTexture.mPixels[(i * 4) + 3];
 		mPixels[(i * 4) + 3] = alpha;
 	}
+	AddDirtyRect(0, 0, mWidth, mHeight);
+}
+
+void Texture::SetAnisotropy(float anisotropy)
+{
+	// Anisotropic filtering is an extension, though a very widely supported one.
+	if(!GLEW_EXT_texture_filter_anisotropic)
+	{
+		sAnisotropy = 1.0f;
+		return;
+	}
+	GLfloat maxAnisotropy = 1.0f;
+	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+	sAnisotropy = Math::Clamp(anisotropy, 1.0f, maxAnisotropy);
 }
 
 void Texture::UploadToGPU()
 {
+	// Nothing to upload if pixels were never loaded, or were freed after a previous upload.
+	if(mPixels == nullptr) { return; }
+	
+	// Uploading binds this texture to whatever unit is active, which we don't track.
+	// So, tracked bindings can't be trusted after this.
+	for(int i = 0; i < kMaxTrackedTextureUnits; ++i)
+	{
+		sBoundTextureIds[i] = GL_NONE;
+	}
+	
+	// Static textures are uploaded once, and then the CPU-side copy is no longer needed.
+	// Unnamed textures (e.g. BSP lightmaps) have no asset to reload pixels from, so they keep theirs.
+	bool freeAfterUpload = mStatic && !mKeepPixels && !mName.empty();
+	unsigned int gpuMemoryBytes = mGPUMemoryBytes;
+	
 	if(mTextureId == GL_NONE)
 	{
 		// Generate and bind the texture object in OpenGL.
@@ -295,13 +437,45 @@ void Texture::UploadToGPU()
         // OpenGL assumes that pixel data is from bottom-left, BUT our pixels array is from top-left!
         // You'd think this would lead to upside-down textures in-game...BUT GK3 uses DirectX style UVs (from top-left).
         // So, this "double inversion" actually leads to textures displaying correctly in OpenGL.
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-					 mWidth, mHeight, 0,
-					 GL_RGBA, GL_UNSIGNED_BYTE, mPixels);
+		// Textures that never change can be compressed, if desired and supported.
+		if(freeAfterUpload && sCompressStaticTextures && GLEW_EXT_texture_compression_s3tc)
+		{
+			gpuMemoryBytes = UploadCompressed();
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+						 mWidth, mHeight, 0,
+						 GL_RGBA, GL_UNSIGNED_BYTE, mPixels);
+			RenderStats::sCurrent.textureUploadBytes += mWidth * mHeight * 4;
+			
+			// Mipmaps add about a third more memory.
+			gpuMemoryBytes = mWidth * mHeight * 4;
+			if(mMipmaps)
+			{
+				glGenerateMipmap(GL_TEXTURE_2D);
+				for(unsigned int width = mWidth, height = mHeight; width > 1 || height > 1; )
+				{
+					width = Math::Max(static_cast<int>(width / 2), 1);
+					height = Math::Max(static_cast<int>(height / 2), 1);
+					gpuMemoryBytes += width * height * 4;
+				}
+			}
+		}
 		
 		// Set filter mode for the texture.
+		// Mipmaps keep minified textures from aliasing, but point filtering still picks a single mip and texel.
         GLfloat filterParam = mFilterMode == FilterMode::Point ? GL_NEAREST : GL_LINEAR;
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterParam);
+        GLfloat minFilterParam = filterParam;
+        if(mMipmaps)
+        {
+            minFilterParam = mFilterMode == FilterMode::Point ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+            if(sAnisotropy > 1.0f)
+            {
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, sAnisotropy);
+            }
+        }
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilterParam);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterParam);
         
         // Set wrap mode for the texture.
@@ -311,12 +485,264 @@ void Texture::UploadToGPU()
 	}
 	else
 	{
+		// If we don't know what changed, everything did.
+		if(mDirtyRectCount == 0)
+		{
+			AddDirtyRect(0, 0, mWidth, mHeight);
+		}
+		
 		// Update texture data on GPU.
 		glBindTexture(GL_TEXTURE_2D, mTextureId);
+		UploadDirtyRects();
+		if(mMipmaps)
+		{
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+	}
+	
+	// GPU is up-to-date.
+	mDirtyRectCount = 0;
+	
+	if(freeAfterUpload)
+	{
+		FreeCPUData();
+		mCPUDataFreed = true;
+	}
+	SetMemoryUsage(CalculateCPUMemoryBytes(), gpuMemoryBytes);
+}
+
+unsigned int Texture::UploadCompressed()
+{
+	// Any alpha at all needs BC3. Otherwise, BC1 is half the size.
+	bool hasAlpha = false;
+	int pixelCount = mWidth * mHeight;
+	for(int i = 0; i < pixelCount && !hasAlpha; ++i)
+	{
+		hasAlpha = mPixels[i * 4 + 3] != 255;
+	}
+	GLenum format = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	
+	// GL can't reliably generate mipmaps for compressed textures, so generate and compress each level ourselves.
+	std::vector<uint8_t> levelPixels;
+	std::vector<uint8_t> nextLevelPixels;
+	std::vector<uint8_t> compressed;
+	const uint8_t* pixels = mPixels;
+	int width = mWidth;
+	int height = mHeight;
+	unsigned int gpuMemoryBytes = 0;
+	for(int level = 0; ; ++level)
+	{
+		int size = hasAlpha ? TextureCompression::GetBC3Size(width, height) : TextureCompression::GetBC1Size(width, height);
+		compressed.resize(size);
+		if(hasAlpha)
+		{
+			TextureCompression::EncodeBC3(pixels, width, height, compressed.data());
+		}
+		else
+		{
+			TextureCompression::EncodeBC1(pixels, width, height, compressed.data());
+		}
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, size, compressed.data());
+		RenderStats::sCurrent.textureUploadBytes += size;
+		gpuMemoryBytes += size;
+		
+		// Stop after the smallest level (or the first, without mipmaps).
+		if(!mMipmaps || (width == 1 && height == 1)) { break; }
+		
+		int halfWidth = Math::Max(width / 2, 1);
+		int halfHeight = Math::Max(height / 2, 1);
+		nextLevelPixels.resize(halfWidth * halfHeight * 4);
+		TextureCompression::HalveRGBA8(pixels, width, height, nextLevelPixels.data());
+		levelPixels.swap(nextLevelPixels);
+		pixels = levelPixels.data();
+		width = halfWidth;
+		height = halfHeight;
+	}
+	return gpuMemoryBytes;
+}
+
+void Texture::UploadDirtyRects()
+{
+	unsigned int byteCount = 0;
+	for(int i = 0; i < mDirtyRectCount; ++i)
+	{
+		const DirtyRect& rect = mDirtyRects[i];
+		byteCount += (rect.maxX - rect.minX) * (rect.maxY - rect.minY) * 4;
+	}
+	RenderStats::sCurrent.textureUploadBytes += byteCount;
+	
+	// Copy changed pixels into the next buffer in the ring, and have GL upload from there.
+	// GL can then copy to the texture whenever it likes, rather than the CPU waiting for it to finish.
+	// Invalidating the buffer lets GL hand us fresh memory if the old contents are still in use.
+	if(sUploadBuffers[0] == GL_NONE)
+	{
+		glGenBuffers(kUploadBufferCount, sUploadBuffers);
+	}
+	int bufferIndex = sNextUploadBuffer;
+	sNextUploadBuffer = (sNextUploadBuffer + 1) % kUploadBufferCount;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sUploadBuffers[bufferIndex]);
+	if(sUploadBufferSizes[bufferIndex] < byteCount)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, byteCount, nullptr, GL_STREAM_DRAW);
+		sUploadBufferSizes[bufferIndex] = byteCount;
+	}
+	
+	unsigned char* mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, byteCount,
+																		  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if(mapped != nullptr)
+	{
+		// Each rect's rows are packed together in the buffer, one rect after another.
+		unsigned char* rectStart = mapped;
+		for(int i = 0; i < mDirtyRectCount; ++i)
+		{
+			const DirtyRect& rect = mDirtyRects[i];
+			int rowByteCount = (rect.maxX - rect.minX) * 4;
+			for(int y = rect.minY; y < rect.maxY; ++y)
+			{
+				memcpy(rectStart + (y - rect.minY) * rowByteCount, mPixels + (y * mWidth + rect.minX) * 4, rowByteCount);
+			}
+			rectStart += rowByteCount * (rect.maxY - rect.minY);
+		}
+		
+		if(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+		{
+			// With a buffer bound, the "pixels" argument is an offset into the buffer.
+			size_t offset = 0;
+			for(int i = 0; i < mDirtyRectCount; ++i)
+			{
+				const DirtyRect& rect = mDirtyRects[i];
+				glTexSubImage2D(GL_TEXTURE_2D, 0,
+								rect.minX, rect.minY, rect.maxX - rect.minX, rect.maxY - rect.minY,
+								GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+				offset += (rect.maxX - rect.minX) * (rect.maxY - rect.minY) * 4;
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+			return;
+		}
+	}
+	
+	// Couldn't use the buffer (mapping failed or its contents were lost), so upload straight from our pixels array.
+	// Row length lets GL step through our pixels array, skipping pixels outside each rect.
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, mWidth);
+	for(int i = 0; i < mDirtyRectCount; ++i)
+	{
+		const DirtyRect& rect = mDirtyRects[i];
 		glTexSubImage2D(GL_TEXTURE_2D, 0,
-						0, 0, mWidth, mHeight,
-						GL_RGBA, GL_UNSIGNED_BYTE, mPixels);
+						rect.minX, rect.minY, rect.maxX - rect.minX, rect.maxY - rect.minY,
+						GL_RGBA, GL_UNSIGNED_BYTE, mPixels + (rect.minY * mWidth + rect.minX) * 4);
 	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void Texture::AddDirtyRect(int x, int y, int width, int height)
+{
+	DirtyRect newRect { x, y, x + width, y + height };
+	
+	// Absorb any dirty rects this one overlaps or touches - one upload of both beats two uploads of overlapping pixels.
+	// Growing might make the rect overlap others, so keep going until nothing changes.
+	for(int i = 0; i < mDirtyRectCount; ++i)
+	{
+		DirtyRect& rect = mDirtyRects[i];
+		if(newRect.minX <= rect.maxX && rect.minX <= newRect.maxX &&
+		   newRect.minY <= rect.maxY && rect.minY <= newRect.maxY)
+		{
+			newRect.minX = Math::Min(newRect.minX, rect.minX);
+			newRect.minY = Math::Min(newRect.minY, rect.minY);
+			newRect.maxX = Math::Max(newRect.maxX, rect.maxX);
+			newRect.maxY = Math::Max(newRect.maxY, rect.maxY);
+			rect = mDirtyRects[--mDirtyRectCount];
+			i = -1;
+		}
+	}
+	
+	// Out of room? Merge with whichever rect grows the least.
+	if(mDirtyRectCount == kMaxDirtyRects)
+	{
+		int bestIndex = 0;
+		int bestArea = INT_MAX;
+		for(int i = 0; i < mDirtyRectCount; ++i)
+		{
+			const DirtyRect& rect = mDirtyRects[i];
+			int area = (Math::Max(newRect.maxX, rect.maxX) - Math::Min(newRect.minX, rect.minX)) *
+					   (Math::Max(newRect.maxY, rect.maxY) - Math::Min(newRect.minY, rect.minY)) -
+					   (rect.maxX - rect.minX) * (rect.maxY - rect.minY);
+			if(area < bestArea)
+			{
+				bestArea = area;
+				bestIndex = i;
+			}
+		}
+		
+		const DirtyRect& rect = mDirtyRects[bestIndex];
+		newRect.minX = Math::Min(newRect.minX, rect.minX);
+		newRect.minY = Math::Min(newRect.minY, rect.minY);
+		newRect.maxX = Math::Max(newRect.maxX, rect.maxX);
+		newRect.maxY = Math::Max(newRect.maxY, rect.maxY);
+		mDirtyRects[bestIndex] = mDirtyRects[--mDirtyRectCount];
+	}
+	mDirtyRects[mDirtyRectCount++] = newRect;
+}
+
+void Texture::FreeCPUData()
+{
+	delete[] mPixels;
+	mPixels = nullptr;
+	delete[] mPalette;
+	mPalette = nullptr;
+	mPaletteColorCount = 0;
+	delete[] mPaletteIndexes;
+	mPaletteIndexes = nullptr;
+}
+
+bool Texture::RestoreCPUData()
+{
+	if(!mCPUDataFreed) { return mPixels != nullptr; }
+	mCPUDataFreed = false;
+	
+	// Something reads this texture on the CPU after all, so reload the pixels from the asset.
+	// Keep them from now on - the GPU copy doesn't need to change, it's the same data.
+	mKeepPixels = true;
+	unsigned int bufferSize = 0;
+	char* buffer = Services::GetAssets()->LoadRaw(mName, bufferSize);
+	if(buffer == nullptr)
+	{
+		std::cout << "Couldn't reload pixels for texture " << mName << " - they were freed after upload." << std::endl;
+		return false;
+	}
+	BinaryReader reader(buffer, bufferSize);
+	ParseFromData(reader);
+	delete[] buffer;
+	
+	SetMemoryUsage(CalculateCPUMemoryBytes(), mGPUMemoryBytes);
+	return mPixels != nullptr;
+}
+
+unsigned int Texture::CalculateCPUMemoryBytes() const
+{
+	unsigned int cpuMemoryBytes = 0;
+	if(mPixels != nullptr)
+	{
+		cpuMemoryBytes += mWidth * mHeight * 4;
+	}
+	if(mPalette != nullptr)
+	{
+		cpuMemoryBytes += mPaletteColorCount * 4;
+	}
+	if(mPaletteIndexes != nullptr)
+	{
+		cpuMemoryBytes += mWidth * mHeight;
+	}
+	return cpuMemoryBytes;
+}
+
+void Texture::SetMemoryUsage(unsigned int cpuMemoryBytes, unsigned int gpuMemoryBytes)
+{
+	// Totals are adjusted by how much this texture changed since last time.
+	sTotalCPUMemoryBytes = sTotalCPUMemoryBytes - mCPUMemoryBytes + cpuMemoryBytes;
+	sTotalGPUMemoryBytes = sTotalGPUMemoryBytes - mGPUMemoryBytes + gpuMemoryBytes;
+	mCPUMemoryBytes = cpuMemoryBytes;
+	mGPUMemoryBytes = gpuMemoryBytes;
 }
 
 void Texture::WriteToFile(std::string filePath)
@@ -413,43 +839,20 @@ void Texture::ParseFromCompressedFormat(BinaryReader& reader)
 	// Allocate pixels array.
 	mPixels = new unsigned char[mWidth * mHeight * 4];
     
-    // Read in pixel data.
+    // Read in all pixel data at once. Each row is padded to an even number of pixels.
+	int rowPixelCount = mWidth + (mWidth & 1);
+	std::vector<uint8_t> rawPixels(rowPixelCount * mHeight * 2);
+	reader.Read(rawPixels.data(), static_cast<int>(rawPixels.size()));
+	
+    // Convert a row at a time.
     // This pixel data is stored top-left to bottom-right, so we don't flip (our pixel array starts at top-left corner).
+	// Magenta pixels are made transparent - if there are any, this texture needs alpha testing.
+	bool anyTransparent = false;
 	for(int y = 0; y < mHeight; ++y)
 	{
-		for(int x = 0; x < mWidth; ++x)
-		{
-			int current = (y  * mWidth + x) * 4;
-			uint16_t pixel = reader.ReadUShort();
-			
-			float red = static_cast<float>((pixel & 0xF800) >> 11);
-			float green = static_cast<float>((pixel & 0x07E0) >> 5);
-			float blue = static_cast<float>((pixel & 0x001F));
-            
-			mPixels[current] = (unsigned char)(red * 255 / 31);
-			mPixels[current + 1] = (unsigned char)(green * 255 / 63);
-			mPixels[current + 2] = (unsigned char)(blue * 255 / 31);
-			
-			// Causes all instances of magenta (R = 255, B = 255) to appear transparent.
-			if(mPixels[current] > 200 && mPixels[current + 1] < 100 && mPixels[current + 2] > 200)
-			{
-				mPixels[current + 3] = 0;
-			}
-			else
-			{
-				mPixels[current + 3] = 255;
-			}
-		}
-		
-		// Might need to skip some padding here.
-		if((mWidth & 0x00000001) != 0)
-		{
-			reader.ReadUShort();
-		}
+		anyTransparent |= PixelDecode::RGB565ToRGBA8(&rawPixels[y * rowPixelCount * 2], mWidth, &mPixels[y * mWidth * 4]);
 	}
-	
-	// This seeeeems to work consistently - if the top-left pixel has no alpha, flag as alpha test.
-	if(mHeight > 0 && mWidth > 0 && mPixels[3] == 0)
+	if(anyTransparent)
 	{
 		mRenderType = RenderType::AlphaTest;
 	}
@@ -523,6 +926,7 @@ void Texture::ParseFromBmpFormat(BinaryReader& reader)
 		// The number of bytes is numColors in palette, time 4 bytes each.
 		// The order of the colors is blue, green, red, alpha.
 		mPalette = new unsigned char[numColorsInColorPalette * 4];
+		mPaletteColorCount = numColorsInColorPalette;
 		reader.Read(mPalette, numColorsInColorPalette * 4);
 		
 		/*
@@ -545,68 +949,40 @@ void Texture::ParseFromBmpFormat(BinaryReader& reader)
 		mPaletteIndexes = new unsigned char[mWidth * mHeight];
 	}
 	
-	// Read in pixel data.
+	// Palette colors are converted to RGBA once, up front, rather than for every pixel.
+	uint32_t paletteTable[256];
+	if(bitsPerPixel == 8)
+	{
+		PixelDecode::BuildPaletteTable(mPalette, numColorsInColorPalette, paletteTable);
+	}
+	else if(bitsPerPixel != 24 && bitsPerPixel != 32)
+	{
+		std::cout << "Texture: Unaccounted for BPP of " << bitsPerPixel << std::endl;
+	}
+	
+	// Read in pixel data a row at a time.
     // BMP pixel data is stored bottom-left to top-right, so we do flip (our pixel array starts at top-left corner).
+	// Rows are padded to ensure 4-byte alignment.
 	int rowSize = CalculateBmpRowSize(bitsPerPixel, mWidth);
+	std::vector<uint8_t> row(rowSize);
 	for(int y = mHeight - 1; y >= 0; --y)
 	{
-		int bytesRead = 0;
-		for(unsigned int x = 0; x < mWidth; ++x)
+		reader.Read(row.data(), rowSize);
+		
+		// How we interpret pixel data will depend on the bpp.
+		unsigned char* pixels = &mPixels[y * mWidth * 4];
+		if(bitsPerPixel == 8)
 		{
-			// Calculate index into pixels array.
-            int index = (y * mWidth + x) * 4;
-			
-			// How we interpret pixel data will depend on the bpp.
-			if(bitsPerPixel == 8)
-			{
-				// Read in the palette index and save it.
-				int paletteIndex = reader.ReadUByte();
-				mPaletteIndexes[(y * mWidth + x)] = paletteIndex;
-				bytesRead++;
-				
-				//TODO: For palettized textures, should we hold off on creating pixels array until someone requests it?
-				if(mPalette != nullptr)
-				{
-					// Since each palette color has 4 bytes, multiply by 4 to get byte offset.
-					int paletteByteIndex = paletteIndex * 4;
-					
-					// Palette color order is BGRA. But our internal pixels are RGBA.
-					mPixels[index] = mPalette[paletteByteIndex + 2];
-					mPixels[index + 1] = mPalette[paletteByteIndex + 1];
-					mPixels[index + 2] = mPalette[paletteByteIndex];
-					
-					// As long as the BMP format is BI_RGB, we can assume the image does not have any alpha data.
-					// In these cases, the alpha value is usually zero.
-					// But we actually want to interpret that as 255 (full alpha).
-					mPixels[index + 3] = 255; //palette[paletteByteIndex + 3];
-				}
-			}
-			else if(bitsPerPixel == 24 || bitsPerPixel == 32)
-			{
-                // Assuming BI_RGB format, alpha is not stored.
-                // So regardless of bits per pixel of 24 or 32, the data layout and size is the same.
-                
-				// Pixel data in the BMP file is BGR.
-                // Internal pixel data is RGBA, so reorganize on read in.
-				mPixels[index + 2] = reader.ReadUByte(); // Blue
-				mPixels[index + 1] = reader.ReadUByte(); // Green
-				mPixels[index] = reader.ReadUByte(); 	 // Red
-				bytesRead += 3;
-				
-				// BI_RGB format doesn't save any alpha, even if 32 bits per pixel.
-				// We'll use a placeholder of 255 (full alpha).
-				mPixels[index + 3] = 255; // Alpha
-			}
-			else
-			{
-				std::cout << "Texture: Unaccounted for BPP of " << bitsPerPixel << std::endl;
-			}
+			// Save palette indexes, and expand them to colors.
+			//TODO: For palettized textures, should we hold off on creating pixels array until someone requests it?
+			memcpy(&mPaletteIndexes[y * mWidth], row.data(), mWidth);
+			PixelDecode::PaletteToRGBA8(row.data(), mWidth, paletteTable, pixels);
 		}
-		
-		// Skip padding that may be present, to ensure 4-byte alignment.
-		if(bytesRead < rowSize)
+		else if(bitsPerPixel == 24 || bitsPerPixel == 32)
 		{
-			reader.Skip(rowSize - bytesRead);
+			// Pixel data in the BMP file is BGR (plus an unused byte at 32-bpp).
+			// BI_RGB format doesn't save any alpha, even if 32 bits per pixel - we'll use full alpha.
+			PixelDecode::BGRToRGBA8(row.data(), mWidth, bitsPerPixel / 8, pixels);
 		}
 	}
 }
@@ -62,7 +62,11 @@ public:
     
     unsigned int GetWidth() const { return mWidth; }
     unsigned int GetHeight() const { return mHeight; }
-    unsigned char* GetPixelData() const { return mPixels; }
+    // If this is a static texture whose pixels were freed after upload, they're reloaded (and kept from then on).
+    unsigned char* GetPixelData();
+    
+    // GL texture object name; zero until the texture has been uploaded.
+    GLuint GetTextureId() const { return mTextureId; }
 	
 	RenderType GetRenderType() const { return mRenderType; }
 	
@@ -72,6 +76,35 @@ public:
     void SetWrapMode(WrapMode wrapMode) { mWrapMode = wrapMode; }
     WrapMode GetWrapMode() const { return mWrapMode; }
     
+    // Textures loaded from asset data get mipmaps; textures created at runtime (render targets, video) don't.
+    // Only takes effect on the first upload.
+    void SetMipmaps(bool mipmaps) { mMipmaps = mipmaps; }
+    bool GetMipmaps() const { return mMipmaps; }
+    
+    // Anisotropic filtering for mipmapped textures uploaded from now on; 1 (the default) is off.
+    // Clamped to what the GPU supports. Requires a GL context.
+    static void SetAnisotropy(float anisotropy);
+    
+    // World textures (BSP surfaces, lightmaps, models) are static: once uploaded, they don't change and usually nothing reads their pixels.
+    // So, their CPU-side pixels are freed after upload, and they may be block-compressed on the GPU.
+    // If something does read the pixels later (GetPixelData, GetPixelColor32, etc), they're reloaded from the asset.
+    void SetStatic(bool isStatic) { mStatic = isStatic; }
+    
+    // Keeps CPU-side pixels (uncompressed), even if static. For textures also read or modified on the CPU.
+    void SetKeepPixels(bool keepPixels) { mKeepPixels = keepPixels; }
+    
+    // If true, static textures are compressed to BC1/BC3 when first uploaded, if the GPU supports it.
+    // Off by default; toggled by the SetSurfaceLow/SetSurfaceNormal sheep commands.
+    static void SetCompressStaticTextures(bool compress) { sCompressStaticTextures = compress; }
+    
+    // Memory used by this texture's CPU-side data (pixels, palette) and on the GPU (including mips), in bytes.
+    unsigned int GetCPUMemoryBytes() const { return mCPUMemoryBytes; }
+    unsigned int GetGPUMemoryBytes() const { return mGPUMemoryBytes; }
+    
+    // Memory used by all textures.
+    static size_t GetTotalCPUMemoryBytes() { return sTotalCPUMemoryBytes; }
+    static size_t GetTotalGPUMemoryBytes() { return sTotalGPUMemoryBytes; }
+    
     // Coordinates are from top-left corner of texture.
 	Color32 GetPixelColor32(int x, int y);
 	unsigned char GetPaletteIndex(int x, int y);
@@ -79,14 +112,17 @@ public:
 	//void Blit(Texture* source, int destX, int destY);
 	
 	// Blend's source pixels into dest based on source's alpha channel.
-	static void BlendPixels(const Texture& source, Texture& dest, int destX, int destY);
-	static void BlendPixels(const Texture& source, int sourceX, int sourceY, int sourceWidth, int sourceHeight,
+	// Source isn't const because its pixels may need to be reloaded if they were freed after upload.
+	static void BlendPixels(Texture& source, Texture& dest, int destX, int destY);
+	static void BlendPixels(Texture& source, int sourceX, int sourceY, int sourceWidth, int sourceHeight,
 						   Texture& dest, int destX, int destY);
 	
 	// Alpha and transparency
 	void SetTransparentColor(Color32 color);
-	void ApplyAlphaChannel(const Texture& alphaTexture);
+	void ApplyAlphaChannel(Texture& alphaTexture);
 	
+	// Uploads changed pixels to the GPU. If only some pixels changed (e.g. via BlendPixels), only those parts are uploaded.
+	// Writing to GetPixelData directly isn't tracked, so upload before mixing that with partial changes.
 	void UploadToGPU();
 	
 	void WriteToFile(std::string filePath);
@@ -94,12 +130,35 @@ public:
 private:
 	friend class RenderTexture; // To access OpenGL stuff.
 	
+	// Texture bound to each texture unit, so redundant binds can be skipped.
+	// GL_NONE means the binding is unknown (e.g. GL state was changed behind our back).
+	static const int kMaxTrackedTextureUnits = 8;
+	static GLuint sBoundTextureIds[kMaxTrackedTextureUnits];
+	
+	// Ring of pixel buffers that texture updates are streamed through.
+	// Using them in turn means we rarely write to a buffer GL is still reading from.
+	static const int kUploadBufferCount = 3;
+	static GLuint sUploadBuffers[kUploadBufferCount];
+	static unsigned int sUploadBufferSizes[kUploadBufferCount];
+	static int sNextUploadBuffer;
+	
+	// Max anisotropy for mipmapped textures.
+	static float sAnisotropy;
+	
+	// Whether static textures are compressed on upload.
+	static bool sCompressStaticTextures;
+	
+	// Memory used by all textures.
+	static size_t sTotalCPUMemoryBytes;
+	static size_t sTotalGPUMemoryBytes;
+	
     // Texture width and height.
     unsigned int mWidth = 0;
     unsigned int mHeight = 0;
 	
 	// Some textures have palettes.
 	unsigned char* mPalette = nullptr;
+	unsigned int mPaletteColorCount = 0;
 	
 	// If a texture has a palette, the indexes into the palette are stored here.
 	unsigned char* mPaletteIndexes = nullptr;
@@ -123,9 +182,46 @@ private:
     // Texture's wrap mode.
     WrapMode mWrapMode = WrapMode::Repeat;
     
+    // If true, mipmaps are generated on upload.
+    bool mMipmaps = false;
+    
+    // Static textures free CPU-side data after upload, unless asked to keep pixels.
+    bool mStatic = false;
+    bool mKeepPixels = false;
+    
+    // True if CPU-side data was freed after upload, and can be reloaded from the asset if needed.
+    bool mCPUDataFreed = false;
+    
+    // Memory used, in bytes.
+    unsigned int mCPUMemoryBytes = 0;
+    unsigned int mGPUMemoryBytes = 0;
+    
     // If true, texture data in RAM is dirty, so we need to upload to GPU.
     bool mDirty = true;
 	
+	// Parts of the texture changed since the last upload (max is exclusive).
+	// Overlapping parts are merged, and if there are too many, the closest are merged.
+	// If there are none, the next upload sends the whole texture.
+	struct DirtyRect
+	{
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+	};
+	static const int kMaxDirtyRects = 8;
+	DirtyRect mDirtyRects[kMaxDirtyRects];
+	int mDirtyRectCount = 0;
+	
+	void AddDirtyRect(int x, int y, int width, int height);
+	void UploadDirtyRects();
+	unsigned int UploadCompressed();
+	
+	void FreeCPUData();
+	bool RestoreCPUData();
+	unsigned int CalculateCPUMemoryBytes() const;
+	void SetMemoryUsage(unsigned int cpuMemoryBytes, unsigned int gpuMemoryBytes);
+	
 	static int CalculateBmpRowSize(unsigned short bitsPerPixel, unsigned int width);
 	
     void ParseFromData(BinaryReader& reader);
@@ -0,0 +1,247 @@
+//
+// TextureCompression.cpp
+//
+// Clark Kromenaker
+//
+#include "TextureCompression.h"
+
+#include <climits>
+
+namespace
+{
+	// Block-compressed formats work on 4x4 blocks of pixels.
+	const int kBlockSize = 4;
+	const int kBlockPixelCount = kBlockSize * kBlockSize;
+
+	int GetBlockCount(int width, int height)
+	{
+		return ((width + kBlockSize - 1) / kBlockSize) * ((height + kBlockSize - 1) / kBlockSize);
+	}
+
+	// Copies a 4x4 block of pixels into a packed array.
+	// Blocks hanging off the right/bottom edges repeat the last column/row, which doesn't affect the endpoints picked.
+	void ReadBlock(const uint8_t* pixels, int width, int height, int blockX, int blockY, uint8_t* block)
+	{
+		for(int y = 0; y < kBlockSize; ++y)
+		{
+			int pixelY = blockY + y < height ? blockY + y : height - 1;
+			for(int x = 0; x < kBlockSize; ++x)
+			{
+				int pixelX = blockX + x < width ? blockX + x : width - 1;
+				const uint8_t* pixel = pixels + (pixelY * width + pixelX) * 4;
+				uint8_t* blockPixel = block + (y * kBlockSize + x) * 4;
+				blockPixel[0] = pixel[0];
+				blockPixel[1] = pixel[1];
+				blockPixel[2] = pixel[2];
+				blockPixel[3] = pixel[3];
+			}
+		}
+	}
+
+	uint16_t ToRGB565(const int* color)
+	{
+		return static_cast<uint16_t>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+	}
+
+	void FromRGB565(uint16_t value, int* color)
+	{
+		int red = (value >> 11) & 0x1F;
+		int green = (value >> 5) & 0x3F;
+		int blue = value & 0x1F;
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	// Encodes the color half of a block (8 bytes): two RGB565 endpoints, then 2-bit indexes for each pixel.
+	// Endpoints are the corners of the block's color bounding box, pulled in a bit - the extremes are often outliers.
+	// Fully transparent pixels can be left out of the bounding box, since their color doesn't matter (e.g. magenta color keys).
+	void EncodeColorBlock(const uint8_t* block, bool skipTransparent, uint8_t* dst)
+	{
+		bool anyVisible = false;
+		for(int i = 0; i < kBlockPixelCount; ++i)
+		{
+			anyVisible |= block[i * 4 + 3] != 0;
+		}
+		skipTransparent &= anyVisible;
+
+		int minColor[3] = { 255, 255, 255 };
+		int maxColor[3] = { 0, 0, 0 };
+		for(int i = 0; i < kBlockPixelCount; ++i)
+		{
+			if(skipTransparent && block[i * 4 + 3] == 0) { continue; }
+			for(int c = 0; c < 3; ++c)
+			{
+				int value = block[i * 4 + c];
+				if(value < minColor[c]) { minColor[c] = value; }
+				if(value > maxColor[c]) { maxColor[c] = value; }
+			}
+		}
+		for(int c = 0; c < 3; ++c)
+		{
+			if(minColor[c] > maxColor[c]) { minColor[c] = maxColor[c] = 0; }
+			int inset = (maxColor[c] - minColor[c]) >> 4;
+			minColor[c] += inset;
+			maxColor[c] -= inset;
+		}
+
+		// Each max channel is >= the min channel, so color0 >= color1.
+		// That's the 4-color mode, where the other two colors are 1/3 and 2/3 of the way between.
+		uint16_t color0 = ToRGB565(maxColor);
+		uint16_t color1 = ToRGB565(minColor);
+		int palette[4][3];
+		FromRGB565(color0, palette[0]);
+		FromRGB565(color1, palette[1]);
+		for(int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		// Each pixel uses the closest palette color.
+		uint32_t indexes = 0;
+		if(color0 != color1)
+		{
+			for(int i = 0; i < kBlockPixelCount; ++i)
+			{
+				int bestIndex = 0;
+				int bestDistance = INT_MAX;
+				for(int p = 0; p < 4; ++p)
+				{
+					int distance = 0;
+					for(int c = 0; c < 3; ++c)
+					{
+						int diff = block[i * 4 + c] - palette[p][c];
+						distance += diff * diff;
+					}
+					if(distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+				indexes |= static_cast<uint32_t>(bestIndex) << (i * 2);
+			}
+		}
+
+		dst[0] = color0 & 0xFF;
+		dst[1] = color0 >> 8;
+		dst[2] = color1 & 0xFF;
+		dst[3] = color1 >> 8;
+		for(int i = 0; i < 4; ++i)
+		{
+			dst[4 + i] = (indexes >> (i * 8)) & 0xFF;
+		}
+	}
+
+	// Encodes the alpha half of a BC3 block (8 bytes): two alpha endpoints, then 3-bit indexes for each pixel.
+	// Using the exact min/max keeps fully opaque and fully transparent pixels exact.
+	void EncodeAlphaBlock(const uint8_t* block, uint8_t* dst)
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for(int i = 0; i < kBlockPixelCount; ++i)
+		{
+			int alpha = block[i * 4 + 3];
+			if(alpha < minAlpha) { minAlpha = alpha; }
+			if(alpha > maxAlpha) { maxAlpha = alpha; }
+		}
+
+		// With alpha0 > alpha1, there are six more alphas evenly spaced between.
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for(int p = 1; p < 7; ++p)
+		{
+			palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+		}
+
+		uint64_t indexes = 0;
+		if(maxAlpha != minAlpha)
+		{
+			for(int i = 0; i < kBlockPixelCount; ++i)
+			{
+				int alpha = block[i * 4 + 3];
+				int bestIndex = 0;
+				int bestDistance = INT_MAX;
+				for(int p = 0; p < 8; ++p)
+				{
+					int distance = alpha > palette[p] ? alpha - palette[p] : palette[p] - alpha;
+					if(distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+				indexes |= static_cast<uint64_t>(bestIndex) << (i * 3);
+			}
+		}
+
+		dst[0] = static_cast<uint8_t>(maxAlpha);
+		dst[1] = static_cast<uint8_t>(minAlpha);
+		for(int i = 0; i < 6; ++i)
+		{
+			dst[2 + i] = (indexes >> (i * 8)) & 0xFF;
+		}
+	}
+}
+
+int TextureCompression::GetBC1Size(int width, int height)
+{
+	return GetBlockCount(width, height) * 8;
+}
+
+int TextureCompression::GetBC3Size(int width, int height)
+{
+	return GetBlockCount(width, height) * 16;
+}
+
+void TextureCompression::EncodeBC1(const uint8_t* pixels, int width, int height, uint8_t* dst)
+{
+	uint8_t block[kBlockPixelCount * 4];
+	for(int blockY = 0; blockY < height; blockY += kBlockSize)
+	{
+		for(int blockX = 0; blockX < width; blockX += kBlockSize)
+		{
+			ReadBlock(pixels, width, height, blockX, blockY, block);
+			EncodeColorBlock(block, false, dst);
+			dst += 8;
+		}
+	}
+}
+
+void TextureCompression::EncodeBC3(const uint8_t* pixels, int width, int height, uint8_t* dst)
+{
+	uint8_t block[kBlockPixelCount * 4];
+	for(int blockY = 0; blockY < height; blockY += kBlockSize)
+	{
+		for(int blockX = 0; blockX < width; blockX += kBlockSize)
+		{
+			ReadBlock(pixels, width, height, blockX, blockY, block);
+			EncodeAlphaBlock(block, dst);
+			EncodeColorBlock(block, true, dst + 8);
+			dst += 16;
+		}
+	}
+}
+
+void TextureCompression::HalveRGBA8(const uint8_t* pixels, int width, int height, uint8_t* dst)
+{
+	int halfWidth = width > 1 ? width / 2 : 1;
+	int halfHeight = height > 1 ? height / 2 : 1;
+	for(int y = 0; y < halfHeight; ++y)
+	{
+		// At a size of 1, there's only one row/column to average.
+		const uint8_t* row0 = pixels + (y * 2) * width * 4;
+		const uint8_t* row1 = height > 1 ? row0 + width * 4 : row0;
+		for(int x = 0; x < halfWidth; ++x)
+		{
+			int x0 = x * 2 * 4;
+			int x1 = width > 1 ? x0 + 4 : x0;
+			for(int c = 0; c < 4; ++c)
+			{
+				dst[(y * halfWidth + x) * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,31 @@
+//
+// TextureCompression.h
+//
+// Clark Kromenaker
+//
+// CPU encoders for block-compressed GPU texture formats.
+//
+// BC1 (aka DXT1) stores 4x4 pixel blocks of RGB in 8 bytes (1/8 the size of RGBA8).
+// BC3 (aka DXT5) adds a second 8 bytes per block for smooth alpha (1/4 the size of RGBA8).
+// Both pick two endpoint colors per block, and each pixel indexes a color between them.
+//
+// The encoders favor speed over quality, since they run when textures are first uploaded.
+//
+#pragma once
+#include <cstdint>
+
+namespace TextureCompression
+{
+	// Size in bytes of a compressed image. Partial blocks at the right/bottom edges take a whole block.
+	int GetBC1Size(int width, int height);
+	int GetBC3Size(int width, int height);
+
+	// Compresses RGBA8 pixels (from the top-left) to BC1 (alpha is ignored) or BC3.
+	// Output must have room for GetBC1Size/GetBC3Size bytes.
+	void EncodeBC1(const uint8_t* pixels, int width, int height, uint8_t* dst);
+	void EncodeBC3(const uint8_t* pixels, int width, int height, uint8_t* dst);
+
+	// Makes the next smaller mip of RGBA8 pixels by averaging 2x2 squares.
+	// Output is max(1, width / 2) by max(1, height / 2) pixels.
+	void HalveRGBA8(const uint8_t* pixels, int width, int height, uint8_t* dst);
+}
@@ -7,10 +7,14 @@
 
 #include <iostream>
 
+#include "RenderStats.h"
+
 // Some OpenGL calls take in array indexes/offsets as pointers.
 // This macro just makes the syntax clearer for the reader.
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
 
+GLuint VertexArray::sBoundVAO = GL_NONE;
+
 VertexArray::VertexArray(const MeshDefinition& data) :
     mData(data)
 {
@@ -68,6 +72,7 @@ VertexArray::VertexArray(const MeshDefinition& data) :
     {
         glGenVertexArrays(1, &mVAO);
         glBindVertexArray(mVAO);
+        sBoundVAO = GL_NONE;
         
         // Stride can be calculated once and used over and over.
         // For packed data, stride is zero. For interleaved data, stride is size of vertex.
@@ -102,6 +107,10 @@ VertexArray::VertexArray(const MeshDefinition& data) :
 
 VertexArray::~VertexArray()
 {
+    if(sBoundVAO == mVAO)
+    {
+        sBoundVAO = GL_NONE;
+    }
     glDeleteBuffers(1, &mVBO);
     glDeleteVertexArrays(1, &mVAO);
     glDeleteBuffers(1, &mIBO);
@@ -118,10 +127,14 @@ VertexArray& VertexArray::operator=(VertexArray&& other)
     mVBO = other.mVBO;
     mVAO = other.mVAO;
     mIBO = other.mIBO;
+    mKeyframeBuffer = other.mKeyframeBuffer;
+    mKeyframeFromOffset = other.mKeyframeFromOffset;
+    mKeyframeToOffset = other.mKeyframeToOffset;
     
     other.mVBO = GL_NONE;
     other.mVAO = GL_NONE;
     other.mIBO = GL_NONE;
+    other.mKeyframeBuffer = GL_NONE;
     return *this;
 }
 
@@ -168,6 +181,8 @@ void VertexArray::ChangeIndexData(unsigned short* indexes, unsigned int count)
     // If changing existing buffer contents, but the count is different, we must create delete old buffer and make a new one.
     if(mIBO != GL_NONE && mData.indexCount != count)
     {
+        // Deleting the IBO unbinds it from the current VAO, so the next draw must re-bind.
+        sBoundVAO = GL_NONE;
         glDeleteBuffers(1, &mIBO);
         mIBO = GL_NONE;
     }
@@ -179,6 +194,56 @@ void VertexArray::ChangeIndexData(unsigned short* indexes, unsigned int count)
     RefreshIBOContents(indexes, count);
 }
 
+void VertexArray::SetPositionKeyframes(GLuint buffer, unsigned int fromOffset, unsigned int toOffset)
+{
+    // Nothing to do if we're already pointing at these keyframes.
+    // Keyframes only change a few times per second, so most calls should early out here.
+    if(mKeyframeBuffer == buffer && mKeyframeFromOffset == fromOffset && mKeyframeToOffset == toOffset) { return; }
+    
+    // Attribute pointers are VAO state, so bind it. Then force the next draw to re-bind, so it also binds the index buffer.
+    glBindVertexArray(mVAO);
+    sBoundVAO = GL_NONE;
+    
+    // Point both position attributes at the keyframe buffer.
+    // Keyframe data is always tightly packed, regardless of this VA's layout.
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    int positionId = static_cast<int>(VertexAttribute::Semantic::Position);
+    int position2Id = static_cast<int>(VertexAttribute::Semantic::Position2);
+    glVertexAttribPointer(positionId, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(fromOffset));
+    glVertexAttribPointer(position2Id, 3, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(toOffset));
+    glEnableVertexAttribArray(position2Id);
+    
+    mKeyframeBuffer = buffer;
+    mKeyframeFromOffset = fromOffset;
+    mKeyframeToOffset = toOffset;
+}
+
+void VertexArray::ClearPositionKeyframes()
+{
+    if(mKeyframeBuffer == GL_NONE) { return; }
+    
+    glBindVertexArray(mVAO);
+    sBoundVAO = GL_NONE;
+    
+    // Point the position attribute back at our own VBO, using the same layout as during construction.
+    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    for(int i = 0; i < mData.vertexDefinition.attributes.size(); ++i)
+    {
+        const VertexAttribute& attribute = mData.vertexDefinition.attributes[i];
+        if(attribute.semantic == VertexAttribute::Semantic::Position)
+        {
+            int offset = mData.vertexDefinition.CalculateAttributeOffset(i, mData.vertexCount);
+            glVertexAttribPointer(static_cast<int>(attribute.semantic), attribute.count, GL_FLOAT,
+                                  attribute.normalize ? GL_TRUE : GL_FALSE,
+                                  mData.vertexDefinition.CalculateStride(), BUFFER_OFFSET(offset));
+            break;
+        }
+    }
+    glDisableVertexAttribArray(static_cast<int>(VertexAttribute::Semantic::Position2));
+    
+    mKeyframeBuffer = GL_NONE;
+}
+
 void VertexArray::DrawTriangles() const
 {
     DrawTriangles(0, mData.indexCount > 0 ? mData.indexCount : mData.vertexCount);
@@ -226,15 +291,23 @@ void VertexArray::Draw(GLenum mode) const
 
 void VertexArray::Draw(GLenum mode, unsigned int offset, unsigned int count) const
 {
-    // Bind vertex array object.
-    glBindVertexArray(mVAO);
+    // Bind vertex array object and index buffer, unless the previous draw already did.
+    // The index buffer binding is VAO state, so it stays bound along with the VAO.
+    if(sBoundVAO != mVAO || mVAO == GL_NONE)
+    {
+        glBindVertexArray(mVAO);
+        if(mIBO != GL_NONE)
+        {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+        }
+        sBoundVAO = mVAO;
+        ++RenderStats::sCurrent.vertexArrayBindCount;
+    }
+    ++RenderStats::sCurrent.drawCount;
     
     // Draw method depends on whether we have indexes or not.
     if(mIBO != GL_NONE)
     {
-        // Bind index buffer.
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
-        
         // Draw "count" indices at offset.
         glDrawElements(mode, count, GL_UNSIGNED_SHORT, BUFFER_OFFSET(offset * sizeof(GLushort)));
     }
@@ -249,6 +322,9 @@ void VertexArray::RefreshIBOContents(unsigned short* indexData, int indexCount)
 {
     if(indexData != nullptr && indexCount > 0)
     {
+        // Binding an index buffer changes the current VAO's state, so the next draw must re-bind.
+        sBoundVAO = GL_NONE;
+        
         // Either create new buffer and fill with index data,
         // Or populate existing buffer with new data.
         if(mIBO == GL_NONE)
@@ -66,6 +66,13 @@ public:
     
     void ChangeIndexData(unsigned short* indexes, unsigned int count);
     
+    // Sources positions from two keyframes in an external buffer (tightly packed vec3s), rather than this VA's own data.
+    // The keyframes are fed to the "Position" and "Position2" attributes, so a shader can blend between them.
+    // Offsets are in bytes. The VA does not own the buffer.
+    void SetPositionKeyframes(GLuint buffer, unsigned int fromOffset, unsigned int toOffset);
+    void ClearPositionKeyframes();
+    bool HasPositionKeyframes() const { return mKeyframeBuffer != GL_NONE; }
+    
     void DrawTriangles() const;
     void DrawTriangles(unsigned int offset, unsigned int count) const;
     
@@ -82,6 +89,10 @@ public:
     void Draw(GLenum mode, unsigned int offset, unsigned int count) const;
     
 private:
+    // The VAO bound by the last draw, so back-to-back draws of the same VA skip re-binding.
+    // Anything that binds VAOs or index buffers outside of drawing must reset this to GL_NONE.
+    static GLuint sBoundVAO;
+    
     // Definition data passed in.
     // Note that vertex/index data pointers SHOULD NOT be considered valid after construction!
     MeshDefinition mData;
@@ -97,5 +108,10 @@ private:
     // The VBO is just a big chunk of memory. The VAO dictates how to interpret the memory to read vertex data.
     GLuint mVAO = GL_NONE;
     
+    // If set, positions are currently sourced from this keyframe buffer at these offsets, rather than from the VBO.
+    GLuint mKeyframeBuffer = GL_NONE;
+    unsigned int mKeyframeFromOffset = 0;
+    unsigned int mKeyframeToOffset = 0;
+    
     void RefreshIBOContents(unsigned short* indexData, int indexCount);
 };
@@ -30,6 +30,7 @@ struct VertexAttribute
         Color,
         UV1,
         UV2,
+        Position2,      // A second position, used to blend between two keyframes in the vertex shader.
         SemanticCount
     };
     
@@ -176,6 +176,20 @@ ReportManager::ReportManager()
 	gengine.AddOutput(ReportOutput::Console);
 	gengine.AddContent(ReportContent::Content);
 	
+	// Frame timing stats - reported often, so they stay out of the console.
+	ReportStream& framePacing = GetOrCreateStream("FramePacing");
+	framePacing.SetAction(ReportAction::Log);
+	framePacing.AddOutput(ReportOutput::Debugger);
+	framePacing.AddOutput(ReportOutput::SharedMemory);
+	framePacing.AddContent(ReportContent::Content);
+	
+	// Path finding latency stats - also reported often, so they stay out of the console.
+	ReportStream& pathFinding = GetOrCreateStream("PathFinding");
+	pathFinding.SetAction(ReportAction::Log);
+	pathFinding.AddOutput(ReportOutput::Debugger);
+	pathFinding.AddOutput(ReportOutput::SharedMemory);
+	pathFinding.AddContent(ReportContent::Content);
+	
 	// Create a general purpose "generic" stream.
 	ReportStream& generic = GetOrCreateStream("Generic");
 	generic.SetAction(ReportAction::Log);
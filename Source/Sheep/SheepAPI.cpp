@@ -24,6 +24,7 @@
 #include "Services.h"
 #include "SoundtrackPlayer.h"
 #include "StringUtil.h"
+#include "Texture.h"
 #include "VerbManager.h"
 #include "VideoPlayer.h"
 
@@ -622,6 +623,9 @@ shpvoid SetActorPosition(std::string actorName, std::string positionName)
 	// Docs are unclear about this, but in GK3, this definitely also sets heading.
 	actor->SetPosition(scenePosition->position);
 	actor->SetHeading(scenePosition->heading);
+	
+	// Actor is teleported, not walked, so don't blend from the old position.
+	actor->ResetInterpolation();
 	return 0;
 }
 RegFunc2(SetActorPosition, void, string, string, IMMEDIATE, REL_FUNC);
@@ -874,13 +878,30 @@ shpvoid WalkNearModel(std::string actorName, std::string modelName)
 }
 RegFunc2(WalkNearModel, void, string, string, WAITABLE, REL_FUNC);
 
+*/
+
 shpvoid WalkTo(std::string actorName, std::string positionName)
 {
-	std::cout << "WalkTo" << std::endl;
+	// Get needed data.
+	Scene* scene = GEngine::Instance()->GetScene();
+	GKActor* actor = scene->GetActorByNoun(actorName);
+	const ScenePosition* scenePosition = scene->GetPosition(positionName);
+	
+	// If either is null, log an error.
+	if(actor == nullptr || scenePosition == nullptr)
+	{
+		ExecError();
+		return 0;
+	}
+	
+	// Path is found in the background, so this never stalls the frame. The sheep waits until the walk is done.
+	SheepThread* currentThread = Services::GetSheep()->GetCurrentThread();
+	actor->WalkTo(scenePosition->position, scenePosition->heading, scene->GetWalkerBoundary(), currentThread->AddWait());
 	return 0;
 }
 RegFunc2(WalkTo, void, string, string, WAITABLE, REL_FUNC);
 
+/*
 shpvoid WalkToAnimation(std::string actorName, std::string animationName)
 {
 	std::cout << "WalkToAnimation" << std::endl;
@@ -1580,9 +1601,29 @@ RegFunc0(SetTopSheep, void, IMMEDIATE, REL_FUNC);
 //SetShadowTypeModel
 //SetShadowTypeNone
 
-//SetSurfaceHigh
-//SetSurfaceLow
-//SetSurfaceNormal
+// Surface quality controls how textures are stored on the GPU. Only affects textures uploaded afterwards.
+// Low quality stores static textures compressed, using less GPU memory at some cost to image quality.
+shpvoid SetSurfaceHigh()
+{
+	// Textures are never stored at a higher quality than normal, so this is the same as normal.
+	Texture::SetCompressStaticTextures(false);
+	return 0;
+}
+RegFunc0(SetSurfaceHigh, void, IMMEDIATE, DEV_FUNC);
+
+shpvoid SetSurfaceLow()
+{
+	Texture::SetCompressStaticTextures(true);
+	return 0;
+}
+RegFunc0(SetSurfaceLow, void, IMMEDIATE, DEV_FUNC);
+
+shpvoid SetSurfaceNormal()
+{
+	Texture::SetCompressStaticTextures(false);
+	return 0;
+}
+RegFunc0(SetSurfaceNormal, void, IMMEDIATE, DEV_FUNC);
 
 /*
 shpvoid SetTimerMs(int milliseconds)
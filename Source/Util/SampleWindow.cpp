@@ -0,0 +1,61 @@
+//
+// SampleWindow.cpp
+//
+// Clark Kromenaker
+//
+#include "SampleWindow.h"
+
+#include <algorithm>
+
+#include "GMath.h"
+
+SampleWindow::SampleWindow(int capacity) :
+	mCapacity(Math::Max(capacity, 1))
+{
+	mSamples.reserve(mCapacity);
+}
+
+bool SampleWindow::Add(float sample)
+{
+	if(static_cast<int>(mSamples.size()) < mCapacity)
+	{
+		mSamples.push_back(sample);
+	}
+	else
+	{
+		mSamples[mNextIndex] = sample;
+	}
+	mNextIndex = (mNextIndex + 1) % mCapacity;
+	return mNextIndex == 0;
+}
+
+float SampleWindow::GetPercentile(float percentile) const
+{
+	if(mSamples.empty()) { return 0.0f; }
+	
+	// Windows are only a few hundred samples, so sorting a copy is fine.
+	std::vector<float> sorted = mSamples;
+	std::sort(sorted.begin(), sorted.end());
+	int index = static_cast<int>(Math::Clamp(percentile, 0.0f, 1.0f) * (sorted.size() - 1) + 0.5f);
+	return sorted[index];
+}
+
+float SampleWindow::GetStandardDeviation() const
+{
+	if(mSamples.empty()) { return 0.0f; }
+	
+	float mean = 0.0f;
+	for(float sample : mSamples)
+	{
+		mean += sample;
+	}
+	mean /= mSamples.size();
+	
+	float variance = 0.0f;
+	for(float sample : mSamples)
+	{
+		variance += (sample - mean) * (sample - mean);
+	}
+	variance /= mSamples.size();
+	return Math::Sqrt(variance);
+}
@@ -0,0 +1,34 @@
+//
+// SampleWindow.h
+//
+// Clark Kromenaker
+//
+// Keeps the most recent N samples of some measurement (e.g. frame times), and calculates stats for them.
+//
+#pragma once
+#include <vector>
+
+class SampleWindow
+{
+public:
+	explicit SampleWindow(int capacity);
+	
+	// Adds a sample, replacing the oldest one once the window is full.
+	// Returns true every time "capacity" new samples have been added - a handy time to report stats.
+	bool Add(float sample);
+	
+	// Nearest-rank percentile (0-1) of the samples, or zero if there are none.
+	float GetPercentile(float percentile) const;
+	
+	// Standard deviation of the samples, or zero if there are none.
+	float GetStandardDeviation() const;
+	
+	int GetCount() const { return static_cast<int>(mSamples.size()); }
+	
+private:
+	int mCapacity = 0;
+	
+	// Samples as a ring buffer. Once full, the next index holds the oldest sample.
+	std::vector<float> mSamples;
+	int mNextIndex = 0;
+};
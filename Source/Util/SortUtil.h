@@ -0,0 +1,70 @@
+//
+// SortUtil.h
+//
+// Clark Kromenaker
+//
+// Sorting helpers for cases where std::sort isn't the best fit.
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SortUtil
+{
+	// Sorts indexes by their corresponding keys (ascending). Stable, and O(n).
+	// "keys" and "indexes" are sorted in place; the temp vectors are used as scratch space.
+	inline void RadixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& indexes,
+						  std::vector<uint32_t>& tempKeys, std::vector<uint32_t>& tempIndexes)
+	{
+		std::size_t count = keys.size();
+		tempKeys.resize(count);
+		tempIndexes.resize(count);
+		
+		// Least-significant-digit radix sort, 8 bits per pass.
+		uint32_t* srcKeys = keys.data();
+		uint32_t* srcIndexes = indexes.data();
+		uint32_t* dstKeys = tempKeys.data();
+		uint32_t* dstIndexes = tempIndexes.data();
+		for(int shift = 0; shift < 32; shift += 8)
+		{
+			// Count occurrences of each digit.
+			std::size_t counts[256] = { 0 };
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				++counts[(srcKeys[i] >> shift) & 0xFF];
+			}
+			
+			// If every key has the same digit, this pass wouldn't change anything.
+			// This is common - e.g. a scene with only one or two shaders.
+			if(count == 0 || counts[(srcKeys[0] >> shift) & 0xFF] == count) { continue; }
+			
+			// Convert counts to starting offsets.
+			std::size_t offset = 0;
+			for(int i = 0; i < 256; ++i)
+			{
+				std::size_t digitCount = counts[i];
+				counts[i] = offset;
+				offset += digitCount;
+			}
+			
+			// Scatter into destination, preserving order for equal digits.
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				std::size_t dstIndex = counts[(srcKeys[i] >> shift) & 0xFF]++;
+				dstKeys[dstIndex] = srcKeys[i];
+				dstIndexes[dstIndex] = srcIndexes[i];
+			}
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcIndexes, dstIndexes);
+		}
+		
+		// If the final sorted data ended up in the temp buffers, swap it into the output vectors.
+		if(srcKeys != keys.data())
+		{
+			keys.swap(tempKeys);
+			indexes.swap(tempIndexes);
+		}
+	}
+}
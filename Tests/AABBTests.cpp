@@ -7,6 +7,7 @@
 //
 #include "catch.hh"
 #include "AABB.h"
+#include "Matrix4.h"
 
 TEST_CASE("AABB creation works")
 {
@@ -64,3 +65,32 @@ TEST_CASE("AABB get closest point works")
 	REQUIRE(aabb.GetClosestPoint(Vector3(0.0f, -90.0f, 5.0f)) == min);
 	REQUIRE(aabb.GetClosestPoint(Vector3(76.0f, 0.0f, 5.0f)) == Vector3(76.0f, -10.0f, 8.5f));
 }
+
+TEST_CASE("AABB grow to contain AABB works")
+{
+	AABB aabb(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f));
+	aabb.GrowToContain(AABB(Vector3(-2.0f, 0.5f, 0.5f), Vector3(0.5f, 3.0f, 0.5f)));
+	REQUIRE(aabb.GetMin() == Vector3(-2.0f, 0.0f, 0.0f));
+	REQUIRE(aabb.GetMax() == Vector3(1.0f, 3.0f, 1.0f));
+	
+	// Growing to contain an invalid AABB does nothing.
+	aabb.GrowToContain(AABB(Vector3(10.0f, 10.0f, 10.0f), Vector3(-10.0f, -10.0f, -10.0f)));
+	REQUIRE(aabb.GetMin() == Vector3(-2.0f, 0.0f, 0.0f));
+	REQUIRE(aabb.GetMax() == Vector3(1.0f, 3.0f, 1.0f));
+}
+
+TEST_CASE("AABB transform works")
+{
+	AABB aabb(Vector3(-1.0f, -2.0f, -3.0f), Vector3(1.0f, 2.0f, 3.0f));
+	
+	// Translation and scale just move/resize the box.
+	Matrix4 translateScale = Matrix4::MakeTranslate(Vector3(10.0f, 0.0f, 0.0f)) * Matrix4::MakeScale(2.0f);
+	AABB transformed = AABB::Transform(aabb, translateScale);
+	REQUIRE(transformed.GetMin() == Vector3(8.0f, -4.0f, -6.0f));
+	REQUIRE(transformed.GetMax() == Vector3(12.0f, 4.0f, 6.0f));
+	
+	// A 90 degree rotation about Y swaps the x/z extents.
+	AABB rotated = AABB::Transform(aabb, Matrix4::MakeRotateY(Math::kPi / 2.0f));
+	REQUIRE(rotated.GetMin() == Vector3(-3.0f, -2.0f, -1.0f));
+	REQUIRE(rotated.GetMax() == Vector3(3.0f, 2.0f, 1.0f));
+}
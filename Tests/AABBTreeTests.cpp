@@ -0,0 +1,191 @@
+//
+// AABBTreeTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for AABBTree class.
+//
+#include "catch.hh"
+#include "AABBTree.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+
+#include "Collisions.h"
+#include "Ray.h"
+#include "Sphere.h"
+
+namespace
+{
+	float RandomFloat(float min, float max)
+	{
+		return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
+	}
+
+	AABB MakeRandomBox()
+	{
+		Vector3 center(RandomFloat(-1000.0f, 1000.0f), RandomFloat(0.0f, 200.0f), RandomFloat(-1000.0f, 1000.0f));
+		return AABB(center, RandomFloat(1.0f, 50.0f), RandomFloat(1.0f, 50.0f), RandomFloat(1.0f, 50.0f));
+	}
+
+	// Sorted query results, so they can be compared against brute force.
+	std::vector<int> QueryTree(const AABBTree& tree, const AABB& aabb)
+	{
+		std::vector<int> found;
+		tree.Query(aabb, found);
+		std::sort(found.begin(), found.end());
+		return found;
+	}
+
+	// Checks the tree's fat boxes, since a box that moved but stayed inside its fat box keeps it.
+	std::vector<int> QueryBruteForce(const AABBTree& tree, const std::vector<int>& proxyIds, const std::vector<bool>& inTree, const AABB& aabb)
+	{
+		std::vector<int> found;
+		for(int i = 0; i < proxyIds.size(); ++i)
+		{
+			if(inTree[i] && Collisions::TestAABBAABB(tree.GetFatAABB(proxyIds[i]), aabb))
+			{
+				found.push_back(i);
+			}
+		}
+		return found;
+	}
+}
+
+TEST_CASE("AABB tree queries match brute force as boxes move")
+{
+	srand(2468);
+	AABBTree tree;
+	std::vector<AABB> boxes;
+	std::vector<int> proxyIds;
+	std::vector<bool> inTree;
+	for(int i = 0; i < 500; ++i)
+	{
+		boxes.push_back(MakeRandomBox());
+		proxyIds.push_back(tree.Insert(boxes.back(), i));
+		inTree.push_back(true);
+	}
+	REQUIRE(tree.GetProxyCount() == 500);
+
+	// Insertion order is random, so a balanced tree is a handful of levels deep (log2(500) is about 9).
+	REQUIRE(tree.GetHeight() < 20);
+
+	for(int round = 0; round < 5; ++round)
+	{
+		// Move some boxes a little, some a lot, and take some out (or put them back).
+		for(int i = 0; i < boxes.size(); ++i)
+		{
+			int action = rand() % 10;
+			if(action < 3 && inTree[i])
+			{
+				boxes[i] = AABB(boxes[i].GetCenter() + Vector3(RandomFloat(-5.0f, 5.0f), 0.0f, RandomFloat(-5.0f, 5.0f)), 10.0f, 10.0f, 10.0f);
+				tree.Update(proxyIds[i], boxes[i]);
+			}
+			else if(action < 5 && inTree[i])
+			{
+				boxes[i] = MakeRandomBox();
+				tree.Update(proxyIds[i], boxes[i]);
+			}
+			else if(action < 6)
+			{
+				if(inTree[i])
+				{
+					tree.Remove(proxyIds[i]);
+				}
+				else
+				{
+					proxyIds[i] = tree.Insert(boxes[i], i);
+				}
+				inTree[i] = !inTree[i];
+			}
+		}
+		REQUIRE(tree.GetProxyCount() == std::count(inTree.begin(), inTree.end(), true));
+		REQUIRE(tree.GetHeight() < 20);
+
+		for(int i = 0; i < 50; ++i)
+		{
+			Vector3 center(RandomFloat(-1200.0f, 1200.0f), RandomFloat(-100.0f, 300.0f), RandomFloat(-1200.0f, 1200.0f));
+			float size = RandomFloat(1.0f, 200.0f);
+			AABB query(center, size, size, size);
+			REQUIRE(QueryTree(tree, query) == QueryBruteForce(tree, proxyIds, inTree, query));
+		}
+	}
+
+	tree.Clear();
+	REQUIRE(tree.GetProxyCount() == 0);
+	REQUIRE(QueryTree(tree, AABB(Vector3::Zero, 2000.0f, 2000.0f, 2000.0f)).empty());
+}
+
+TEST_CASE("AABB tree fat boxes absorb small moves")
+{
+	AABBTree tree(10.0f);
+	int proxyId = tree.Insert(AABB(Vector3::Zero, 10.0f, 10.0f, 10.0f), 7);
+	REQUIRE(tree.GetUserIndex(proxyId) == 7);
+	REQUIRE(tree.GetFatAABB(proxyId).GetMax().x == Approx(15.0f));
+
+	// Moving within the margin leaves the tree alone; moving past it updates the fat box.
+	REQUIRE_FALSE(tree.Update(proxyId, AABB(Vector3(8.0f, 0.0f, 0.0f), 10.0f, 10.0f, 10.0f)));
+	REQUIRE(tree.Update(proxyId, AABB(Vector3(12.0f, 0.0f, 0.0f), 10.0f, 10.0f, 10.0f)));
+	REQUIRE(tree.GetFatAABB(proxyId).GetMax().x == Approx(27.0f));
+
+	// Queries use the fat box.
+	std::vector<int> found;
+	tree.Query(Sphere(Vector3(30.0f, 0.0f, 0.0f), 5.0f), found);
+	REQUIRE(found == std::vector<int>({ 7 }));
+	tree.Query(Sphere(Vector3(40.0f, 0.0f, 0.0f), 5.0f), found);
+	REQUIRE(found.empty());
+}
+
+TEST_CASE("AABB tree raycast finds nearest box")
+{
+	srand(1357);
+	AABBTree tree(5.0f);
+	std::vector<AABB> boxes;
+	for(int i = 0; i < 300; ++i)
+	{
+		boxes.push_back(MakeRandomBox());
+		tree.Insert(boxes.back(), i);
+	}
+
+	int hitCount = 0;
+	for(int i = 0; i < 200; ++i)
+	{
+		Vector3 origin(RandomFloat(-1200.0f, 1200.0f), RandomFloat(0.0f, 200.0f), RandomFloat(-1200.0f, 1200.0f));
+		Vector3 direction(RandomFloat(-1.0f, 1.0f), RandomFloat(-0.2f, 0.2f), RandomFloat(-1.0f, 1.0f));
+		direction.Normalize();
+		Ray ray(origin, direction);
+
+		// The callback does the "real" test against the exact box, like a scene would against a mesh.
+		int treeIndex = -1;
+		int callbackCount = 0;
+		tree.Raycast(ray, FLT_MAX, [&](int userIndex, float maxT) -> float {
+			++callbackCount;
+			RaycastHit hitInfo;
+			if(Collisions::TestRayAABB(ray, boxes[userIndex], hitInfo) && hitInfo.t < maxT)
+			{
+				treeIndex = userIndex;
+				return hitInfo.t;
+			}
+			return maxT;
+		});
+
+		int bruteForceIndex = -1;
+		float nearestT = FLT_MAX;
+		for(int j = 0; j < boxes.size(); ++j)
+		{
+			RaycastHit hitInfo;
+			if(Collisions::TestRayAABB(ray, boxes[j], hitInfo) && hitInfo.t < nearestT)
+			{
+				bruteForceIndex = j;
+				nearestT = hitInfo.t;
+			}
+		}
+		REQUIRE(treeIndex == bruteForceIndex);
+
+		// Should only be calling back for a few boxes along the ray, not all of them.
+		REQUIRE(callbackCount < 100);
+		if(treeIndex >= 0) { ++hitCount; }
+	}
+	REQUIRE(hitCount > 0);
+}
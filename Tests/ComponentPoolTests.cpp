@@ -0,0 +1,148 @@
+//
+// ComponentPoolTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for ComponentPool class.
+//
+#include "catch.hh"
+#include "ComponentPool.h"
+
+#include <vector>
+
+namespace
+{
+	class TestComponent : public Component
+	{
+	public:
+		TestComponent(Actor* owner) : Component(owner) { ++sAliveCount; }
+		~TestComponent() { --sAliveCount; }
+		
+		int value = 0;
+		static int sAliveCount;
+	};
+	int TestComponent::sAliveCount = 0;
+}
+
+TEST_CASE("Component pool reuses freed slots")
+{
+	ComponentPool<TestComponent> pool;
+	TestComponent* a = pool.Create(nullptr);
+	TestComponent* b = pool.Create(nullptr);
+	TestComponent* c = pool.Create(nullptr);
+	REQUIRE(a->GetPool() == &pool);
+	REQUIRE(a->GetPoolIndex() == 0);
+	REQUIRE(b->GetPoolIndex() == 1);
+	REQUIRE(c->GetPoolIndex() == 2);
+	REQUIRE(pool.GetCount() == 3);
+	REQUIRE(TestComponent::sAliveCount == 3);
+	
+	// Destroying runs the destructor, and the next create takes the freed slot (same memory).
+	pool.Destroy(b);
+	REQUIRE(pool.GetCount() == 2);
+	REQUIRE(TestComponent::sAliveCount == 2);
+	TestComponent* d = pool.Create(nullptr);
+	REQUIRE(d->GetPoolIndex() == 1);
+	REQUIRE(d == b);
+	REQUIRE(d->value == 0);
+	
+	// With no freed slots, a new slot is used.
+	TestComponent* e = pool.Create(nullptr);
+	REQUIRE(e->GetPoolIndex() == 3);
+	
+	// Destroying twice, or destroying something from another pool, does nothing.
+	ComponentPool<TestComponent> otherPool;
+	TestComponent* other = otherPool.Create(nullptr);
+	pool.Destroy(a);
+	pool.Destroy(a);
+	pool.Destroy(other);
+	REQUIRE(pool.GetCount() == 3);
+	REQUIRE(otherPool.GetCount() == 1);
+	
+	otherPool.Destroy(other);
+	pool.Destroy(c);
+	pool.Destroy(d);
+	pool.Destroy(e);
+	REQUIRE(pool.GetCount() == 0);
+	REQUIRE(TestComponent::sAliveCount == 0);
+}
+
+TEST_CASE("Component handles reject destroyed components")
+{
+	ComponentPool<TestComponent> pool;
+	REQUIRE(!ComponentHandle<TestComponent>());
+	
+	TestComponent* a = pool.Create(nullptr);
+	ComponentHandle<TestComponent> handle(a);
+	REQUIRE(handle);
+	REQUIRE(handle.Get() == a);
+	REQUIRE(pool.Get(a->GetPoolIndex(), pool.GetGeneration(a->GetPoolIndex())) == a);
+	
+	// Once destroyed, the handle is empty - even after the slot is reused for another component.
+	unsigned int oldGeneration = pool.GetGeneration(a->GetPoolIndex());
+	pool.Destroy(a);
+	REQUIRE(!handle);
+	TestComponent* b = pool.Create(nullptr);
+	REQUIRE(b == a);
+	REQUIRE(handle.Get() == nullptr);
+	REQUIRE(pool.Get(b->GetPoolIndex(), oldGeneration) == nullptr);
+	
+	// A handle to the new component works, of course.
+	ComponentHandle<TestComponent> newHandle(b);
+	REQUIRE(newHandle.Get() == b);
+	
+	// Indexes that were never used aren't valid either.
+	REQUIRE(pool.Get(-1, 0) == nullptr);
+	REQUIRE(pool.Get(1, 0) == nullptr);
+	
+	pool.Destroy(b);
+	REQUIRE(!newHandle);
+}
+
+TEST_CASE("Component pool ForEach skips free slots")
+{
+	// Enough components for more than one chunk.
+	ComponentPool<TestComponent> pool;
+	std::vector<TestComponent*> components;
+	for(int i = 0; i < 150; ++i)
+	{
+		components.push_back(pool.Create(nullptr));
+		components.back()->value = i;
+	}
+	
+	// Free every third one.
+	for(int i = 0; i < 150; i += 3)
+	{
+		pool.Destroy(components[i]);
+	}
+	REQUIRE(pool.GetCount() == 100);
+	
+	// Only alive components are visited, in slot order.
+	std::vector<int> visited;
+	pool.ForEach([&visited](TestComponent* component) {
+		visited.push_back(component->value);
+	});
+	REQUIRE(visited.size() == 100);
+	for(size_t i = 0; i < visited.size(); ++i)
+	{
+		REQUIRE(visited[i] % 3 != 0);
+		if(i > 0)
+		{
+			REQUIRE(visited[i] > visited[i - 1]);
+		}
+	}
+	
+	// Destroying during ForEach is fine - everything gets visited once, and ends up destroyed.
+	int visitCount = 0;
+	pool.ForEach([&pool, &visitCount](TestComponent* component) {
+		++visitCount;
+		pool.Destroy(component);
+	});
+	REQUIRE(visitCount == 100);
+	REQUIRE(pool.GetCount() == 0);
+	REQUIRE(TestComponent::sAliveCount == 0);
+	
+	// An empty pool visits nothing.
+	pool.ForEach([&visitCount](TestComponent*) { ++visitCount; });
+	REQUIRE(visitCount == 100);
+}
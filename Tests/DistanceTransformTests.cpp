@@ -0,0 +1,155 @@
+//
+// DistanceTransformTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for DistanceTransform functions.
+//
+#include "catch.hh"
+#include "DistanceTransform.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	int DistanceSq(int indexA, int indexB, int width)
+	{
+		int dx = (indexA % width) - (indexB % width);
+		int dy = (indexA / width) - (indexB / width);
+		return dx * dx + dy * dy;
+	}
+	
+	// Slow but obviously correct: check every feature for every cell.
+	int BruteForceNearestDistanceSq(const std::vector<unsigned char>& isFeature, int width, int index)
+	{
+		int nearestDistSq = -1;
+		for(int i = 0; i < isFeature.size(); ++i)
+		{
+			if(isFeature[i] == 0) { continue; }
+			int distSq = DistanceSq(index, i, width);
+			if(nearestDistSq < 0 || distSq < nearestDistSq)
+			{
+				nearestDistSq = distSq;
+			}
+		}
+		return nearestDistSq;
+	}
+	
+	std::vector<unsigned char> MakeRandomGrid(int width, int height, int featurePercent)
+	{
+		std::vector<unsigned char> grid(width * height);
+		for(auto& cell : grid)
+		{
+			cell = (rand() % 100) < featurePercent ? 1 : 0;
+		}
+		return grid;
+	}
+}
+
+TEST_CASE("Distance transform edge cases")
+{
+	std::vector<int> nearest;
+	
+	// No features: nothing is nearest to anything.
+	std::vector<unsigned char> empty(12, 0);
+	DistanceTransform::NearestFeature(empty.data(), 4, 3, nearest);
+	REQUIRE(nearest.size() == 12);
+	for(int index : nearest)
+	{
+		REQUIRE(index == -1);
+	}
+	
+	// All features: every cell is nearest to itself.
+	std::vector<unsigned char> full(12, 1);
+	DistanceTransform::NearestFeature(full.data(), 4, 3, nearest);
+	for(int i = 0; i < nearest.size(); ++i)
+	{
+		REQUIRE(nearest[i] == i);
+	}
+	
+	// One feature: everything is nearest to it.
+	std::vector<unsigned char> single(12, 0);
+	single[6] = 1;
+	DistanceTransform::NearestFeature(single.data(), 4, 3, nearest);
+	for(int index : nearest)
+	{
+		REQUIRE(index == 6);
+	}
+	
+	// A single row and a single column work too.
+	std::vector<unsigned char> line = { 0, 0, 1, 0, 0, 1, 0 };
+	DistanceTransform::NearestFeature(line.data(), 7, 1, nearest);
+	REQUIRE(nearest == std::vector<int>({ 2, 2, 2, 2, 5, 5, 5 }));
+	DistanceTransform::NearestFeature(line.data(), 1, 7, nearest);
+	REQUIRE(nearest == std::vector<int>({ 2, 2, 2, 2, 5, 5, 5 }));
+}
+
+TEST_CASE("Distance transform matches brute force")
+{
+	srand(1234);
+	const int kSizes[][2] = { { 16, 16 }, { 37, 23 }, { 5, 64 } };
+	const int kFeaturePercents[] = { 1, 10, 60 };
+	for(auto& size : kSizes)
+	{
+		for(int featurePercent : kFeaturePercents)
+		{
+			int width = size[0];
+			int height = size[1];
+			std::vector<unsigned char> grid = MakeRandomGrid(width, height, featurePercent);
+			
+			std::vector<int> nearest;
+			DistanceTransform::NearestFeature(grid.data(), width, height, nearest);
+			REQUIRE(nearest.size() == width * height);
+			
+			// Ties may be broken differently, so compare distances rather than indexes.
+			int mismatchCount = 0;
+			for(int i = 0; i < nearest.size(); ++i)
+			{
+				int expectedDistSq = BruteForceNearestDistanceSq(grid, width, i);
+				bool matches = (expectedDistSq < 0) ? (nearest[i] == -1) :
+					(nearest[i] >= 0 && grid[nearest[i]] != 0 && DistanceSq(i, nearest[i], width) == expectedDistSq);
+				if(!matches)
+				{
+					++mismatchCount;
+				}
+			}
+			REQUIRE(mismatchCount == 0);
+		}
+	}
+}
+
+// Hidden by default - run with the "[benchmark]" tag.
+TEST_CASE("Distance transform benchmark", "[.][benchmark]")
+{
+	// Walker boundary textures are typically a few hundred pixels on a side.
+	srand(1234);
+	const int kSizes[] = { 128, 256, 512 };
+	const int kIterations = 20;
+	for(int size : kSizes)
+	{
+		// Mostly walkable, like a typical walker boundary.
+		std::vector<unsigned char> grid = MakeRandomGrid(size, size, 70);
+		std::vector<int> nearest;
+		
+		auto start = std::chrono::high_resolution_clock::now();
+		for(int i = 0; i < kIterations; ++i)
+		{
+			DistanceTransform::NearestFeature(grid.data(), size, size, nearest);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		double buildMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+		
+		// Compare to what a single brute force nearest query costs (what every query cost before).
+		start = std::chrono::high_resolution_clock::now();
+		volatile int sink = BruteForceNearestDistanceSq(grid, size, (size / 2) * size + (size / 2));
+		end = std::chrono::high_resolution_clock::now();
+		double bruteForceMs = std::chrono::duration<double, std::milli>(end - start).count();
+		(void)sink;
+		
+		std::cout << size << "x" << size << ": transform " << buildMs << "ms (once), brute force query " << bruteForceMs << "ms (per query)" << std::endl;
+		REQUIRE(nearest.size() == size * size);
+	}
+}
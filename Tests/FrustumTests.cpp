@@ -0,0 +1,98 @@
+//
+// FrustumTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for Frustum class.
+//
+#include "catch.hh"
+#include "AABB.h"
+#include "Frustum.h"
+#include "Matrix4.h"
+
+TEST_CASE("Frustum from identity matrix is the unit cube")
+{
+	// With an identity matrix, clip space equals world space.
+	// So, the frustum should just be the box from (-1, -1, -1) to (1, 1, 1).
+	Frustum frustum(Matrix4::Identity);
+	REQUIRE(frustum.ContainsPoint(Vector3::Zero));
+	REQUIRE(frustum.ContainsPoint(Vector3(0.99f, -0.99f, 0.5f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(1.01f, 0.0f, 0.0f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(0.0f, -1.01f, 0.0f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(0.0f, 0.0f, 2.0f)));
+	
+	// Planes should be normalized and facing inward.
+	for(int i = 0; i < Frustum::kPlaneCount; ++i)
+	{
+		REQUIRE(Math::AreEqual(frustum.planes[i].normal.GetLength(), 1.0f));
+		REQUIRE(frustum.planes[i].GetSignedDistance(Vector3::Zero) > 0.0f);
+	}
+}
+
+TEST_CASE("Frustum AABB and sphere tests")
+{
+	// Scaling by 0.1 makes the frustum a box from (-10, -10, -10) to (10, 10, 10).
+	Frustum frustum(Matrix4::MakeScale(0.1f));
+	
+	// Inside, overlapping, and fully outside.
+	REQUIRE(frustum.IntersectsAABB(AABB(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f))));
+	REQUIRE(frustum.IntersectsAABB(AABB(Vector3(9.0f, 9.0f, 9.0f), Vector3(20.0f, 20.0f, 20.0f))));
+	REQUIRE(frustum.IntersectsAABB(AABB(Vector3(-100.0f, -100.0f, -100.0f), Vector3(100.0f, 100.0f, 100.0f))));
+	REQUIRE(!frustum.IntersectsAABB(AABB(Vector3(11.0f, 0.0f, 0.0f), Vector3(20.0f, 1.0f, 1.0f))));
+	REQUIRE(!frustum.IntersectsAABB(AABB(Vector3(0.0f, 0.0f, -30.0f), Vector3(1.0f, 1.0f, -10.5f))));
+	
+	REQUIRE(frustum.IntersectsSphere(Vector3(12.0f, 0.0f, 0.0f), 2.5f));
+	REQUIRE(!frustum.IntersectsSphere(Vector3(12.0f, 0.0f, 0.0f), 1.5f));
+}
+
+TEST_CASE("Frustum from perspective matrix")
+{
+	// A left-handed perspective projection with 90 degree FOV, aspect ratio 1, near 1, far 100.
+	// In view space, visible points have 1 <= z <= 100 and |x|,|y| <= z.
+	float near = 1.0f;
+	float far = 100.0f;
+	Matrix4 proj = Matrix4::Zero;
+	proj(0, 0) = 1.0f;
+	proj(1, 1) = 1.0f;
+	proj(3, 2) = 1.0f;
+	proj(2, 2) = -(far + near) / (far - near);
+	proj(2, 3) = (2.0f * near * far) / (far - near);
+	
+	// Put the camera at (0, 0, -50) looking down +Z.
+	Matrix4 view = Matrix4::MakeTranslate(Vector3(0.0f, 0.0f, 50.0f));
+	Frustum frustum(proj * view);
+	
+	REQUIRE(frustum.ContainsPoint(Vector3(0.0f, 0.0f, 0.0f)));
+	REQUIRE(frustum.ContainsPoint(Vector3(45.0f, -45.0f, 0.0f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(55.0f, 0.0f, 0.0f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(0.0f, 0.0f, -49.5f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(0.0f, 0.0f, 51.0f)));
+	REQUIRE(!frustum.ContainsPoint(Vector3(0.0f, 0.0f, -60.0f)));
+}
+
+TEST_CASE("Frustum batched AABB culling matches single tests")
+{
+	Frustum frustum(Matrix4::MakeScale(0.1f));
+	
+	// Enough boxes to use SIMD batches and the scalar remainder.
+	std::vector<AABB> aabbs;
+	for(int i = 0; i < 11; ++i)
+	{
+		Vector3 center(-25.0f + i * 5.0f, static_cast<float>(i % 3), 0.0f);
+		aabbs.emplace_back(center, 2.0f, 2.0f, 2.0f);
+	}
+	
+	std::vector<int> visible;
+	frustum.CullAABBs(aabbs, visible);
+	
+	std::vector<int> expected;
+	for(int i = 0; i < static_cast<int>(aabbs.size()); ++i)
+	{
+		if(frustum.IntersectsAABB(aabbs[i]))
+		{
+			expected.push_back(i);
+		}
+	}
+	REQUIRE(visible == expected);
+	REQUIRE(visible.size() == 5);
+}
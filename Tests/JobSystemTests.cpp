@@ -0,0 +1,124 @@
+//
+// JobSystemTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for JobSystem class.
+//
+#include "catch.hh"
+#include "JobSystem.h"
+
+#include <vector>
+
+TEST_CASE("Job system parallel for covers every index once")
+{
+	JobSystem jobSystem;
+	jobSystem.Init(3);
+	REQUIRE(jobSystem.GetThreadCount() == 4);
+
+	std::vector<int> hits(10000, 0);
+	jobSystem.ParallelFor(static_cast<int>(hits.size()), 64, [&hits](int start, int end) {
+		for(int i = start; i < end; ++i)
+		{
+			++hits[i];
+		}
+	});
+	for(int hit : hits)
+	{
+		REQUIRE(hit == 1);
+	}
+
+	// Counts smaller than a batch run right away, on this thread.
+	int calls = 0;
+	int lastEnd = 0;
+	jobSystem.ParallelFor(10, 64, [&calls, &lastEnd](int, int end) {
+		++calls;
+		lastEnd = end;
+	});
+	REQUIRE(calls == 1);
+	REQUIRE(lastEnd == 10);
+}
+
+TEST_CASE("Job system dependencies wait for counters")
+{
+	JobSystem jobSystem;
+	jobSystem.Init(3);
+
+	// Second group only starts once every job in the first group is done.
+	std::atomic<int> firstDone { 0 };
+	std::atomic<int> secondSawAllFirst { 0 };
+	JobCounter firstCounter;
+	JobCounter secondCounter;
+	for(int i = 0; i < 32; ++i)
+	{
+		jobSystem.Run([&firstDone]() {
+			std::this_thread::yield();
+			++firstDone;
+		}, &firstCounter);
+	}
+	for(int i = 0; i < 8; ++i)
+	{
+		jobSystem.Run([&secondSawAllFirst, &firstDone]() {
+			if(firstDone == 32) { ++secondSawAllFirst; }
+		}, &secondCounter, &firstCounter);
+	}
+	jobSystem.Wait(secondCounter);
+	REQUIRE(firstCounter.IsDone());
+	REQUIRE(firstDone == 32);
+	REQUIRE(secondSawAllFirst == 8);
+
+	// Jobs can queue more jobs on the same counter.
+	std::atomic<int> childCount { 0 };
+	JobCounter parentCounter;
+	for(int i = 0; i < 4; ++i)
+	{
+		jobSystem.Run([&jobSystem, &childCount, &parentCounter]() {
+			for(int j = 0; j < 4; ++j)
+			{
+				jobSystem.Run([&childCount]() { ++childCount; }, &parentCounter);
+			}
+		}, &parentCounter);
+	}
+	jobSystem.Wait(parentCounter);
+	REQUIRE(childCount == 16);
+}
+
+TEST_CASE("Job system main thread jobs run on the main thread")
+{
+	JobSystem jobSystem;
+	jobSystem.Init(2);
+	REQUIRE(jobSystem.IsMainThread());
+
+	// Queued from a worker, run during RunMainThreadJobs.
+	std::atomic<int> mainThreadRuns { 0 };
+	std::atomic<int> otherThreadRuns { 0 };
+	// Catch isn't thread safe, so jobs just record what happened for the main thread to check.
+	std::atomic<bool> queuedFromWorker { false };
+	JobCounter counter;
+	jobSystem.Run([&]() {
+		queuedFromWorker = !jobSystem.IsMainThread();
+		jobSystem.Run([&]() {
+			if(jobSystem.IsMainThread()) { ++mainThreadRuns; } else { ++otherThreadRuns; }
+		}, nullptr, nullptr, JobAffinity::MainThread);
+	}, &counter, nullptr);
+	while(!counter.IsDone())
+	{
+		std::this_thread::yield();
+	}
+	REQUIRE(mainThreadRuns == 0);
+	jobSystem.RunMainThreadJobs();
+	REQUIRE(queuedFromWorker);
+	REQUIRE(mainThreadRuns == 1);
+
+	// Waiting on the main thread also runs them - otherwise this would never finish.
+	JobCounter mainCounter;
+	for(int i = 0; i < 5; ++i)
+	{
+		jobSystem.Run([&]() {
+			if(jobSystem.IsMainThread()) { ++mainThreadRuns; } else { ++otherThreadRuns; }
+		}, &mainCounter, nullptr, JobAffinity::MainThread);
+	}
+	jobSystem.Wait(mainCounter);
+	REQUIRE(mainThreadRuns == 6);
+	REQUIRE(otherThreadRuns == 0);
+}
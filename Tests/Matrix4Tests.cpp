@@ -8,6 +8,63 @@
 #include "catch.hh"
 #include "Matrix4.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    float RandomFloat(float min, float max)
+    {
+        return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
+    }
+    
+    // Translate * rotate * non-uniform scale, like a scene object's local-to-world matrix.
+    Matrix4 MakeRandomTransform()
+    {
+        Vector3 axis(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(0.1f, 1.0f));
+        axis.Normalize();
+        Quaternion rotation(axis, RandomFloat(-Math::kPi, Math::kPi));
+        Vector3 scale(RandomFloat(0.5f, 3.0f), RandomFloat(0.5f, 3.0f), RandomFloat(0.5f, 3.0f));
+        Vector3 translation(RandomFloat(-50.0f, 50.0f), RandomFloat(-50.0f, 50.0f), RandomFloat(-50.0f, 50.0f));
+        return Matrix4::MakeTranslate(translation) * Matrix4::MakeRotate(rotation) * Matrix4::MakeScale(scale);
+    }
+    
+    // Math::AreEqual is too strict once translations are involved; allow some relative error.
+    bool NearlyEqual(float a, float b)
+    {
+        return Math::Abs(a - b) <= 1.0e-4f * Math::Max(1.0f, Math::Max(Math::Abs(a), Math::Abs(b)));
+    }
+    
+    bool NearlyEqual(const Matrix4& a, const Matrix4& b)
+    {
+        for(int i = 0; i < 16; ++i)
+        {
+            if(!NearlyEqual(a(i % 4, i / 4), b(i % 4, i / 4))) { return false; }
+        }
+        return true;
+    }
+    
+    bool NearlyEqual(const Vector3& a, const Vector3& b)
+    {
+        return NearlyEqual(a.x, b.x) && NearlyEqual(a.y, b.y) && NearlyEqual(a.z, b.z);
+    }
+    
+    // The element-by-element multiply, for comparing against.
+    Matrix4 MultiplyReference(const Matrix4& lhs, const Matrix4& rhs)
+    {
+        Matrix4 result;
+        for(int row = 0; row < 4; ++row)
+        {
+            for(int col = 0; col < 4; ++col)
+            {
+                result(row, col) = lhs(row, 0) * rhs(0, col) + lhs(row, 1) * rhs(1, col) + lhs(row, 2) * rhs(2, col) + lhs(row, 3) * rhs(3, col);
+            }
+        }
+        return result;
+    }
+}
+
 SCENARIO("Multiply Two Matrix4")
 {
     GIVEN("Two Matrix4")
@@ -144,3 +201,106 @@ TEST_CASE("Extract Translation/Rotation from Matrix4")
 	REQUIRE(extractedTranslation == translation);
 	REQUIRE(extractedRotation == rotation);
 }
+
+TEST_CASE("Test transform Matrix4 math matches general math")
+{
+    srand(2468);
+    for(int i = 0; i < 100; ++i)
+    {
+        Matrix4 transform = MakeRandomTransform();
+        Matrix4 other = MakeRandomTransform();
+        REQUIRE(NearlyEqual(transform * other, MultiplyReference(transform, other)));
+        
+        // The transform-only inverse should agree with the general one, and undo the transform.
+        Matrix4 inverse = Matrix4::InverseTransform(transform);
+        REQUIRE(NearlyEqual(inverse, Matrix4::Inverse(transform)));
+        REQUIRE(NearlyEqual(transform * inverse, Matrix4::Identity));
+        
+        // Points and vectors are the same as multiplying with w = 1 and w = 0.
+        Vector3 point(RandomFloat(-100.0f, 100.0f), RandomFloat(-100.0f, 100.0f), RandomFloat(-100.0f, 100.0f));
+        Vector4 point4 = transform * Vector4(point, 1.0f);
+        Vector4 vector4 = transform * Vector4(point, 0.0f);
+        REQUIRE(NearlyEqual(transform.TransformPoint(point), Vector3(point4.x, point4.y, point4.z)));
+        REQUIRE(NearlyEqual(transform.TransformVector(point), Vector3(vector4.x, vector4.y, vector4.z)));
+        REQUIRE(NearlyEqual(inverse.TransformPoint(transform.TransformPoint(point)), point));
+    }
+    
+    // A matrix with no inverse is left alone.
+    Matrix4 singular = Matrix4::MakeScale(Vector3(1.0f, 0.0f, 1.0f));
+    REQUIRE(Matrix4::Inverse(singular) == singular);
+}
+
+// Hidden by default - run with the "[benchmark]" tag.
+TEST_CASE("Matrix4 math benchmark", "[.][benchmark]")
+{
+    // About as many transforms as a busy scene updates in a frame.
+    const int kCount = 1000;
+    const int kIterations = 200;
+    srand(1234);
+    std::vector<Matrix4> transforms;
+    for(int i = 0; i < kCount; ++i)
+    {
+        transforms.push_back(MakeRandomTransform());
+    }
+    std::vector<Matrix4> results(kCount);
+    Vector3 point(1.0f, 2.0f, 3.0f);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        for(int j = 1; j < kCount; ++j)
+        {
+            results[j] = transforms[j - 1] * transforms[j];
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double multiplyMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+    
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        for(int j = 1; j < kCount; ++j)
+        {
+            results[j] = MultiplyReference(transforms[j - 1], transforms[j]);
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double referenceMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+    
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        for(int j = 0; j < kCount; ++j)
+        {
+            results[j] = Matrix4::Inverse(transforms[j]);
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double inverseMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+    
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        for(int j = 0; j < kCount; ++j)
+        {
+            results[j] = Matrix4::InverseTransform(transforms[j]);
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double inverseTransformMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+    
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        for(int j = 0; j < kCount; ++j)
+        {
+            point = transforms[j].TransformPoint(point) * 0.001f;
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double transformPointMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+    
+    std::cout << "Matrix4 x" << kCount << ": multiply " << multiplyMs << "ms (reference " << referenceMs << "ms), inverse "
+              << inverseMs << "ms, inverse transform " << inverseTransformMs << "ms, transform point " << transformPointMs << "ms" << std::endl;
+    REQUIRE(results.size() == kCount);
+}
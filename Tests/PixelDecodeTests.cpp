@@ -0,0 +1,164 @@
+//
+// PixelDecodeTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for PixelDecode functions.
+//
+#include "catch.hh"
+#include "PixelDecode.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	// One pixel at a time, the obvious way.
+	void ReferenceRGB565ToRGBA8(uint16_t pixel, uint8_t* dst)
+	{
+		int red = (pixel >> 11) & 0x1F;
+		int green = (pixel >> 5) & 0x3F;
+		int blue = pixel & 0x1F;
+		dst[0] = static_cast<uint8_t>((red << 3) | (red >> 2));
+		dst[1] = static_cast<uint8_t>((green << 2) | (green >> 4));
+		dst[2] = static_cast<uint8_t>((blue << 3) | (blue >> 2));
+		dst[3] = (dst[0] > 200 && dst[1] < 100 && dst[2] > 200) ? 0 : 255;
+	}
+
+	std::vector<uint8_t> MakeRGB565(const std::vector<uint16_t>& pixels)
+	{
+		std::vector<uint8_t> bytes(pixels.size() * 2);
+		for(int i = 0; i < pixels.size(); ++i)
+		{
+			bytes[i * 2] = pixels[i] & 0xFF;
+			bytes[i * 2 + 1] = pixels[i] >> 8;
+		}
+		return bytes;
+	}
+}
+
+TEST_CASE("RGB565 decode matches reference for every color")
+{
+	std::vector<uint16_t> pixels(65536);
+	for(int i = 0; i < pixels.size(); ++i)
+	{
+		pixels[i] = static_cast<uint16_t>(i);
+	}
+	std::vector<uint8_t> src = MakeRGB565(pixels);
+
+	std::vector<uint8_t> decoded(pixels.size() * 4);
+	bool anyTransparent = PixelDecode::RGB565ToRGBA8(src.data(), static_cast<int>(pixels.size()), decoded.data());
+	REQUIRE(anyTransparent);
+
+	int mismatchCount = 0;
+	for(int i = 0; i < pixels.size(); ++i)
+	{
+		uint8_t expected[4];
+		ReferenceRGB565ToRGBA8(pixels[i], expected);
+		for(int c = 0; c < 4; ++c)
+		{
+			if(decoded[i * 4 + c] != expected[c])
+			{
+				++mismatchCount;
+			}
+		}
+	}
+	REQUIRE(mismatchCount == 0);
+
+	// Extremes map exactly.
+	REQUIRE(decoded[0] == 0);
+	REQUIRE(decoded[0xFFFF * 4] == 255);
+	REQUIRE(decoded[0xFFFF * 4 + 1] == 255);
+	REQUIRE(decoded[0xFFFF * 4 + 2] == 255);
+}
+
+TEST_CASE("RGB565 decode handles partial runs and transparency detection")
+{
+	// Odd lengths exercise the scalar tail after any SIMD part. Only the last pixel is magenta.
+	const uint16_t kWhite = 0xFFFF;
+	const uint16_t kMagenta = 0xF81F;
+	for(int count = 1; count <= 19; ++count)
+	{
+		std::vector<uint16_t> pixels(count, kWhite);
+		std::vector<uint8_t> src = MakeRGB565(pixels);
+		std::vector<uint8_t> decoded(count * 4 + 4, 123);
+		REQUIRE_FALSE(PixelDecode::RGB565ToRGBA8(src.data(), count, decoded.data()));
+
+		pixels.back() = kMagenta;
+		src = MakeRGB565(pixels);
+		REQUIRE(PixelDecode::RGB565ToRGBA8(src.data(), count, decoded.data()));
+		REQUIRE(decoded[(count - 1) * 4 + 3] == 0);
+		REQUIRE(decoded[count * 4] == 123);
+	}
+}
+
+TEST_CASE("Palette and BGR decode")
+{
+	// Palette is BGRA, with alpha typically zero.
+	const uint8_t palette[] = { 10, 20, 30, 0,   40, 50, 60, 0 };
+	uint32_t table[256];
+	PixelDecode::BuildPaletteTable(palette, 2, table);
+
+	const uint8_t indexes[] = { 1, 0, 200 };
+	uint8_t decoded[12];
+	PixelDecode::PaletteToRGBA8(indexes, 3, table, decoded);
+	REQUIRE(std::vector<uint8_t>(decoded, decoded + 12) == std::vector<uint8_t>({ 60, 50, 40, 255,   30, 20, 10, 255,   0, 0, 0, 255 }));
+
+	// 24-bit and 32-bit BGR both end up as RGBA with full alpha.
+	const uint8_t bgr24[] = { 1, 2, 3,   4, 5, 6 };
+	PixelDecode::BGRToRGBA8(bgr24, 2, 3, decoded);
+	REQUIRE(std::vector<uint8_t>(decoded, decoded + 8) == std::vector<uint8_t>({ 3, 2, 1, 255,   6, 5, 4, 255 }));
+
+	const uint8_t bgr32[] = { 1, 2, 3, 0,   4, 5, 6, 0 };
+	PixelDecode::BGRToRGBA8(bgr32, 2, 4, decoded);
+	REQUIRE(std::vector<uint8_t>(decoded, decoded + 8) == std::vector<uint8_t>({ 3, 2, 1, 255,   6, 5, 4, 255 }));
+}
+
+// Hidden by default - run with the "[benchmark]" tag.
+TEST_CASE("RGB565 decode benchmark", "[.][benchmark]")
+{
+	// About the size of a large scene texture.
+	const int kPixelCount = 512 * 512;
+	const int kIterations = 50;
+	std::vector<uint16_t> pixels(kPixelCount);
+	srand(1234);
+	for(auto& pixel : pixels)
+	{
+		pixel = static_cast<uint16_t>(rand());
+	}
+	std::vector<uint8_t> src = MakeRGB565(pixels);
+	std::vector<uint8_t> decoded(kPixelCount * 4);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < kIterations; ++i)
+	{
+		PixelDecode::RGB565ToRGBA8(src.data(), kPixelCount, decoded.data());
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double bulkMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+
+	// The per-pixel float conversion this replaced.
+	start = std::chrono::high_resolution_clock::now();
+	for(int i = 0; i < kIterations; ++i)
+	{
+		for(int p = 0; p < kPixelCount; ++p)
+		{
+			uint16_t pixel = pixels[p];
+			float red = static_cast<float>((pixel & 0xF800) >> 11);
+			float green = static_cast<float>((pixel & 0x07E0) >> 5);
+			float blue = static_cast<float>((pixel & 0x001F));
+			uint8_t* dst = &decoded[p * 4];
+			dst[0] = (unsigned char)(red * 255 / 31);
+			dst[1] = (unsigned char)(green * 255 / 63);
+			dst[2] = (unsigned char)(blue * 255 / 31);
+			dst[3] = (dst[0] > 200 && dst[1] < 100 && dst[2] > 200) ? 0 : 255;
+		}
+	}
+	end = std::chrono::high_resolution_clock::now();
+	double perPixelMs = std::chrono::duration<double, std::milli>(end - start).count() / kIterations;
+
+	std::cout << "RGB565 512x512: bulk " << bulkMs << "ms, per-pixel float " << perPixelMs << "ms" << std::endl;
+	REQUIRE(decoded.size() == kPixelCount * 4);
+}
@@ -88,3 +88,22 @@ TEST_CASE("Test quaternion addition and subtraction")
 
 
 
+
+TEST_CASE("Test quaternion slerp")
+{
+    Quaternion start = Quaternion::Identity;
+    Quaternion end(Vector3::UnitY, Math::kPiOver2);
+    
+    Quaternion result;
+    Quaternion::Slerp(result, start, end, 0.0f);
+    REQUIRE(result == start);
+    Quaternion::Slerp(result, start, end, 1.0f);
+    REQUIRE(result == end);
+    Quaternion::Slerp(result, start, end, 0.5f);
+    REQUIRE(result == Quaternion(Vector3::UnitY, Math::kPiOver2 / 2.0f));
+    REQUIRE(result.IsUnit());
+    
+    // The result can also be one of the inputs.
+    Quaternion::Slerp(start, start, end, 0.25f);
+    REQUIRE(start == Quaternion(Vector3::UnitY, Math::kPiOver2 / 4.0f));
+}
@@ -0,0 +1,80 @@
+//
+// SampleWindowTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for the SampleWindow class.
+//
+#include "catch.hh"
+#include "SampleWindow.h"
+
+TEST_CASE("Empty sample window reports zero")
+{
+	SampleWindow window(8);
+	REQUIRE(window.GetCount() == 0);
+	REQUIRE(window.GetPercentile(0.5f) == 0.0f);
+	REQUIRE(window.GetStandardDeviation() == 0.0f);
+}
+
+TEST_CASE("Sample window reports when it fills")
+{
+	SampleWindow window(4);
+	REQUIRE_FALSE(window.Add(1.0f));
+	REQUIRE_FALSE(window.Add(2.0f));
+	REQUIRE_FALSE(window.Add(3.0f));
+	REQUIRE(window.Add(4.0f));
+	REQUIRE(window.GetCount() == 4);
+	
+	// Keeps reporting every "capacity" samples, but never grows past capacity.
+	REQUIRE_FALSE(window.Add(5.0f));
+	REQUIRE_FALSE(window.Add(6.0f));
+	REQUIRE_FALSE(window.Add(7.0f));
+	REQUIRE(window.Add(8.0f));
+	REQUIRE(window.GetCount() == 4);
+}
+
+TEST_CASE("Sample window percentiles use only recent samples")
+{
+	SampleWindow window(5);
+	
+	// Samples added in no particular order.
+	window.Add(30.0f);
+	window.Add(10.0f);
+	window.Add(50.0f);
+	window.Add(20.0f);
+	window.Add(40.0f);
+	REQUIRE(window.GetPercentile(0.0f) == 10.0f);
+	REQUIRE(window.GetPercentile(0.5f) == 30.0f);
+	REQUIRE(window.GetPercentile(1.0f) == 50.0f);
+	
+	// Out of range percentiles are clamped.
+	REQUIRE(window.GetPercentile(-1.0f) == 10.0f);
+	REQUIRE(window.GetPercentile(2.0f) == 50.0f);
+	
+	// Replacing the oldest samples (30 and 10) shifts the stats.
+	window.Add(100.0f);
+	window.Add(60.0f);
+	REQUIRE(window.GetPercentile(0.0f) == 20.0f);
+	REQUIRE(window.GetPercentile(0.5f) == 50.0f);
+	REQUIRE(window.GetPercentile(1.0f) == 100.0f);
+}
+
+TEST_CASE("Sample window standard deviation")
+{
+	SampleWindow window(8);
+	
+	// Steady samples have no deviation.
+	for(int i = 0; i < 8; ++i)
+	{
+		window.Add(16.0f);
+	}
+	REQUIRE(window.GetStandardDeviation() == Approx(0.0f));
+	
+	// Classic example: 2, 4, 4, 4, 5, 5, 7, 9 has a mean of 5 and standard deviation of 2.
+	float samples[] = { 2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f };
+	for(float sample : samples)
+	{
+		window.Add(sample);
+	}
+	REQUIRE(window.GetStandardDeviation() == Approx(2.0f));
+}
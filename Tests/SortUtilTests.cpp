@@ -0,0 +1,119 @@
+//
+// SortUtilTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for SortUtil functions.
+//
+#include "catch.hh"
+#include "SortUtil.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// Runs a radix sort on keys, with indexes initialized to 0..n-1.
+	void Sort(std::vector<uint32_t>& keys, std::vector<uint32_t>& indexes)
+	{
+		indexes.resize(keys.size());
+		for(uint32_t i = 0; i < indexes.size(); ++i)
+		{
+			indexes[i] = i;
+		}
+
+		std::vector<uint32_t> tempKeys;
+		std::vector<uint32_t> tempIndexes;
+		SortUtil::RadixSort(keys, indexes, tempKeys, tempIndexes);
+	}
+
+	// Sorts the same keys with std::stable_sort, for comparison.
+	std::vector<uint32_t> StableSortIndexes(const std::vector<uint32_t>& keys)
+	{
+		std::vector<uint32_t> indexes(keys.size());
+		for(uint32_t i = 0; i < indexes.size(); ++i)
+		{
+			indexes[i] = i;
+		}
+		std::stable_sort(indexes.begin(), indexes.end(), [&keys](uint32_t a, uint32_t b) {
+			return keys[a] < keys[b];
+		});
+		return indexes;
+	}
+}
+
+TEST_CASE("Radix sort handles empty and single-item input")
+{
+	std::vector<uint32_t> keys;
+	std::vector<uint32_t> indexes;
+	Sort(keys, indexes);
+	REQUIRE(keys.empty());
+	REQUIRE(indexes.empty());
+
+	keys.push_back(0xDEADBEEF);
+	Sort(keys, indexes);
+	REQUIRE(keys.size() == 1);
+	REQUIRE(keys[0] == 0xDEADBEEF);
+	REQUIRE(indexes[0] == 0);
+}
+
+TEST_CASE("Radix sort orders keys ascending")
+{
+	std::vector<uint32_t> keys = { 5, 3, 0xFFFFFFFF, 0, 256, 1, 0x01000000, 255, 65536 };
+	std::vector<uint32_t> original = keys;
+	std::vector<uint32_t> indexes;
+	Sort(keys, indexes);
+
+	std::vector<uint32_t> expected = original;
+	std::sort(expected.begin(), expected.end());
+	REQUIRE(keys == expected);
+
+	// Each index should still point at the key it came with.
+	for(std::size_t i = 0; i < keys.size(); ++i)
+	{
+		REQUIRE(original[indexes[i]] == keys[i]);
+	}
+}
+
+TEST_CASE("Radix sort is stable for duplicate keys")
+{
+	// Duplicates spread through the input; equal keys must keep submission order.
+	std::vector<uint32_t> keys = { 7, 2, 7, 2, 7, 0, 2, 0 };
+	std::vector<uint32_t> expectedIndexes = StableSortIndexes(keys);
+	std::vector<uint32_t> indexes;
+	Sort(keys, indexes);
+	REQUIRE(indexes == expectedIndexes);
+}
+
+TEST_CASE("Radix sort is stable for keys that differ only in high bytes")
+{
+	// Low bytes are identical, so the early passes are skipped and only the high byte passes move anything.
+	// Duplicates in the high bytes must still keep submission order.
+	std::vector<uint32_t> keys = {
+		0xFF000010, 0x01000010, 0x80000010, 0x01000010,
+		0x00010010, 0xFF000010, 0x00010010, 0x80000010
+	};
+	std::vector<uint32_t> expectedIndexes = StableSortIndexes(keys);
+	std::vector<uint32_t> indexes;
+	Sort(keys, indexes);
+	REQUIRE(indexes == expectedIndexes);
+	REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+TEST_CASE("Radix sort matches std::stable_sort for random keys")
+{
+	// Render queue keys pack shader/texture/depth IDs, so use a small set of values per byte to get lots of duplicates.
+	std::srand(12345);
+	std::vector<uint32_t> keys(2000);
+	for(auto& key : keys)
+	{
+		key = (static_cast<uint32_t>(std::rand() % 4) << 24) |
+			  (static_cast<uint32_t>(std::rand() % 3) << 12) |
+			  static_cast<uint32_t>(std::rand() % 5);
+	}
+	std::vector<uint32_t> expectedIndexes = StableSortIndexes(keys);
+	std::vector<uint32_t> indexes;
+	Sort(keys, indexes);
+	REQUIRE(indexes == expectedIndexes);
+}
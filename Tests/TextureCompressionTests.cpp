@@ -0,0 +1,201 @@
+//
+// TextureCompressionTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for TextureCompression functions.
+//
+#include "catch.hh"
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	void DecodeRGB565(uint16_t value, int* color)
+	{
+		int red = (value >> 11) & 0x1F;
+		int green = (value >> 5) & 0x3F;
+		int blue = value & 0x1F;
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	// Decodes a color block the way the GPU does (4-color mode only, as used by BC3 and by BC1 when color0 > color1).
+	void DecodeColorBlock(const uint8_t* block, int pixelIndex, int* color)
+	{
+		uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+		uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+		int palette[4][3];
+		DecodeRGB565(color0, palette[0]);
+		DecodeRGB565(color1, palette[1]);
+		for(int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		uint32_t indexes = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+		int index = (indexes >> (pixelIndex * 2)) & 3;
+		for(int c = 0; c < 3; ++c)
+		{
+			color[c] = palette[index][c];
+		}
+	}
+
+	int DecodeAlphaBlock(const uint8_t* block, int pixelIndex)
+	{
+		int alpha0 = block[0];
+		int alpha1 = block[1];
+		uint64_t indexes = 0;
+		for(int i = 0; i < 6; ++i)
+		{
+			indexes |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+		int index = (indexes >> (pixelIndex * 3)) & 7;
+		if(index == 0) { return alpha0; }
+		if(index == 1) { return alpha1; }
+		if(alpha0 > alpha1) { return ((8 - index) * alpha0 + (index - 1) * alpha1) / 7; }
+		if(index == 6) { return 0; }
+		if(index == 7) { return 255; }
+		return ((6 - index) * alpha0 + (index - 1) * alpha1) / 5;
+	}
+
+	// Largest per-channel difference between the original and decoded BC3 image.
+	void GetBC3MaxErrors(const std::vector<uint8_t>& pixels, int width, int height, int& maxColorError, int& maxAlphaError)
+	{
+		std::vector<uint8_t> compressed(TextureCompression::GetBC3Size(width, height));
+		TextureCompression::EncodeBC3(pixels.data(), width, height, compressed.data());
+
+		maxColorError = 0;
+		maxAlphaError = 0;
+		int blocksWide = (width + 3) / 4;
+		for(int y = 0; y < height; ++y)
+		{
+			for(int x = 0; x < width; ++x)
+			{
+				const uint8_t* block = &compressed[((y / 4) * blocksWide + (x / 4)) * 16];
+				int pixelIndex = (y % 4) * 4 + (x % 4);
+				const uint8_t* pixel = &pixels[(y * width + x) * 4];
+
+				int alpha = DecodeAlphaBlock(block, pixelIndex);
+				maxAlphaError = std::max(maxAlphaError, std::abs(alpha - pixel[3]));
+
+				// Color doesn't matter for fully transparent pixels.
+				if(pixel[3] == 0) { continue; }
+				int color[3];
+				DecodeColorBlock(block + 8, pixelIndex, color);
+				for(int c = 0; c < 3; ++c)
+				{
+					maxColorError = std::max(maxColorError, std::abs(color[c] - pixel[c]));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Compressed sizes round up to whole blocks")
+{
+	REQUIRE(TextureCompression::GetBC1Size(4, 4) == 8);
+	REQUIRE(TextureCompression::GetBC1Size(5, 4) == 16);
+	REQUIRE(TextureCompression::GetBC1Size(1, 1) == 8);
+	REQUIRE(TextureCompression::GetBC3Size(256, 128) == 64 * 32 * 16);
+	REQUIRE(TextureCompression::GetBC3Size(6, 6) == 4 * 16);
+}
+
+TEST_CASE("BC1 encodes a solid color block as a single endpoint")
+{
+	std::vector<uint8_t> pixels(4 * 4 * 4);
+	for(int i = 0; i < 16; ++i)
+	{
+		pixels[i * 4] = 255;
+		pixels[i * 4 + 1] = 0;
+		pixels[i * 4 + 2] = 255;
+		pixels[i * 4 + 3] = 255;
+	}
+	uint8_t compressed[8];
+	TextureCompression::EncodeBC1(pixels.data(), 4, 4, compressed);
+
+	// Pure magenta is exactly representable in RGB565, and every pixel uses it.
+	for(int i = 0; i < 16; ++i)
+	{
+		int color[3];
+		DecodeColorBlock(compressed, i, color);
+		REQUIRE(color[0] == 255);
+		REQUIRE(color[1] == 0);
+		REQUIRE(color[2] == 255);
+	}
+}
+
+TEST_CASE("BC3 keeps alpha-tested edges exact and colors close")
+{
+	// A gradient (along a line in color space, which BC formats can represent) with a transparent (color-keyed) hole.
+	// The size isn't a multiple of the block size.
+	const int kWidth = 19;
+	const int kHeight = 13;
+	std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+	for(int y = 0; y < kHeight; ++y)
+	{
+		for(int x = 0; x < kWidth; ++x)
+		{
+			uint8_t* pixel = &pixels[(y * kWidth + x) * 4];
+			bool hole = x > 5 && x < 10 && y > 3 && y < 9;
+			pixel[0] = hole ? 255 : static_cast<uint8_t>(x * 12);
+			pixel[1] = hole ? 0 : static_cast<uint8_t>(x * 12);
+			pixel[2] = hole ? 255 : 100;
+			pixel[3] = hole ? 0 : 255;
+		}
+	}
+
+	int maxColorError = 0;
+	int maxAlphaError = 0;
+	GetBC3MaxErrors(pixels, kWidth, kHeight, maxColorError, maxAlphaError);
+	REQUIRE(maxAlphaError == 0);
+
+	// Magenta in the hole must not drag neighboring block colors away from the gradient.
+	REQUIRE(maxColorError <= 12);
+}
+
+TEST_CASE("BC3 smooth alpha stays within interpolation error")
+{
+	const int kSize = 16;
+	std::vector<uint8_t> pixels(kSize * kSize * 4);
+	for(int i = 0; i < kSize * kSize; ++i)
+	{
+		pixels[i * 4] = 50;
+		pixels[i * 4 + 1] = 100;
+		pixels[i * 4 + 2] = 150;
+		pixels[i * 4 + 3] = static_cast<uint8_t>(i);
+	}
+
+	int maxColorError = 0;
+	int maxAlphaError = 0;
+	GetBC3MaxErrors(pixels, kSize, kSize, maxColorError, maxAlphaError);
+
+	// Each block spans 51 alpha values, with 8 alphas to pick from - so error is at most about 51 / 14.
+	REQUIRE(maxAlphaError <= 4);
+	REQUIRE(maxColorError <= 4);
+}
+
+TEST_CASE("Halving averages 2x2 squares down to 1x1")
+{
+	// 3x2: odd width drops the last column.
+	const uint8_t pixels[] = {
+		0, 0, 0, 0,      100, 100, 100, 100,   255, 255, 255, 255,
+		200, 200, 200, 200,   100, 100, 100, 100,   255, 255, 255, 255
+	};
+	uint8_t half[4];
+	TextureCompression::HalveRGBA8(pixels, 3, 2, half);
+	REQUIRE(half[0] == 100);
+	REQUIRE(half[3] == 100);
+
+	// 1x2: only one column to average.
+	const uint8_t column[] = { 10, 20, 30, 40,   30, 40, 50, 60 };
+	TextureCompression::HalveRGBA8(column, 1, 2, half);
+	REQUIRE(half[0] == 20);
+	REQUIRE(half[1] == 30);
+	REQUIRE(half[2] == 40);
+	REQUIRE(half[3] == 50);
+}
@@ -0,0 +1,130 @@
+//
+// TriangleBVHTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for TriangleBVH class.
+//
+#include "catch.hh"
+#include "TriangleBVH.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "Collisions.h"
+#include "Ray.h"
+
+namespace
+{
+	float RandomFloat(float min, float max)
+	{
+		return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
+	}
+
+	Vector3 RandomPoint(float extent)
+	{
+		return Vector3(RandomFloat(-extent, extent), RandomFloat(-extent, extent), RandomFloat(-extent, extent));
+	}
+
+	std::vector<Triangle> MakeTriangles(int count)
+	{
+		std::vector<Triangle> triangles;
+		for(int i = 0; i < count; ++i)
+		{
+			Vector3 center = RandomPoint(100.0f);
+			triangles.emplace_back(center, center + RandomPoint(20.0f), center + RandomPoint(20.0f));
+		}
+		return triangles;
+	}
+
+	// Checks the BVH finds the same nearest "t" as testing every triangle. Returns number of rays that hit.
+	int CheckRaycasts(const TriangleBVH& bvh, const std::vector<Triangle>& triangles)
+	{
+		int hitCount = 0;
+		for(int i = 0; i < 300; ++i)
+		{
+			Vector3 origin = RandomPoint(200.0f);
+			Vector3 direction = RandomPoint(80.0f) - origin;
+			direction.Normalize();
+			Ray ray(origin, direction);
+
+			float expectedT = FLT_MAX;
+			for(auto& triangle : triangles)
+			{
+				RaycastHit hitInfo;
+				if(Collisions::TestRayTriangle(ray, triangle, hitInfo) && hitInfo.t < expectedT)
+				{
+					expectedT = hitInfo.t;
+				}
+			}
+
+			float t = FLT_MAX;
+			int index = -1;
+			bool hit = bvh.Raycast(ray, t, index);
+			REQUIRE(hit == (expectedT < FLT_MAX));
+			if(hit)
+			{
+				// Ties (e.g. hitting a shared edge) could pick either triangle, so check the one found is at the nearest "t".
+				REQUIRE(Math::AreEqual(t, expectedT));
+				RaycastHit hitInfo;
+				REQUIRE(Collisions::TestRayTriangle(ray, triangles[index], hitInfo));
+				REQUIRE(Math::AreEqual(hitInfo.t, expectedT));
+				++hitCount;
+			}
+		}
+		return hitCount;
+	}
+}
+
+TEST_CASE("Triangle BVH raycasts find the nearest hit")
+{
+	srand(9753);
+	std::vector<Triangle> triangles = MakeTriangles(1001);
+	TriangleBVH bvh;
+	bvh.Build(triangles);
+	REQUIRE(bvh.GetTriangleCount() == triangles.size());
+	REQUIRE(CheckRaycasts(bvh, triangles) > 50);
+
+	// Move every triangle, refit, and check again.
+	for(auto& triangle : triangles)
+	{
+		Vector3 offset = RandomPoint(15.0f);
+		triangle.p0 += offset;
+		triangle.p1 += offset;
+		triangle.p2 -= offset;
+	}
+	bvh.Refit(triangles);
+	REQUIRE(CheckRaycasts(bvh, triangles) > 50);
+}
+
+TEST_CASE("Triangle BVH handles small and empty inputs")
+{
+	TriangleBVH bvh;
+	Ray ray(Vector3(0.0f, 0.0f, -10.0f), Vector3::UnitZ);
+	float t = FLT_MAX;
+	int index = -1;
+	REQUIRE(!bvh.Raycast(ray, t, index));
+
+	std::vector<Triangle> triangles;
+	triangles.emplace_back(Vector3(-1.0f, -1.0f, 5.0f), Vector3(1.0f, -1.0f, 5.0f), Vector3(0.0f, 1.0f, 5.0f));
+	bvh.Build(triangles);
+	REQUIRE(bvh.Raycast(ray, t, index));
+	REQUIRE(index == 0);
+	REQUIRE(Math::AreEqual(t, 15.0f));
+
+	// A closer hit passed in is kept.
+	t = 10.0f;
+	index = -1;
+	REQUIRE(!bvh.Raycast(ray, t, index));
+	REQUIRE(index == -1);
+
+	// Refit with a different count rebuilds.
+	triangles.emplace_back(Vector3(-1.0f, -1.0f, 2.0f), Vector3(1.0f, -1.0f, 2.0f), Vector3(0.0f, 1.0f, 2.0f));
+	bvh.Refit(triangles);
+	t = FLT_MAX;
+	REQUIRE(bvh.Raycast(ray, t, index));
+	REQUIRE(index == 1);
+
+	bvh.Clear();
+	REQUIRE(!bvh.Raycast(ray, t, index));
+}
@@ -0,0 +1,180 @@
+//
+// TriangleBatchTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for TriangleBatch class.
+//
+#include "catch.hh"
+#include "TriangleBatch.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "Collisions.h"
+#include "Ray.h"
+#include "Triangle.h"
+
+namespace
+{
+	float RandomFloat(float min, float max)
+	{
+		return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
+	}
+
+	Vector3 RandomPoint(float extent)
+	{
+		return Vector3(RandomFloat(-extent, extent), RandomFloat(-extent, extent), RandomFloat(-extent, extent));
+	}
+
+	Ray MakeRay(const Vector3& origin, const Vector3& target)
+	{
+		Vector3 direction = target - origin;
+		direction.Normalize();
+		return Ray(origin, direction);
+	}
+
+	// Nearest hit in [start, end), one triangle at a time.
+	int RaycastBruteForce(const std::vector<Triangle>& triangles, const Ray& ray, int start, int end, float& outT)
+	{
+		int nearest = -1;
+		outT = FLT_MAX;
+		for(int i = start; i < end; ++i)
+		{
+			RaycastHit hitInfo;
+			if(Collisions::TestRayTriangle(ray, triangles[i], hitInfo) && hitInfo.t < outT)
+			{
+				outT = hitInfo.t;
+				nearest = i;
+			}
+		}
+		return nearest;
+	}
+}
+
+TEST_CASE("Triangle batch raycasts match one-at-a-time tests")
+{
+	// A cloud of fairly big triangles, so plenty of rays hit several of them.
+	srand(1357);
+	std::vector<Triangle> triangles;
+	TriangleBatch batch;
+	for(int i = 0; i < 203; ++i)
+	{
+		Vector3 center = RandomPoint(100.0f);
+		triangles.emplace_back(center, center + RandomPoint(40.0f), center + RandomPoint(40.0f));
+		batch.Add(triangles.back().p0, triangles.back().p1, triangles.back().p2);
+	}
+	REQUIRE(batch.GetTriangleCount() == triangles.size());
+
+	int hitCount = 0;
+	for(int i = 0; i < 500; ++i)
+	{
+		Vector3 target = RandomPoint(80.0f);
+		Vector3 origin = RandomPoint(300.0f);
+		Ray ray = MakeRay(origin, target);
+
+		// Ranges that don't start or end on block boundaries, as well as the whole batch.
+		int start = rand() % 50;
+		int end = start + rand() % 150 + 1;
+		if(i % 4 == 0)
+		{
+			start = 0;
+			end = batch.GetTriangleCount();
+		}
+
+		float expectedT = 0.0f;
+		int expectedIndex = RaycastBruteForce(triangles, ray, start, end, expectedT);
+
+		float t = FLT_MAX;
+		int index = -1;
+		bool hit = batch.Raycast(ray, start, end, t, index);
+		REQUIRE(hit == (expectedIndex >= 0));
+		if(hit)
+		{
+			REQUIRE(index == expectedIndex);
+			REQUIRE(Math::AreEqual(t, expectedT));
+			++hitCount;
+		}
+	}
+	REQUIRE(hitCount > 100);
+}
+
+TEST_CASE("Triangle batch raycasts only replace closer hits")
+{
+	TriangleBatch batch;
+	batch.Add(Vector3(-1.0f, -1.0f, 10.0f), Vector3(1.0f, -1.0f, 10.0f), Vector3(0.0f, 1.0f, 10.0f));
+	batch.Add(Vector3(-1.0f, -1.0f, 20.0f), Vector3(1.0f, -1.0f, 20.0f), Vector3(0.0f, 1.0f, 20.0f));
+	Ray ray(Vector3::Zero, Vector3::UnitZ);
+
+	// A closer hit found earlier (say, in another batch) is kept.
+	float t = 5.0f;
+	int index = -1;
+	REQUIRE(!batch.Raycast(ray, t, index));
+	REQUIRE(t == 5.0f);
+	REQUIRE(index == -1);
+
+	t = FLT_MAX;
+	REQUIRE(batch.Raycast(ray, t, index));
+	REQUIRE(index == 0);
+	REQUIRE(Math::AreEqual(t, 10.0f));
+
+	// Only the farther triangle in range.
+	t = FLT_MAX;
+	REQUIRE(batch.Raycast(ray, 1, 2, t, index));
+	REQUIRE(index == 1);
+	REQUIRE(Math::AreEqual(t, 20.0f));
+
+	// Ray pointing away, and an empty batch.
+	t = FLT_MAX;
+	REQUIRE(!batch.Raycast(Ray(Vector3::Zero, -Vector3::UnitZ), t, index));
+	batch.Clear();
+	REQUIRE(!batch.Raycast(ray, t, index));
+}
+
+// Hidden by default - run with the "[benchmark]" tag.
+TEST_CASE("Triangle batch raycast benchmark", "[.][benchmark]")
+{
+	// About the size of a scene BSP.
+	const int kTriangleCount = 20000;
+	const int kRayCount = 200;
+	srand(2468);
+	std::vector<Triangle> triangles;
+	TriangleBatch batch;
+	for(int i = 0; i < kTriangleCount; ++i)
+	{
+		Vector3 center = RandomPoint(1000.0f);
+		triangles.emplace_back(center, center + RandomPoint(30.0f), center + RandomPoint(30.0f));
+		batch.Add(triangles.back().p0, triangles.back().p1, triangles.back().p2);
+	}
+	std::vector<Ray> rays;
+	for(int i = 0; i < kRayCount; ++i)
+	{
+		Vector3 origin = RandomPoint(1000.0f);
+		rays.push_back(MakeRay(origin, RandomPoint(1000.0f)));
+	}
+
+	int batchHits = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for(auto& ray : rays)
+	{
+		float t = FLT_MAX;
+		int index = -1;
+		batchHits += batch.Raycast(ray, t, index) ? 1 : 0;
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double batchMs = std::chrono::duration<double, std::milli>(end - start).count() / kRayCount;
+
+	int bruteForceHits = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for(auto& ray : rays)
+	{
+		float t = 0.0f;
+		bruteForceHits += RaycastBruteForce(triangles, ray, 0, kTriangleCount, t) >= 0 ? 1 : 0;
+	}
+	end = std::chrono::high_resolution_clock::now();
+	double bruteForceMs = std::chrono::duration<double, std::milli>(end - start).count() / kRayCount;
+
+	std::cout << "Raycast vs " << kTriangleCount << " triangles: batch " << batchMs << "ms, one at a time " << bruteForceMs << "ms" << std::endl;
+	REQUIRE(batchHits == bruteForceHits);
+}
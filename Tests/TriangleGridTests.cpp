@@ -0,0 +1,102 @@
+//
+// TriangleGridTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for TriangleGrid class.
+//
+#include "catch.hh"
+#include "TriangleGrid.h"
+
+#include <cstdlib>
+
+#include "GMath.h"
+
+namespace
+{
+	float RandomFloat(float min, float max)
+	{
+		return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
+	}
+
+	// Every triangle whose bounds overlap the box, the slow way.
+	std::vector<int> QueryBruteForce(const std::vector<Triangle>& triangles, const AABB& aabb)
+	{
+		std::vector<int> indexes;
+		for(int i = 0; i < triangles.size(); ++i)
+		{
+			AABB bounds(triangles[i].p0, triangles[i].p0);
+			bounds.GrowToContain(triangles[i].p1);
+			bounds.GrowToContain(triangles[i].p2);
+			Vector3 min = bounds.GetMin();
+			Vector3 max = bounds.GetMax();
+			if(min.x <= aabb.GetMax().x && max.x >= aabb.GetMin().x &&
+			   min.y <= aabb.GetMax().y && max.y >= aabb.GetMin().y &&
+			   min.z <= aabb.GetMax().z && max.z >= aabb.GetMin().z)
+			{
+				indexes.push_back(i);
+			}
+		}
+		return indexes;
+	}
+}
+
+TEST_CASE("Triangle grid queries match brute force")
+{
+	// A "room" of small triangles, plus a few big ones spanning many cells (like long walls).
+	srand(4321);
+	std::vector<Triangle> triangles;
+	for(int i = 0; i < 500; ++i)
+	{
+		Vector3 center(RandomFloat(-1000.0f, 1000.0f), RandomFloat(0.0f, 200.0f), RandomFloat(-1000.0f, 1000.0f));
+		triangles.emplace_back(center, center + Vector3(RandomFloat(-40.0f, 40.0f), 30.0f, 0.0f), center + Vector3(0.0f, RandomFloat(-40.0f, 40.0f), 25.0f));
+	}
+	triangles.emplace_back(Vector3(-1000.0f, 0.0f, -1000.0f), Vector3(1000.0f, 0.0f, -1000.0f), Vector3(-1000.0f, 200.0f, -1000.0f));
+	triangles.emplace_back(Vector3(-1000.0f, 0.0f, -1000.0f), Vector3(1000.0f, 0.0f, 1000.0f), Vector3(0.0f, 0.0f, 1000.0f));
+
+	TriangleGrid grid;
+	grid.Build(triangles);
+	REQUIRE(grid.GetTriangleCount() == triangles.size());
+
+	std::vector<int> found;
+	int totalFound = 0;
+	for(int i = 0; i < 200; ++i)
+	{
+		// Include boxes hanging off (or completely outside) the grid's edges.
+		Vector3 center(RandomFloat(-1200.0f, 1200.0f), RandomFloat(-100.0f, 300.0f), RandomFloat(-1200.0f, 1200.0f));
+		float size = RandomFloat(1.0f, 200.0f);
+		AABB query(center, size, size, size);
+		grid.Query(query, found);
+		REQUIRE(found == QueryBruteForce(triangles, query));
+		totalFound += static_cast<int>(found.size());
+	}
+
+	// Queries should be finding a small part of the whole.
+	REQUIRE(totalFound > 0);
+	REQUIRE(totalFound < 200 * 50);
+}
+
+TEST_CASE("Triangle grid handles empty and flat inputs")
+{
+	TriangleGrid grid;
+	std::vector<int> found = { 5 };
+	grid.Query(AABB(Vector3::Zero, 10.0f, 10.0f, 10.0f), found);
+	REQUIRE(found.empty());
+
+	// All triangles in the same plane (zero height) still works.
+	std::vector<Triangle> triangles;
+	triangles.emplace_back(Vector3(0.0f, 0.0f, 0.0f), Vector3(10.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 10.0f));
+	triangles.emplace_back(Vector3(100.0f, 0.0f, 100.0f), Vector3(110.0f, 0.0f, 100.0f), Vector3(100.0f, 0.0f, 110.0f));
+	grid.Build(triangles);
+
+	grid.Query(AABB(Vector3(105.0f, 0.0f, 105.0f), 2.0f, 2.0f, 2.0f), found);
+	REQUIRE(found == std::vector<int>({ 1 }));
+	grid.Query(AABB(Vector3(50.0f, 0.0f, 50.0f), 200.0f, 1.0f, 200.0f), found);
+	REQUIRE(found == std::vector<int>({ 0, 1 }));
+	grid.Query(AABB(Vector3(50.0f, 50.0f, 50.0f), 2.0f, 2.0f, 2.0f), found);
+	REQUIRE(found.empty());
+
+	grid.Clear();
+	grid.Query(AABB(Vector3(105.0f, 0.0f, 105.0f), 2.0f, 2.0f, 2.0f), found);
+	REQUIRE(found.empty());
+}